@@ -110,6 +110,30 @@ namespace Git
             }
         }
 
+        /**
+         * @internal
+         * @brief       Add a reference unless the object is already being destroyed
+         *
+         * @return      `true` if a reference was added, `false` if the reference counter was
+         *              already down to zero.
+         *
+         * This is used by caches that keep weak pointers to private objects. Such a pointer may
+         * still be found in the cache while the object's destructor is waiting to remove it.
+         */
+        bool BasePrivate::tryAddRef() const
+        {
+            int current = mRef.load();
+
+            while (current > 0) {
+                if (mRef.testAndSetOrdered(current, current + 1)) {
+                    return true;
+                }
+                current = mRef.load();
+            }
+
+            return false;
+        }
+
     }
 
     void Base::addRef() const
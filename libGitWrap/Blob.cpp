@@ -14,6 +14,8 @@
  *
  */
 
+#include <limits>
+
 #include "libGitWrap/Blob.hpp"
 
 #include "libGitWrap/Private/GitWrapPrivate.hpp"
@@ -51,4 +53,117 @@ namespace Git
 
     GW_PRIVATE_IMPL(Blob, Object)
 
+    /**
+     * @brief           Get the size of this blob's content
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          The size in bytes or `0` on failure.
+     */
+    qint64 Blob::rawSize(Result& result) const
+    {
+        GW_CD_CHECKED(Blob, 0, result);
+        return git_blob_rawsize(d->o());
+    }
+
+    /**
+     * @brief           Check whether this blob's content looks like binary data
+     *
+     * Uses the same heuristic as git does: The content is considered binary, if it contains a NUL
+     * byte or too many non-printable characters within its first few kilobytes.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          `true` if the content is binary, `false` if it is text or on failure.
+     */
+    bool Blob::isBinary(Result& result) const
+    {
+        GW_CD_CHECKED(Blob, false, result);
+        return git_blob_is_binary(d->o()) != 0;
+    }
+
+    /**
+     * @brief           Get this blob's content
+     *
+     * The content is not copied. It refers to the buffer that libgit2 keeps with the blob
+     * object; the returned BlobContent holds on to this Blob to keep that buffer valid.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          The content or an empty BlobContent on failure.
+     */
+    BlobContent Blob::content(Result& result) const
+    {
+        GW_CD_CHECKED(Blob, BlobContent(), result);
+
+        const void* raw = git_blob_rawcontent(d->o());
+        qint64 size = git_blob_rawsize(d->o());
+
+        if (size > qint64(std::numeric_limits<int>::max())) {
+            result.setError("The blob is too large to be held by a QByteArray.", GIT_ERROR);
+            return BlobContent();
+        }
+
+        return BlobContent(*this, QByteArray::fromRawData(static_cast<const char*>(raw),
+                                                          int(size)));
+    }
+
+    BlobContent::BlobContent()
+    {
+    }
+
+    BlobContent::BlobContent(const Blob& blob, const QByteArray& data)
+        : mBlob(blob)
+        , mData(data)
+    {
+    }
+
+    /**
+     * @brief           Get the Blob that owns the content
+     *
+     * @return          The blob or an invalid Blob if this BlobContent is empty.
+     */
+    Blob BlobContent::blob() const
+    {
+        return mBlob;
+    }
+
+    /**
+     * @brief           Get the content
+     *
+     * @return          A QByteArray that refers to the blob's buffer. It is valid as long as this
+     *                  BlobContent exists. Modifying a copy of it detaches it, which is always
+     *                  safe.
+     */
+    const QByteArray& BlobContent::data() const
+    {
+        return mData;
+    }
+
+    const char* BlobContent::constData() const
+    {
+        return mData.constData();
+    }
+
+    int BlobContent::size() const
+    {
+        return mData.size();
+    }
+
+    bool BlobContent::isEmpty() const
+    {
+        return mData.isEmpty();
+    }
+
+    /**
+     * @brief           Copy the content
+     *
+     * @return          A QByteArray with its own copy of the content, which does not depend on the
+     *                  blob anymore.
+     */
+    QByteArray BlobContent::toByteArray() const
+    {
+        return QByteArray(mData.constData(), mData.size());
+    }
+
 }
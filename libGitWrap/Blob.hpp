@@ -30,6 +30,8 @@ namespace Git
 
     }
 
+    class BlobContent;
+
     /**
      * @ingroup     GitWrap
      * @brief       Provides access to git BLOB (Binary Large Object) objects
@@ -39,6 +41,41 @@ namespace Git
     {
     public:
         GW_PRIVATE_OBJECT_DECL(Blob, Object, public)
+
+    public:
+        qint64 rawSize(Result& result) const;
+        bool isBinary(Result& result) const;
+        BlobContent content(Result& result) const;
+    };
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       The content of a Blob, shared with libgit2 instead of copied
+     *
+     * The content lives in a buffer that belongs to the blob object. A BlobContent keeps that
+     * object alive, so data() stays valid for as long as the BlobContent (or a copy of it) exists.
+     * This holds even if the Blob it was taken from is long gone.
+     *
+     * A QByteArray that is copied from data() does not keep the object alive. Use toByteArray()
+     * to get a deep copy instead.
+     */
+    class GITWRAP_API BlobContent
+    {
+    public:
+        BlobContent();
+        BlobContent(const Blob& blob, const QByteArray& data);
+
+    public:
+        Blob blob() const;
+        const QByteArray& data() const;
+        const char* constData() const;
+        int size() const;
+        bool isEmpty() const;
+        QByteArray toByteArray() const;
+
+    private:
+        Blob        mBlob;
+        QByteArray  mData;
     };
 
     template<>
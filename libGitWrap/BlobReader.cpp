@@ -0,0 +1,1082 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+
+#include "libGitWrap/BlobReader.hpp"
+
+#include "libGitWrap/Private/BlobReaderPrivate.hpp"
+#include "libGitWrap/Private/ObjectLocator.hpp"
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
+
+#include "git2/sys/filter.h"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        enum
+        {
+            // Types of pack entries
+            PackBlob        = 3,
+            PackOfsDelta    = 6,
+            PackRefDelta    = 7,
+
+            // "$Id: " + 40 hex digits + " $"
+            IdentSize       = 5 + 40 + 2
+        };
+
+        /**
+         * @internal
+         * @brief       What libgit2's crlf and ident filters look at to decide whether to convert
+         *
+         * The counting follows `git_buf_text_gather_stats()`.
+         */
+        struct TextStats
+        {
+            TextStats()
+                : printable(0), nonPrintable(0), nul(false), lf(0), cr(0), crlf(0)
+            {
+            }
+
+            void add(uchar c, uchar prev)
+            {
+                if ((c > 0x1f && c != 127) || c == '\t' || c == '\f' || c == '\v' || c == '\b' ||
+                        c == '\033') {
+                    printable++;
+                }
+                else if (c == 0) {
+                    nul = true;
+                    nonPrintable++;
+                }
+                else if (c == '\r') {
+                    cr++;
+                }
+                else if (c == '\n') {
+                    lf++;
+                    if (prev == '\r') {
+                        crlf++;
+                    }
+                }
+                else {
+                    nonPrintable++;
+                }
+            }
+
+            void remove(const TextStats& other)
+            {
+                printable -= other.printable;
+                nonPrintable -= other.nonPrintable;
+                lf -= other.lf;
+                cr -= other.cr;
+                crlf -= other.crlf;
+            }
+
+            bool isBinary() const
+            {
+                return nul || (printable >> 7) < nonPrintable;
+            }
+
+            /**
+             * A short text that libgit2's crlf filter treats like the counted one: It has the same
+             * kinds of line endings, lone CRs and is binary or not for the same reason.
+             */
+            QByteArray probe() const
+            {
+                QByteArray text("x");
+
+                if (crlf) {
+                    text += "\r\n";
+                }
+
+                if (lf > crlf) {
+                    text += "\n";
+                }
+
+                if (cr > crlf) {
+                    text += "\ry";
+                }
+
+                if (nul) {
+                    text += '\0';
+                }
+                else if (isBinary()) {
+                    text += '\001';
+                }
+
+                return text;
+            }
+
+            qint64  printable;
+            qint64  nonPrintable;
+            bool    nul;
+            qint64  lf;
+            qint64  cr;
+            qint64  crlf;
+        };
+
+        enum Bom
+        {
+            NoBom,
+            Utf8Bom,
+            OtherBom
+        };
+
+        // Like git_buf_text_detect_bom(), for the first bytes of the content
+        static Bom detectBom(const uchar* p, int len)
+        {
+            if (len < 2) {
+                return NoBom;
+            }
+
+            if (len >= 3 && p[0] == 0xef && p[1] == 0xbb && p[2] == 0xbf) {
+                return Utf8Bom;
+            }
+
+            if ((p[0] == 0xfe && p[1] == 0xff) || (p[0] == 0xff && p[1] == 0xfe) ||
+                    (len >= 4 && p[0] == 0 && p[1] == 0 && p[2] == 0xfe && p[3] == 0xff)) {
+                return OtherBom;
+            }
+
+            return NoBom;
+        }
+
+        // LF becomes CRLF; with @a loneOnly, only if there isn't a CR before it already
+        static QByteArray toCrlf(const QByteArray& text, bool loneOnly)
+        {
+            QByteArray converted;
+            for (int i = 0; i < text.size(); ++i) {
+                if (text.at(i) == '\n' && (!loneOnly || i == 0 || text.at(i - 1) != '\r')) {
+                    converted += '\r';
+                }
+                converted += text.at(i);
+            }
+            return converted;
+        }
+
+        /**
+         * @internal
+         * @brief       Run a filter list on a short text
+         *
+         * @return      The filtered text or a null QByteArray if the filters failed.
+         */
+        static QByteArray applyFilters(git_filter_list* filters, const QByteArray& text)
+        {
+            git_buf in;
+            in.ptr = const_cast<char*>(text.constData());
+            in.asize = 0;
+            in.size = size_t(text.size());
+
+            git_buf out;
+            out.ptr = nullptr;
+            out.asize = 0;
+            out.size = 0;
+
+            if (git_filter_list_apply_to_data(&out, filters, &in) < 0) {
+                giterr_clear();
+                return QByteArray();
+            }
+
+            QByteArray filtered(out.ptr, int(out.size));
+            git_buf_free(&out);
+            return filtered;
+        }
+
+        BlobReaderPrivate::BlobReaderPrivate(const Repository& repo, const ObjectId& id,
+                                             const QString& path)
+            : mRepo(repo)
+            , mId(id)
+            , mPath(path)
+            , mChunkSize(BlobReader::DefaultChunkSize)
+            , mBufferLimit(-1)
+            , mBuffered(false)
+            , mSource(None)
+            , mSize(0)
+            , mPos(0)
+            , mRawSize(0)
+            , mRawPos(0)
+            , mOffset(0)
+            , mZInit(false)
+            , mZEnd(false)
+            , mHeaderPos(0)
+            , mHeaderEnd(0)
+            , mStream(nullptr)
+            , mObject(nullptr)
+            , mData(nullptr)
+            , mIdentOn(false)
+            , mCrlfOn(false)
+            , mConvert(false)
+            , mToCrlf(false)
+            , mLoneLfOnly(false)
+            , mLastRaw(0)
+            , mIdentStart(-1)
+            , mIdentEnd(-1)
+            , mPendingPos(0)
+        {
+            mFiltered.ptr = nullptr;
+            mFiltered.asize = 0;
+            mFiltered.size = 0;
+        }
+
+        BlobReaderPrivate::~BlobReaderPrivate()
+        {
+            close();
+        }
+
+        /**
+         * @internal
+         * @brief       Release the file, zlib and the ODB stream, but keep what was located
+         */
+        void BlobReaderPrivate::closeRaw()
+        {
+            if (mZInit) {
+                inflateEnd(&mZ);
+                mZInit = false;
+            }
+
+            mFile.close();
+            mInput = QByteArray();
+
+            if (mStream) {
+                git_odb_stream_free(mStream);
+                mStream = nullptr;
+            }
+
+            mRawPos = 0;
+            mLastRaw = 0;
+            mHeaderPos = mHeaderEnd = 0;
+        }
+
+        void BlobReaderPrivate::close()
+        {
+            closeRaw();
+
+            if (mObject) {
+                git_odb_object_free(mObject);
+                mObject = nullptr;
+            }
+
+            git_buf_free(&mFiltered);
+
+            mData = nullptr;
+            mSource = None;
+            mBuffered = false;
+            mSize = mPos = mRawSize = 0;
+            mFileName = QString();
+            mOffset = 0;
+
+            mIdentOn = mCrlfOn = mConvert = mToCrlf = mLoneLfOnly = false;
+            mIdentStart = mIdentEnd = -1;
+            mIdent = mChunk = mPending = QByteArray();
+            mPendingPos = 0;
+        }
+
+        bool BlobReaderPrivate::open(Result& result)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            Repository::Private* rp = BasePrivate::dataOf<Repository>(mRepo);
+            if (!rp) {
+                result.setInvalidObject();
+                return false;
+            }
+
+            git_filter_list* filters = nullptr;
+            if (!mPath.isEmpty()) {
+                result = git_filter_list_load(&filters, rp->mRepo, nullptr, GW_StringFromQt(mPath),
+                                              GIT_FILTER_TO_WORKTREE, GIT_FILTER_DEFAULT);
+                GW_CHECK_RESULT(result, false);
+            }
+
+            mChunk.resize(mChunkSize);
+
+            bool ok = false;
+            if (filters && !planFilters(result, rp->mRepo, filters)) {
+                // Filters that we don't know; libgit2 has to filter the blob as a whole.
+                ok = openFiltered(result, rp->mRepo, filters);
+            }
+            else if (openRaw(result, rp->mRepo)) {
+                mSize = mRawSize;
+                ok = (!mIdentOn && !mCrlfOn) || scanText(result, rp->mRepo, filters);
+            }
+
+            git_filter_list_free(filters);
+            return ok;
+        }
+
+        /**
+         * @internal
+         * @brief       Find out whether we can apply a filter list while reading
+         *
+         * libgit2 has two filters of its own: crlf and ident. Whether ident applies is decided
+         * by the attribute alone. Any other filter in the list is taken to be crlf; scanText()
+         * finds out what it does.
+         *
+         * @return      `true` if the list can hold nothing but these two filters. `false` with a
+         *              successful @a result if there is a filter that we don't know.
+         */
+        bool BlobReaderPrivate::planFilters(Result& result, git_repository* repo,
+                                            git_filter_list* filters)
+        {
+            const char* value = nullptr;
+            result = git_attr_get(&value, repo, GIT_ATTR_CHECK_FILE_THEN_INDEX,
+                                  GW_StringFromQt(mPath), "ident");
+            GW_CHECK_RESULT(result, false);
+
+            mIdentOn = GIT_ATTR_TRUE(value);
+
+            const size_t others = git_filter_list_length(filters) - (mIdentOn ? 1 : 0);
+            mCrlfOn = others == 1;
+            return others <= 1;
+        }
+
+        /**
+         * @internal
+         * @brief       Read the content once to decide what the filters do to it
+         *
+         * Like libgit2's, ident replaces the first `$Id...$` with the blob's id, unless the
+         * content is binary. It runs before crlf, as in git.
+         *
+         * Whether crlf converts depends on the attributes, the configuration and the kinds of
+         * line endings in the content. Instead of repeating libgit2's rules, a short text with
+         * the same kinds of line endings is filtered. The way that text is converted tells how to
+         * convert the content. If it is converted in a way we don't understand, the filters
+         * must be something else; libgit2 then filters the blob as a whole.
+         *
+         * Afterwards, the size of the filtered content is known and the raw content is opened
+         * again to be read for real.
+         */
+        bool BlobReaderPrivate::scanText(Result& result, git_repository* repo,
+                                         git_filter_list* filters)
+        {
+            TextStats all;
+            TextStats span;
+            uchar head[4];
+            int headSize = 0;
+            uchar prev = 0;
+            uchar prev2 = 0;
+            qint64 identStart = -1;
+            qint64 identEnd = -1;
+
+            while (mRawPos < mRawSize) {
+                const qint64 base = mRawPos;
+                const qint64 n = readRaw(result, mChunk.data(), mChunk.size());
+                GW_CHECK_RESULT(result, false);
+
+                const uchar* p = reinterpret_cast<const uchar*>(mChunk.constData());
+                for (qint64 i = 0; i < n; ++i) {
+                    const uchar c = p[i];
+
+                    if (headSize < 4) {
+                        head[headSize++] = c;
+                    }
+
+                    all.add(c, prev);
+
+                    if (identStart >= 0 && identEnd < 0) {
+                        span.add(c, prev);
+                        if (c == '$') {
+                            identEnd = base + i + 1;
+                        }
+                    }
+                    else if (identStart < 0 && prev2 == '$' && prev == 'I' && c == 'd') {
+                        identStart = base + i - 2;
+                        span.printable = 3;
+                    }
+
+                    prev2 = prev;
+                    prev = c;
+                }
+            }
+
+            const Bom bom = detectBom(head, headSize);
+            if (bom == Utf8Bom) {
+                all.printable -= 3;
+            }
+            else if (bom == OtherBom) {
+                all.nul = true;
+            }
+
+            qint64 size = mRawSize;
+
+            if (mIdentOn && !all.isBinary() && identEnd > 0) {
+                mIdentStart = identStart;
+                mIdentEnd = identEnd;
+                mIdent = "$Id: " + mId.toString().toLatin1() + " $";
+
+                all.remove(span);
+                all.printable += IdentSize;
+                size += IdentSize - (identEnd - identStart);
+            }
+
+            if (mCrlfOn && size > 0) {
+                const QByteArray probe = all.probe();
+                const QByteArray filtered = applyFilters(filters, probe);
+
+                if (filtered == probe) {
+                    // crlf leaves this kind of content alone
+                }
+                else if (filtered == toCrlf(probe, false)) {
+                    mToCrlf = true;
+                }
+                else if (filtered == toCrlf(probe, true)) {
+                    mToCrlf = mLoneLfOnly = true;
+                }
+                else {
+                    closeRaw();
+                    if (mObject) {
+                        git_odb_object_free(mObject);
+                        mObject = nullptr;
+                    }
+                    mIdentStart = mIdentEnd = -1;
+                    return openFiltered(result, repo, filters);
+                }
+            }
+
+            if (mToCrlf) {
+                size += mLoneLfOnly ? all.lf - all.crlf : all.lf;
+            }
+
+            mConvert = mToCrlf || mIdentStart >= 0;
+            mSize = size;
+            return reopenRaw(result);
+        }
+
+        /**
+         * @internal
+         * @brief       Locate the blob and open it for reading
+         *
+         * The ODB is asked first, so alternates and ODB backends of our own are honoured and the
+         * size is known. If the object is in a file in one of the object directories, it is
+         * inflated from there chunk by chunk. Otherwise, a read stream of the ODB is used or, if
+         * there is none, the whole object is read.
+         */
+        bool BlobReaderPrivate::openRaw(Result& result, git_repository* repo)
+        {
+            git_odb* odb = nullptr;
+            result = git_repository_odb(&odb, repo);
+            GW_CHECK_RESULT(result, false);
+
+            size_t size = 0;
+            git_otype type = GIT_OBJ_BAD;
+
+            result = git_odb_read_header(&size, &type, odb, ObjectId2git(mId));
+            if (result && type != GIT_OBJ_BLOB) {
+                result.setError("The object is not a blob.", GIT_ERROR);
+            }
+
+            if (!result) {
+                git_odb_free(odb);
+                return false;
+            }
+
+            mRawSize = qint64(size);
+
+            ObjectLocator::Location loc = ObjectLocator(repo).find(mId);
+            mFileName = loc.fileName;
+            mOffset = loc.offset;
+
+            bool ok = false;
+            if (loc.kind == ObjectLocator::Loose) {
+                ok = openLoose(result);
+            }
+            else if (loc.kind == ObjectLocator::Packed) {
+                ok = openPacked(result);
+            }
+
+            if (!ok && result) {
+                ok = openStream(result, odb) || openBuffer(result, odb);
+            }
+
+            git_odb_free(odb);
+            return ok;
+        }
+
+        /**
+         * @internal
+         * @brief       Start reading the raw content from its beginning again
+         */
+        bool BlobReaderPrivate::reopenRaw(Result& result)
+        {
+            closeRaw();
+
+            bool ok = false;
+
+            switch (mSource) {
+            case Loose:
+                ok = openLoose(result);
+                break;
+
+            case Packed:
+                ok = openPacked(result);
+                break;
+
+            case Stream:
+                {
+                    git_odb* odb = nullptr;
+                    Repository::Private* rp = BasePrivate::dataOf<Repository>(mRepo);
+                    result = git_repository_odb(&odb, rp->mRepo);
+                    GW_CHECK_RESULT(result, false);
+
+                    result = git_odb_open_rstream(&mStream, odb, ObjectId2git(mId));
+                    git_odb_free(odb);
+                    ok = result;
+                }
+                break;
+
+            case Buffer:
+                ok = true;
+                break;
+
+            default:
+                break;
+            }
+
+            // The file was there a moment ago; e.g. git gc might have replaced it.
+            if (!ok && result) {
+                result.setError("The object could not be read a second time.", GIT_ERROR);
+            }
+
+            return ok;
+        }
+
+        bool BlobReaderPrivate::startInflate(Result& result)
+        {
+            std::memset(&mZ, 0, sizeof(mZ));
+            if (inflateInit(&mZ) != Z_OK) {
+                result.setError("Cannot initialize zlib.", GIT_ERROR);
+                return false;
+            }
+
+            mZInit = true;
+            mZEnd = false;
+            mInput.resize(mChunkSize);
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Open the loose object file and read the object header
+         *
+         * @return      `true` if the object file could be opened. `false` with a successful
+         *              @a result if it could not, e.g. because the object was packed meanwhile.
+         */
+        bool BlobReaderPrivate::openLoose(Result& result)
+        {
+            mFile.setFileName(mFileName);
+            if (!mFile.open(QIODevice::ReadOnly)) {
+                return false;
+            }
+
+            if (!startInflate(result)) {
+                return false;
+            }
+
+            mSource = Loose;
+
+            // The header is inflated into mHeader; what's left there after the NUL is content.
+            const char* nul = nullptr;
+            while (!nul && mHeaderEnd < MaxHeaderSize && !mZEnd) {
+                qint64 n = inflateInto(result, mHeader + mHeaderEnd, MaxHeaderSize - mHeaderEnd);
+                GW_CHECK_RESULT(result, false);
+
+                mHeaderEnd += int(n);
+                nul = static_cast<const char*>(std::memchr(mHeader, 0, size_t(mHeaderEnd)));
+            }
+
+            if (!nul || std::strncmp(mHeader, "blob ", 5) != 0) {
+                result.setError("The object is not a blob or its header is corrupt.", GIT_ERROR);
+                return false;
+            }
+
+            bool ok = false;
+            qint64 size = QByteArray(mHeader + 5, int(nul - mHeader) - 5).toLongLong(&ok);
+            if (!ok || size != mRawSize) {
+                result.setError("The object's header is corrupt.", GIT_ERROR);
+                return false;
+            }
+
+            mHeaderPos = int(nul - mHeader) + 1;
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Open the pack file at the object's entry
+         *
+         * A blob that is stored as a whole is inflated from the pack, like a loose one. A delta
+         * can only be resolved against its base as a whole; that's left to libgit2.
+         *
+         * @return      `true` if the entry can be read. `false` with a successful @a result if
+         *              it is a delta or the pack cannot be opened.
+         */
+        bool BlobReaderPrivate::openPacked(Result& result)
+        {
+            mFile.setFileName(mFileName);
+            if (!mFile.open(QIODevice::ReadOnly) || !mFile.seek(mOffset)) {
+                mFile.close();
+                return false;
+            }
+
+            // Type in bits 4-6 of the first byte, size in 4 + 7 + 7... bits; MSB means "more"
+            uchar header[MaxPackHeader];
+            const qint64 n = mFile.read(reinterpret_cast<char*>(header), MaxPackHeader);
+
+            int used = 0;
+            int type = 0;
+            quint64 size = 0;
+
+            if (n > 0) {
+                type = (header[0] >> 4) & 7;
+                size = header[0] & 15;
+                used = 1;
+
+                for (int shift = 4; (header[used - 1] & 0x80) && used < n; shift += 7) {
+                    size |= quint64(header[used++] & 0x7f) << shift;
+                }
+            }
+
+            if (type == PackOfsDelta || type == PackRefDelta) {
+                mFile.close();
+                return false;
+            }
+
+            if (!used || (header[used - 1] & 0x80) || type != PackBlob ||
+                    qint64(size) != mRawSize) {
+                result.setError("The pack entry of the blob is corrupt.", GIT_ERROR);
+                return false;
+            }
+
+            if (!mFile.seek(mOffset + used)) {
+                result.setError("Cannot read the pack file.", GIT_ERROR);
+                return false;
+            }
+
+            if (!startInflate(result)) {
+                return false;
+            }
+
+            mSource = Packed;
+            return true;
+        }
+
+        bool BlobReaderPrivate::openStream(Result& result, git_odb* odb)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            // Most backends cannot stream; that's not an error, we just read the whole object.
+            if (git_odb_open_rstream(&mStream, odb, ObjectId2git(mId)) < 0) {
+                giterr_clear();
+                mStream = nullptr;
+                return false;
+            }
+
+            mSource = Stream;
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Check whether the content may be read as a whole
+         */
+        bool BlobReaderPrivate::canBuffer(Result& result, qint64 size)
+        {
+            if (mBufferLimit >= 0 && size > mBufferLimit) {
+                result.setError("The blob would have to be read as a whole, but it is larger "
+                                "than the buffer limit.", GIT_ERROR);
+                return false;
+            }
+
+            mBuffered = true;
+            return true;
+        }
+
+        bool BlobReaderPrivate::openBuffer(Result& result, git_odb* odb)
+        {
+            if (!canBuffer(result, mRawSize)) {
+                return false;
+            }
+
+            result = git_odb_read(&mObject, odb, ObjectId2git(mId));
+            GW_CHECK_RESULT(result, false);
+
+            mSource = Buffer;
+            mData = static_cast<const char*>(git_odb_object_data(mObject));
+            mRawSize = qint64(git_odb_object_size(mObject));
+            return true;
+        }
+
+        bool BlobReaderPrivate::openFiltered(Result& result, git_repository* repo,
+                                             git_filter_list* filters)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            git_blob* blob = nullptr;
+            result = git_blob_lookup(&blob, repo, ObjectId2git(mId));
+            GW_CHECK_RESULT(result, false);
+
+            if (!canBuffer(result, qint64(git_blob_rawsize(blob)))) {
+                git_blob_free(blob);
+                return false;
+            }
+
+            result = git_filter_list_apply_to_blob(&mFiltered, filters, blob);
+            git_blob_free(blob);
+            GW_CHECK_RESULT(result, false);
+
+            mSource = Buffer;
+            mData = mFiltered.ptr;
+            mSize = mRawSize = qint64(mFiltered.size);
+            return true;
+        }
+
+        qint64 BlobReaderPrivate::remaining() const
+        {
+            return mSize - mPos;
+        }
+
+        /**
+         * @internal
+         * @brief       Inflate up to @a maxSize bytes, reading one chunk of input at a time
+         */
+        qint64 BlobReaderPrivate::inflateInto(Result& result, char* data, qint64 maxSize)
+        {
+            mZ.next_out = reinterpret_cast<Bytef*>(data);
+            mZ.avail_out = uInt(qMin(maxSize, qint64(mChunkSize)));
+            uInt wanted = mZ.avail_out;
+
+            while (mZ.avail_out > 0 && !mZEnd) {
+                if (mZ.avail_in == 0) {
+                    qint64 n = mFile.read(mInput.data(), mInput.size());
+                    if (n <= 0) {
+                        result.setError("The object file is truncated.", GIT_ERROR);
+                        return -1;
+                    }
+
+                    mZ.next_in = reinterpret_cast<Bytef*>(mInput.data());
+                    mZ.avail_in = uInt(n);
+                }
+
+                int rc = inflate(&mZ, Z_NO_FLUSH);
+                if (rc == Z_STREAM_END) {
+                    mZEnd = true;
+                }
+                else if (rc != Z_OK) {
+                    result.setError("The object file is corrupt.", GIT_ERROR);
+                    return -1;
+                }
+            }
+
+            return qint64(wanted - mZ.avail_out);
+        }
+
+        /**
+         * @internal
+         * @brief       Read the next piece of the content as it is stored
+         */
+        qint64 BlobReaderPrivate::readRaw(Result& result, char* data, qint64 maxSize)
+        {
+            GW_CHECK_RESULT(result, -1);
+
+            maxSize = qMin(maxSize, mRawSize - mRawPos);
+            if (maxSize <= 0) {
+                result.setError("The object ended before its declared size.", GIT_ERROR);
+                return -1;
+            }
+
+            qint64 n = 0;
+
+            switch (mSource) {
+            case Loose:
+            case Packed:
+                if (mHeaderPos < mHeaderEnd) {
+                    n = qMin(maxSize, qint64(mHeaderEnd - mHeaderPos));
+                    std::memcpy(data, mHeader + mHeaderPos, size_t(n));
+                    mHeaderPos += int(n);
+                }
+                else {
+                    n = inflateInto(result, data, maxSize);
+                }
+                break;
+
+            case Stream:
+                n = git_odb_stream_read(mStream, data, size_t(qMin(maxSize, qint64(mChunkSize))));
+                if (n < 0) {
+                    result = int(n);
+                }
+                break;
+
+            case Buffer:
+                std::memcpy(data, mData + mRawPos, size_t(maxSize));
+                n = maxSize;
+                break;
+
+            default:
+                result.setError("The reader is not open.", GIT_ERROR);
+                return -1;
+            }
+
+            GW_CHECK_RESULT(result, -1);
+
+            if (n == 0) {
+                result.setError("The object ended before its declared size.", GIT_ERROR);
+                return -1;
+            }
+
+            mRawPos += n;
+            return n;
+        }
+
+        /**
+         * @internal
+         * @brief       Read the next piece of the filtered content
+         *
+         * One chunk of raw content is converted at a time. It grows by at most a CR per byte and
+         * the ident, so the memory needed is bounded by the chunk size.
+         */
+        qint64 BlobReaderPrivate::readFiltered(Result& result, char* data, qint64 maxSize)
+        {
+            while (mPendingPos == mPending.size()) {
+                const qint64 base = mRawPos;
+                const qint64 n = readRaw(result, mChunk.data(), mChunk.size());
+                GW_CHECK_RESULT(result, -1);
+
+                mPending.resize(int(n) * 2 + mIdent.size());
+                mPendingPos = 0;
+
+                const char* in = mChunk.constData();
+                char* out = mPending.data();
+
+                for (qint64 i = 0; i < n; ++i) {
+                    const qint64 pos = base + i;
+                    if (pos >= mIdentStart && pos < mIdentEnd) {
+                        if (pos == mIdentStart) {
+                            std::memcpy(out, mIdent.constData(), size_t(mIdent.size()));
+                            out += mIdent.size();
+                            mLastRaw = '$';
+                        }
+                        continue;
+                    }
+
+                    if (mToCrlf && in[i] == '\n' && (!mLoneLfOnly || mLastRaw != '\r')) {
+                        *out++ = '\r';
+                    }
+                    *out++ = in[i];
+                    mLastRaw = in[i];
+                }
+
+                mPending.resize(int(out - mPending.constData()));
+            }
+
+            const qint64 n = qMin(maxSize, qint64(mPending.size() - mPendingPos));
+            std::memcpy(data, mPending.constData() + mPendingPos, size_t(n));
+            mPendingPos += int(n);
+            return n;
+        }
+
+        qint64 BlobReaderPrivate::read(Result& result, char* data, qint64 maxSize)
+        {
+            GW_CHECK_RESULT(result, -1);
+
+            maxSize = qMin(maxSize, remaining());
+            if (maxSize <= 0) {
+                return 0;
+            }
+
+            qint64 n = mConvert ? readFiltered(result, data, maxSize)
+                                : readRaw(result, data, maxSize);
+            GW_CHECK_RESULT(result, -1);
+
+            mPos += n;
+            return n;
+        }
+
+    }
+
+    /**
+     * @brief           Create a reader for the unfiltered content of a blob
+     *
+     * @param[in]       repo    The repository to read from
+     *
+     * @param[in]       blobId  The blob to read
+     *
+     * @param[in]       parent  The QObject parent
+     */
+    BlobReader::BlobReader(const Repository& repo, const ObjectId& blobId, QObject* parent)
+        : QIODevice(parent)
+        , d(new Internal::BlobReaderPrivate(repo, blobId, QString()))
+    {
+    }
+
+    /**
+     * @brief           Create a reader for the content of a blob, filtered for the working tree
+     *
+     * @param[in]       repo        The repository to read from
+     *
+     * @param[in]       blobId      The blob to read
+     *
+     * @param[in]       filterPath  The path (relative to the working tree) whose attributes decide
+     *                              which filters apply.
+     *
+     * @param[in]       parent      The QObject parent
+     */
+    BlobReader::BlobReader(const Repository& repo, const ObjectId& blobId,
+                           const QString& filterPath, QObject* parent)
+        : QIODevice(parent)
+        , d(new Internal::BlobReaderPrivate(repo, blobId, filterPath))
+    {
+    }
+
+    BlobReader::~BlobReader()
+    {
+        delete d;
+    }
+
+    ObjectId BlobReader::blobId() const
+    {
+        return d->mId;
+    }
+
+    QString BlobReader::filterPath() const
+    {
+        return d->mPath;
+    }
+
+    bool BlobReader::isFiltered() const
+    {
+        return !d->mPath.isEmpty();
+    }
+
+    int BlobReader::chunkSize() const
+    {
+        return d->mChunkSize;
+    }
+
+    /**
+     * @brief           Set the maximum number of bytes that are read from the ODB at once
+     *
+     * Takes effect with the next open().
+     */
+    void BlobReader::setChunkSize(int size)
+    {
+        d->mChunkSize = qMax(size, int(Internal::BlobReaderPrivate::MaxHeaderSize));
+    }
+
+    qint64 BlobReader::bufferLimit() const
+    {
+        return d->mBufferLimit;
+    }
+
+    /**
+     * @brief           Limit the size of blobs that may be read as a whole
+     *
+     * If the blob cannot be streamed (see isBuffered()) and is larger than @a bytes, open()
+     * fails. Takes effect with the next open().
+     *
+     * @param[in]       bytes   The limit or `-1` for none, which is the default.
+     */
+    void BlobReader::setBufferLimit(qint64 bytes)
+    {
+        d->mBufferLimit = qMax(bytes, qint64(-1));
+    }
+
+    /**
+     * @brief           Was the whole content loaded into memory by open()?
+     *
+     * `false` if it is streamed, so that no more than about one chunk is in memory at a time.
+     */
+    bool BlobReader::isBuffered() const
+    {
+        return d->mBuffered;
+    }
+
+    /**
+     * @brief           The result of the last operation
+     *
+     * If open() or a read fails, this tells why. errorString() is set to the same message.
+     */
+    Result BlobReader::result() const
+    {
+        return d->mResult;
+    }
+
+    bool BlobReader::open(OpenMode mode)
+    {
+        if ((mode & ReadWrite) != ReadOnly) {
+            setErrorString(tr("A BlobReader can only be opened for reading."));
+            return false;
+        }
+
+        d->close();
+        d->mResult = Result();
+
+        if (!d->open(d->mResult)) {
+            d->close();
+            if (d->mResult) {
+                d->mResult.setError("The blob could not be opened.", GIT_ENOTFOUND);
+            }
+            setErrorString(d->mResult.errorText());
+            return false;
+        }
+
+        return QIODevice::open(mode);
+    }
+
+    void BlobReader::close()
+    {
+        QIODevice::close();
+        d->close();
+    }
+
+    bool BlobReader::isSequential() const
+    {
+        return true;
+    }
+
+    /**
+     * @brief           The size of the (filtered) content
+     *
+     * Unlike other sequential devices, the size is known as soon as the reader is open.
+     */
+    qint64 BlobReader::size() const
+    {
+        return d->mSize;
+    }
+
+    qint64 BlobReader::bytesAvailable() const
+    {
+        return QIODevice::bytesAvailable() + d->remaining();
+    }
+
+    qint64 BlobReader::readData(char* data, qint64 maxSize)
+    {
+        qint64 n = d->read(d->mResult, data, maxSize);
+        if (n < 0) {
+            setErrorString(d->mResult.errorText());
+        }
+        return n;
+    }
+
+    qint64 BlobReader::writeData(const char* data, qint64 maxSize)
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(maxSize);
+        return -1;
+    }
+
+}
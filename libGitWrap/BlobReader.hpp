@@ -0,0 +1,103 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QIODevice>
+
+#include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/Repository.hpp"
+#include "libGitWrap/Result.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+        class BlobReaderPrivate;
+    }
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Reads a blob's content in chunks, without loading the blob as a whole
+     *
+     * The blob is looked up in the object directories of the repository, including alternates.
+     * A loose blob and a blob that is stored as a whole in a pack file are inflated straight from
+     * their files; only one chunk of compressed data and zlib's window are held in memory at any
+     * time. A blob that some other ODB backend holds is handed to an ODB read stream if the
+     * backend supports one.
+     *
+     * Everything else is read as a whole by libgit2 and the chunks are served from that buffer.
+     * This is the case for blobs that are stored as a delta in a pack; git doesn't store files
+     * larger than `core.bigFileThreshold` as deltas, though. isBuffered() tells whether this
+     * happened; with setBufferLimit(), open() fails instead.
+     *
+     * If a filter path is given, the content is converted for the working tree the way
+     * `git_blob_filtered_content` does it, according to the attributes and the configuration that
+     * apply to that path. libgit2's own filters, crlf and ident, are applied chunk by chunk. To
+     * find out whether they change the content and to know its size, the content is read twice
+     * then. Filters that were registered by the application can only be applied to the blob as
+     * a whole.
+     *
+     * The device is sequential and can only be opened for reading. size() is known right after
+     * open(), though.
+     */
+    class GITWRAP_API BlobReader : public QIODevice
+    {
+        Q_OBJECT
+    public:
+        enum
+        {
+            DefaultChunkSize = 64 * 1024
+        };
+
+    public:
+        BlobReader(const Repository& repo, const ObjectId& blobId, QObject* parent = 0);
+        BlobReader(const Repository& repo, const ObjectId& blobId, const QString& filterPath,
+                   QObject* parent = 0);
+        ~BlobReader();
+
+    public:
+        ObjectId blobId() const;
+        QString filterPath() const;
+        bool isFiltered() const;
+
+        int chunkSize() const;
+        void setChunkSize(int size);
+
+        qint64 bufferLimit() const;
+        void setBufferLimit(qint64 bytes);
+        bool isBuffered() const;
+
+        Result result() const;
+
+    public:
+        bool open(OpenMode mode);
+        void close();
+
+        bool isSequential() const;
+        qint64 size() const;
+        qint64 bytesAvailable() const;
+
+    protected:
+        qint64 readData(char* data, qint64 maxSize);
+        qint64 writeData(const char* data, qint64 maxSize);
+
+    private:
+        Internal::BlobReaderPrivate* d;
+    };
+
+}
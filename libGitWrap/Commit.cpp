@@ -299,13 +299,13 @@ namespace Git
     Signature Commit::author() const
     {
         GW_CD(Commit);
-        return d ? Internal::git2Signature( git_commit_author(d->o()) ) : Signature();
+        return d ? Internal::git2Signature( git_commit_author(d->o()), d->repo() ) : Signature();
     }
 
     Signature Commit::committer() const
     {
         GW_CD(Commit);
-        return d ? Internal::git2Signature( git_commit_committer(d->o()) ) : Signature();
+        return d ? Internal::git2Signature( git_commit_committer(d->o()), d->repo() ) : Signature();
     }
 
     QString Commit::message() const
@@ -0,0 +1,216 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libGitWrap/CommitInfo.hpp"
+
+#include "libGitWrap/Private/CommitInfoLoader.hpp"
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
+#include "libGitWrap/Private/WorkerPool.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        // Below this number of commits per chunk, starting a thread costs more than it gains.
+        static const int sMinCommitsPerChunk = 2048;
+
+        CommitInfoLoader::CommitInfoLoader(RepositoryPrivate* repo)
+            : mRepo(repo)
+        {
+        }
+
+        void CommitInfoLoader::decode(Chunk& chunk, git_repository* repo, const ObjectId* ids,
+                                      CommitInfo* out, int count)
+        {
+            for (int i = 0; i < count; ++i) {
+                git_commit* commit = nullptr;
+
+                chunk.result = git_commit_lookup(&commit, repo, ObjectId2git(ids[i]));
+                if (!chunk.result) {
+                    return;
+                }
+
+                CommitInfo& ci = out[i];
+                ci.id = ids[i];
+                ci.tree = ObjectId::fromRaw(git_commit_tree_id(commit)->id);
+
+                const git_signature* sig = git_commit_author(commit);
+                ci.authorTime = sig->when.time;
+                ci.authorOffset = sig->when.offset;
+                ci.authorName = chunk.strings.intern(sig->name);
+                ci.authorEmail = chunk.strings.intern(sig->email);
+
+                sig = git_commit_committer(commit);
+                ci.commitTime = sig->when.time;
+                ci.commitOffset = sig->when.offset;
+                ci.committerName = chunk.strings.intern(sig->name);
+                ci.committerEmail = chunk.strings.intern(sig->email);
+
+                // Same as Commit::shortMessage(): Everything up to the first line break
+                const char* msg = git_commit_message(commit);
+                int len = 0;
+                while (msg[len] && msg[len] != '\n') {
+                    len++;
+                }
+                ci.summary = chunk.strings.append(msg, len);
+
+                ci.firstParent = chunk.parents.count();
+                ci.numParents = int(git_commit_parentcount(commit));
+                for (int j = 0; j < ci.numParents; ++j) {
+                    chunk.parents.append(ObjectId::fromRaw(git_commit_parent_id(commit, j)->id));
+                }
+
+                git_commit_free(commit);
+            }
+        }
+
+        /**
+         * @internal
+         * @brief           Load the meta data of a list of commits
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       ids     The ids of the commits to load.
+         *
+         * @return          The records in the order of @a ids. If any of the ids cannot be found
+         *                  or is not a commit, an empty list is returned.
+         */
+        CommitInfoList CommitInfoLoader::load(Result& result, const ObjectIdList& ids)
+        {
+            GW_CHECK_RESULT(result, CommitInfoList());
+
+            CommitInfoList list;
+            list.mInfos.resize(ids.count());
+
+            int chunks = WorkerPool::chunksFor(ids.count(), sMinCommitsPerChunk);
+            QVector<Chunk> data(chunks);
+            QVector<int> chunkBegin(chunks);
+
+            // Don't let the threads touch the containers; non-const access might detach them.
+            Chunk* chunkData = data.data();
+            int* chunkBeginData = chunkBegin.data();
+            CommitInfo* infos = list.mInfos.data();
+
+            WorkerPool::run(chunks, ids.count(), [&](int chunk, int begin, int end) {
+                Chunk& c = chunkData[chunk];
+                chunkBeginData[chunk] = begin;
+
+                // The first chunk runs on the calling thread and can use the repository's own
+                // handle; all others open a private one.
+                git_repository* repo = mRepo->mRepo;
+                if (chunk) {
+                    repo = mRepo->openHandle(c.result);
+                    if (!c.result) {
+                        return;
+                    }
+                }
+
+                c.parents.reserve(int((end - begin) * 1.2));
+                decode(c, repo, ids.constData() + begin, infos + begin, end - begin);
+
+                if (chunk) {
+                    git_repository_free(repo);
+                }
+            });
+
+            for (int i = 0; i < chunks; ++i) {
+                if (!data[i].result) {
+                    result = data[i].result;
+                    return CommitInfoList();
+                }
+            }
+
+            // Now, rebase the chunks' string and parent indices onto the final tables
+            StringPool strings;
+            list.mParents.reserve(ids.count() + ids.count() / 5);
+
+            for (int i = 0; i < chunks; ++i) {
+                Chunk& c = data[i];
+                QVector<int> map = strings.merge(c.strings);
+                int parentBase = list.mParents.count();
+                int end = i + 1 < chunks ? chunkBegin[i + 1] : ids.count();
+
+                for (int j = chunkBegin[i]; j < end; ++j) {
+                    CommitInfo& ci = list.mInfos[j];
+                    ci.authorName       = map[ci.authorName];
+                    ci.authorEmail      = map[ci.authorEmail];
+                    ci.committerName    = map[ci.committerName];
+                    ci.committerEmail   = map[ci.committerEmail];
+                    ci.summary          = map[ci.summary];
+                    ci.firstParent     += parentBase;
+                }
+
+                list.mParents += c.parents;
+                c = Chunk();
+            }
+
+            list.mStrings = strings.strings();
+            return list;
+        }
+
+    }
+
+    /**
+     * @brief       Create an empty list
+     */
+    CommitInfoList::CommitInfoList()
+    {
+    }
+
+    /**
+     * @brief       Get the author of a commit as Signature
+     *
+     * @param[in]   index   Index of the commit in this list.
+     *
+     * @return      The author. Name and email share their data with this list.
+     */
+    Signature CommitInfoList::author(int index) const
+    {
+        const CommitInfo& ci = mInfos.at(index);
+        return Signature(mStrings.at(ci.authorName), mStrings.at(ci.authorEmail),
+                         ci.authorTime, ci.authorOffset);
+    }
+
+    /**
+     * @brief       Get the committer of a commit as Signature
+     *
+     * @param[in]   index   Index of the commit in this list.
+     *
+     * @return      The committer. Name and email share their data with this list.
+     */
+    Signature CommitInfoList::committer(int index) const
+    {
+        const CommitInfo& ci = mInfos.at(index);
+        return Signature(mStrings.at(ci.committerName), mStrings.at(ci.committerEmail),
+                         ci.commitTime, ci.commitOffset);
+    }
+
+    /**
+     * @brief       Get the parent ids of a commit
+     *
+     * @param[in]   index   Index of the commit in this list.
+     *
+     * @return      The ids of all parents of the commit.
+     */
+    ObjectIdList CommitInfoList::parentIds(int index) const
+    {
+        const CommitInfo& ci = mInfos.at(index);
+        return mParents.mid(ci.firstParent, ci.numParents);
+    }
+
+}
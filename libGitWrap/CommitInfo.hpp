@@ -0,0 +1,190 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/Signature.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+        class CommitInfoLoader;
+    }
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Compact record of a commit's meta data
+     *
+     * All strings are stored as indices into the string table of the CommitInfoList that the
+     * record belongs to. Names and email addresses are shared between all records of a list.
+     *
+     * Times are seconds since the epoch, offsets are minutes east of UTC.
+     *
+     * @see         Repository::commitInfos()
+     */
+    struct CommitInfo
+    {
+        ObjectId    id;
+        ObjectId    tree;
+
+        qint64      authorTime;
+        qint64      commitTime;
+        int         authorOffset;
+        int         commitOffset;
+
+        int         authorName;
+        int         authorEmail;
+        int         committerName;
+        int         committerEmail;
+        int         summary;
+
+        /** Index of the first parent id in CommitInfoList::parentIds() */
+        int         firstParent;
+        int         numParents;
+    };
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       A list of CommitInfo records along with their strings and parent ids
+     *
+     * All data is held in a few flat arrays, which are implicitly shared. Copying a list is cheap.
+     *
+     * @see         Repository::commitInfos()
+     */
+    class GITWRAP_API CommitInfoList
+    {
+        friend class Internal::CommitInfoLoader;
+
+    public:
+        CommitInfoList();
+
+    public:
+        int count() const;
+        bool isEmpty() const;
+
+        const CommitInfo& at(int index) const;
+        const CommitInfo& operator[](int index) const;
+
+        const QString& string(int stringIndex) const;
+        int stringCount() const;
+
+        QString authorName(int index) const;
+        QString authorEmail(int index) const;
+        QString committerName(int index) const;
+        QString committerEmail(int index) const;
+        QString summary(int index) const;
+
+        Signature author(int index) const;
+        Signature committer(int index) const;
+
+        int numParents(int index) const;
+        ObjectId parentId(int index, int n) const;
+        ObjectIdList parentIds(int index) const;
+
+    public:
+        typedef QVector<CommitInfo>::const_iterator const_iterator;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+
+    private:
+        QVector<CommitInfo> mInfos;
+        QVector<QString>    mStrings;
+        ObjectIdList        mParents;
+    };
+
+    inline int CommitInfoList::count() const
+    {
+        return mInfos.count();
+    }
+
+    inline bool CommitInfoList::isEmpty() const
+    {
+        return mInfos.isEmpty();
+    }
+
+    inline const CommitInfo& CommitInfoList::at(int index) const
+    {
+        return mInfos.at(index);
+    }
+
+    inline const CommitInfo& CommitInfoList::operator[](int index) const
+    {
+        return mInfos.at(index);
+    }
+
+    inline const QString& CommitInfoList::string(int stringIndex) const
+    {
+        return mStrings.at(stringIndex);
+    }
+
+    inline int CommitInfoList::stringCount() const
+    {
+        return mStrings.count();
+    }
+
+    inline QString CommitInfoList::authorName(int index) const
+    {
+        return mStrings.at(mInfos.at(index).authorName);
+    }
+
+    inline QString CommitInfoList::authorEmail(int index) const
+    {
+        return mStrings.at(mInfos.at(index).authorEmail);
+    }
+
+    inline QString CommitInfoList::committerName(int index) const
+    {
+        return mStrings.at(mInfos.at(index).committerName);
+    }
+
+    inline QString CommitInfoList::committerEmail(int index) const
+    {
+        return mStrings.at(mInfos.at(index).committerEmail);
+    }
+
+    inline QString CommitInfoList::summary(int index) const
+    {
+        return mStrings.at(mInfos.at(index).summary);
+    }
+
+    inline int CommitInfoList::numParents(int index) const
+    {
+        return mInfos.at(index).numParents;
+    }
+
+    inline ObjectId CommitInfoList::parentId(int index, int n) const
+    {
+        const CommitInfo& ci = mInfos.at(index);
+        return n < ci.numParents ? mParents.at(ci.firstParent + n) : ObjectId();
+    }
+
+    inline CommitInfoList::const_iterator CommitInfoList::begin() const
+    {
+        return mInfos.constBegin();
+    }
+
+    inline CommitInfoList::const_iterator CommitInfoList::end() const
+    {
+        return mInfos.constEnd();
+    }
+
+}
+
+Q_DECLARE_TYPEINFO(Git::CommitInfo, Q_MOVABLE_TYPE);
@@ -14,11 +14,17 @@
  *
  */
 
+#include <limits>
+
+#include <QAtomicInt>
+#include <QMutex>
+
 #include "libGitWrap/Index.hpp"
 #include "libGitWrap/Repository.hpp"
 #include "libGitWrap/FileInfo.hpp"
 
 #include "libGitWrap/Private/GitWrapPrivate.hpp"
+#include "libGitWrap/Private/ObjectCache.hpp"
 
 namespace Git
 {
@@ -409,6 +415,104 @@ namespace Git
                             false, (df->flags & GIT_DIFF_FLAG_VALID_ID) != 0);
         }
 
+
+        //-- Tuning ----------------------------------------------------------------------------- >8
+
+        Q_GLOBAL_STATIC(QMutex, sTuningLock)
+        Q_GLOBAL_STATIC(GitWrap::Tuning, sTuning)
+
+        // Number of initialised GitWrap instances; guarded by sTuningLock
+        static int sInitCount = 0;
+
+        // A copy of Tuning::internSignatures that can be read without the lock
+        static QAtomicInt sInternSignatures(1);
+
+        bool internSignatures()
+        {
+            return sInternSignatures.loadAcquire() != 0;
+        }
+
+        static bool fitsSize(qint64 value)
+        {
+            return value >= 0 && quint64(value) <= quint64(std::numeric_limits<ssize_t>::max());
+        }
+
+        static bool isValidTuning(const GitWrap::Tuning& t)
+        {
+            return fitsSize(t.cacheMaxSize)
+                && fitsSize(t.commitCacheLimit)
+                && fitsSize(t.treeCacheLimit)
+                && fitsSize(t.blobCacheLimit)
+                && fitsSize(t.tagCacheLimit)
+                && fitsSize(t.mwindowSize) && t.mwindowSize > 0
+                && fitsSize(t.mwindowMappedLimit);
+        }
+
+        /**
+         * @internal
+         * @brief       Hand the tuning values to libgit2
+         *
+         * @return      A libgit2 error code.
+         */
+        static int applyTuning(const GitWrap::Tuning& t)
+        {
+            int rc = git_libgit2_opts(GIT_OPT_ENABLE_CACHING, t.cachingEnabled ? 1 : 0);
+
+            if (rc >= 0) {
+                rc = git_libgit2_opts(GIT_OPT_SET_CACHE_MAX_SIZE, ssize_t(t.cacheMaxSize));
+            }
+            if (rc >= 0) {
+                rc = git_libgit2_opts(GIT_OPT_SET_CACHE_OBJECT_LIMIT, GIT_OBJ_COMMIT,
+                                      size_t(t.commitCacheLimit));
+            }
+            if (rc >= 0) {
+                rc = git_libgit2_opts(GIT_OPT_SET_CACHE_OBJECT_LIMIT, GIT_OBJ_TREE,
+                                      size_t(t.treeCacheLimit));
+            }
+            if (rc >= 0) {
+                rc = git_libgit2_opts(GIT_OPT_SET_CACHE_OBJECT_LIMIT, GIT_OBJ_BLOB,
+                                      size_t(t.blobCacheLimit));
+            }
+            if (rc >= 0) {
+                rc = git_libgit2_opts(GIT_OPT_SET_CACHE_OBJECT_LIMIT, GIT_OBJ_TAG,
+                                      size_t(t.tagCacheLimit));
+            }
+            if (rc >= 0) {
+                rc = git_libgit2_opts(GIT_OPT_SET_MWINDOW_SIZE, size_t(t.mwindowSize));
+            }
+            if (rc >= 0) {
+                rc = git_libgit2_opts(GIT_OPT_SET_MWINDOW_MAPPED_LIMIT,
+                                      size_t(t.mwindowMappedLimit));
+            }
+
+            return rc;
+        }
+
+    }
+
+    GitWrap::Tuning::Tuning()
+        : cachingEnabled(true)
+        , cacheMaxSize(256 * 1024 * 1024)
+        , commitCacheLimit(4096)
+        , treeCacheLimit(4096)
+        , blobCacheLimit(0)
+        , tagCacheLimit(4096)
+        , mwindowSize(sizeof(void*) >= 8 ? 1024 * 1024 * 1024 : 32 * 1024 * 1024)
+        , mwindowMappedLimit(sizeof(void*) >= 8 ? Q_INT64_C(8192) * 1024 * 1024
+                                                : 256 * 1024 * 1024)
+        , internSignatures(true)
+    {
+    }
+
+    GitWrap::CacheStats::CacheStats()
+        : cachedBytes(0)
+        , cacheMaxSize(0)
+        , retainedBytes(0)
+        , commits(0)
+        , trees(0)
+        , blobs(0)
+        , tags(0)
+    {
     }
 
     GitWrap::GitWrap(bool autoInit)
@@ -419,6 +523,25 @@ namespace Git
         }
     }
 
+    /**
+     * @brief       Constructor
+     *
+     * @param[in]   tuning      The settings to apply to libgit2; see setTuning(). If they are not
+     *                          valid, the current settings are kept.
+     *
+     * @param[in]   autoInit    Whether to initialise libgit2 right away.
+     */
+    GitWrap::GitWrap(const Tuning& tuning, bool autoInit)
+        : mInitialised(false)
+    {
+        Result r;
+        setTuning(r, tuning);
+
+        if (autoInit) {
+            init();
+        }
+    }
+
     GitWrap::~GitWrap()
     {
         shutDown();
@@ -428,6 +551,11 @@ namespace Git
     {
         if (!mInitialised) {
             git_libgit2_init();
+
+            QMutexLocker lock(Internal::sTuningLock());
+            if (!Internal::sInitCount++ && Internal::applyTuning(*Internal::sTuning()) < 0) {
+                giterr_clear();
+            }
         }
         mInitialised = true;
     }
@@ -435,8 +563,82 @@ namespace Git
     void GitWrap::shutDown()
     {
         if (mInitialised) {
+            QMutexLocker lock(Internal::sTuningLock());
+            Internal::sInitCount--;
+            lock.unlock();
+
             git_libgit2_shutdown();
         }
         mInitialised = false;
     }
+
+    /**
+     * @brief       Get the current settings for libgit2's caches and pack file windows
+     *
+     * @return      The settings that were last set with setTuning(); or the defaults.
+     */
+    GitWrap::Tuning GitWrap::tuning()
+    {
+        QMutexLocker lock(Internal::sTuningLock());
+        return *Internal::sTuning();
+    }
+
+    /**
+     * @brief           Change the settings for libgit2's caches and pack file windows
+     *
+     * The settings are process wide. If libgit2 is initialised, they take effect immediately;
+     * otherwise they are applied by init(). Lowering the cache budgets does not evict objects
+     * right away, but as soon as libgit2 stores the next object.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       tuning  The new settings. Sizes must not be negative and must fit into the
+     *                          address space; the window size must not be zero.
+     */
+    void GitWrap::setTuning(Result& result, const Tuning& tuning)
+    {
+        GW_CHECK_RESULT( result, void() );
+
+        if (!Internal::isValidTuning(tuning)) {
+            result.setError("Invalid tuning: A size is out of range.", GIT_ERROR);
+            return;
+        }
+
+        QMutexLocker lock(Internal::sTuningLock());
+        *Internal::sTuning() = tuning;
+        Internal::sInternSignatures.storeRelease(tuning.internSignatures ? 1 : 0);
+
+        if (Internal::sInitCount) {
+            result = Internal::applyTuning(tuning);
+        }
+    }
+
+    /**
+     * @brief       Read the process wide cache usage
+     *
+     * @return      A snapshot of libgit2's cache usage and the totals of the object caches of all
+     *              repositories that are currently open.
+     */
+    GitWrap::CacheStats GitWrap::cacheStats()
+    {
+        CacheStats s;
+
+        ssize_t current = 0, allowed = 0;
+        if (git_libgit2_opts(GIT_OPT_GET_CACHED_MEMORY, &current, &allowed) < 0) {
+            giterr_clear();
+        }
+        else {
+            s.cachedBytes = current;
+            s.cacheMaxSize = allowed;
+        }
+
+        ObjectCacheStats totals = Internal::ObjectCache::totals();
+        s.retainedBytes = totals.memoryUsed;
+        s.commits       = totals.commits;
+        s.trees         = totals.trees;
+        s.blobs         = totals.blobs;
+        s.tags          = totals.tags;
+
+        return s;
+    }
 }
@@ -98,9 +98,14 @@ namespace Git
     class Repository;
     class RevisionWalker;
     class Signature;
+    class StatusConsumer;
+    class StatusOptions;
     class Submodule;
     class TreeBuilder;
+    class TreeEntries;
     class TreeEntry;
+    class TreeEntryView;
+    class TreeVisitor;
     struct ChangeListEntry;
 
     typedef QVector< ChangeListEntry >  ChangeList;
@@ -149,6 +154,9 @@ namespace Git
      * @var         FileWorkingTreeTypeChange
      *              The file type changed in the working tree.
      *
+     * @var         FileWorkingTreeRenamed
+     *              The file was moved or renamed in the working tree.
+     *
      * @var         FileIgnored
      *              The file is marked as ignored (i.e. it is filtered in .gitignore).
      *
@@ -221,6 +229,7 @@ namespace Git
         FileWorkingTreeModified     = (1u << 8),
         FileWorkingTreeDeleted      = (1u << 9),
         FileWorkingTreeTypeChange   = (1u << 10),
+        FileWorkingTreeRenamed      = (1u << 11),
 
         FileIgnored                 = (1u << 14),
         FileUnchanged               = (1u << 15),
@@ -311,20 +320,107 @@ namespace Git
 
     typedef QFlags<CheckoutFlag> CheckoutFlags;
 
+    enum TreeWalkOrder
+    {
+        TreeWalkPreOrder,
+        TreeWalkPostOrder
+    };
+
+    enum TreeWalkFlag
+    {
+        TreeWalkSkipTrees               = (1UL <<  0),
+        TreeWalkSkipSubmodules          = (1UL <<  1),
+        TreeWalkUnordered               = (1UL <<  2),
+
+        TreeWalkNone                    = 0
+    };
+
+    typedef QFlags<TreeWalkFlag> TreeWalkFlags;
+
     typedef QHash<QString, StatusFlags> StatusHash;
 
     class Result;
 
     class GITWRAP_API GitWrap
     {
+    public:
+        /**
+         * @brief       Process wide settings for libgit2's caches and pack file windows
+         *
+         * The default values are libgit2's own defaults.
+         *
+         * internSignatures is GitWrap's own setting.
+         *
+         * @see         GitWrap::setTuning()
+         */
+        struct GITWRAP_API Tuning
+        {
+            Tuning();
+
+            /** Whether libgit2 caches objects at all */
+            bool        cachingEnabled;
+
+            /** Budget in bytes for the objects that libgit2 caches, over all repositories */
+            qint64      cacheMaxSize;
+
+            /** Objects larger than these (in bytes) are not cached by libgit2; a limit of zero
+             *  disables caching objects of that type */
+            qint64      commitCacheLimit;
+            qint64      treeCacheLimit;
+            qint64      blobCacheLimit;
+            qint64      tagCacheLimit;
+
+            /** Size in bytes of one window that is mapped from a pack file */
+            qint64      mwindowSize;
+
+            /** Budget in bytes for all windows that are mapped from pack files */
+            qint64      mwindowMappedLimit;
+
+            /** Whether the names and emails of the signatures that are read from a repository
+             *  share their data; otherwise each signature decodes them anew */
+            bool        internSignatures;
+        };
+
+        /**
+         * @brief       Process wide cache usage
+         *
+         * @see         GitWrap::cacheStats()
+         */
+        struct GITWRAP_API CacheStats
+        {
+            CacheStats();
+
+            /** Bytes of objects in libgit2's caches of all repositories */
+            qint64      cachedBytes;
+
+            /** The budget for @ref cachedBytes */
+            qint64      cacheMaxSize;
+
+            /** Estimated bytes of the objects retained by the object caches of all repositories;
+             *  see Repository::objectCacheStats() */
+            quint64     retainedBytes;
+
+            /** Number of objects retained by the object caches of all repositories */
+            int         commits;
+            int         trees;
+            int         blobs;
+            int         tags;
+        };
+
     public:
         GitWrap(bool autoInit = true);
+        GitWrap(const Tuning& tuning, bool autoInit = true);
         ~GitWrap();
 
     public:
         void init();
         void shutDown();
 
+    public:
+        static Tuning tuning();
+        static void setTuning(Result& result, const Tuning& tuning);
+        static CacheStats cacheStats();
+
     private:
         bool mInitialised;
     };
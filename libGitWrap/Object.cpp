@@ -37,12 +37,17 @@ namespace Git
         ObjectPrivate::ObjectPrivate(RepositoryPrivate* repo, git_object* o)
             : RepoObjectPrivate(repo)
             , mObj(o)
+            , mCached(false)
         {
             Q_ASSERT(o);
         }
 
         ObjectPrivate::~ObjectPrivate()
         {
+            if (mCached) {
+                repo()->mObjects.forget(this);
+            }
+
             git_object_free(mObj);
         }
 
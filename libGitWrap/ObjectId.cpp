@@ -17,6 +17,7 @@
 #include "libGitWrap/ObjectId.hpp"
 
 #include "libGitWrap/Private/GitWrapPrivate.hpp"
+#include "libGitWrap/Private/HexCodec.hpp"
 
 namespace Git
 {
@@ -40,6 +41,19 @@ namespace Git
 
     ObjectId ObjectId::fromAscii( const QByteArray& oid, int max, bool* success )
     {
+        if( max >= SHA1_LengthHex && oid.length() >= SHA1_LengthHex )
+        {
+            ObjectId id;
+            bool ok = Internal::HexCodec::decodeId( oid.constData(), id.data );
+
+            if( success )
+            {
+                *success = ok;
+            }
+
+            return ok ? id : ObjectId();
+        }
+
         git_oid gitoid;
 
         if( git_oid_fromstrn( &gitoid, oid.constData(),
@@ -67,19 +81,95 @@ namespace Git
         return id;
     }
 
+    /**
+     * @brief       Parse many hex encoded ids at once
+     *
+     * @param[in]   hex     The hex digits. The first id starts at @a hex, the next one @a stride
+     *                      bytes later and so on. Each id must be exactly 40 hex digits long; what
+     *                      is between them (e.g. line breaks) is ignored.
+     *
+     * @param[in]   n       Number of ids to parse.
+     *
+     * @param[out]  ids     Array of at least @a n ObjectIds to store the result in.
+     *
+     * @param[in]   stride  Distance in bytes from the start of one id to the start of the next
+     *                      one. Must not be less than 40.
+     *
+     * @return      The number of ids that were parsed. This is less than @a n, if the id at the
+     *              returned index contains anything but hex digits.
+     */
+    int ObjectId::parseMany( const char* hex, int n, ObjectId* ids, int stride )
+    {
+        Q_ASSERT( stride >= SHA1_LengthHex );
+
+        for( int i = 0; i < n; ++i, hex += stride )
+        {
+            if( !Internal::HexCodec::decodeId( hex, ids[ i ].data ) )
+            {
+                ids[ i ] = ObjectId();
+                return i;
+            }
+        }
+
+        return n;
+    }
+
+    /**
+     * @brief       Format many ids as hex at once
+     *
+     * @param[in]   ids     The ids to format.
+     *
+     * @param[in]   n       Number of ids in @a ids.
+     *
+     * @param[out]  hex     The buffer to write to. Exactly 40 lower case hex digits are written
+     *                      per id; the bytes between them are not touched and no terminating zero
+     *                      is written.
+     *
+     * @param[in]   stride  Distance in bytes from the start of one id to the start of the next
+     *                      one. Must not be less than 40.
+     */
+    void ObjectId::formatMany( const ObjectId* ids, int n, char* hex, int stride )
+    {
+        Q_ASSERT( stride >= SHA1_LengthHex );
+
+        for( int i = 0; i < n; ++i, hex += stride )
+        {
+            Internal::HexCodec::encodeId( ids[ i ].data, hex );
+        }
+    }
+
     QString ObjectId::toString(int max) const
     {
-        return GW_StringToQt(toAscii(max)); // UTF-8 is Ascii, actually :-)
+        char hex[ SHA1_LengthHex + 1 ];
+        toAscii( hex );
+        return QString::fromLatin1( hex, qBound( 0, max, int( SHA1_LengthHex ) ) );
     }
 
     QByteArray ObjectId::toAscii(int max) const
     {
-        max = qMax(0,qMin<int>(SHA1_LengthHex, max)) + 1;
-        QByteArray id(max, 0);
-        git_oid_tostr(id.data(), max, (const git_oid*) data);
+        max = qMax(0,qMin<int>(SHA1_LengthHex, max));
+
+        // Like git_oid_tostr(), the array includes the terminating zero
+        char hex[ SHA1_LengthHex ];
+        Internal::HexCodec::encodeId( data, hex );
+
+        QByteArray id( max + 1, 0 );
+        memcpy( id.data(), hex, max );
         return id;
     }
 
+    /**
+     * @brief       Format this id as hex without allocating
+     *
+     * @param[out]  hex     A buffer of at least 41 bytes. It receives 40 lower case hex digits and
+     *                      a terminating zero.
+     */
+    void ObjectId::toAscii(char* hex) const
+    {
+        Internal::HexCodec::encodeId( data, hex );
+        hex[ SHA1_LengthHex ] = 0;
+    }
+
     bool ObjectId::operator==( const ObjectId& other ) const
     {
         return !memcmp( data, other.data, SHA1_Length );
@@ -101,21 +191,19 @@ namespace Git
         return true;
     }
 
-    static uint hash(const unsigned char *p, int n)
-    {
-        uint h = 0;
-
-        while (n--) {
-            h = (h << 4) + *p++;
-            h ^= (h & 0xf0000000) >> 23;
-            h &= 0x0fffffff;
-        }
-        return h;
-    }
-
+    /**
+     * @brief       Hash an ObjectId for QHash and QSet
+     *
+     * The bytes of a SHA-1 are uniformly distributed, so there is no need to mix them. The hash
+     * is simply the first machine word of the id.
+     *
+     * For large amounts of ids, consider using ObjectIdSet or ObjectIdMap instead.
+     */
     uint qHash( const ObjectId& sha1 )
     {
-        return hash( sha1.raw(), 20 );
+        uint h;
+        memcpy( &h, sha1.raw(), sizeof( h ) );
+        return h;
     }
 
 }
@@ -48,8 +48,14 @@ namespace Git
 
         static ObjectId fromRaw( const unsigned char* raw, int n = SHA1_Length );
 
+        static int parseMany( const char* hex, int n, ObjectId* ids,
+                              int stride = SHA1_LengthHex );
+        static void formatMany( const ObjectId* ids, int n, char* hex,
+                                int stride = SHA1_LengthHex );
+
         QString toString(int max = SHA1_LengthHex) const;
         QByteArray toAscii(int max = SHA1_LengthHex) const;
+        void toAscii(char* hex) const;
 
         const unsigned char* raw() const
         {
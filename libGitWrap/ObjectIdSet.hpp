@@ -0,0 +1,524 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <string.h>
+#include <utility>
+#include <vector>
+
+#include "libGitWrap/ObjectId.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @brief       Storage for the values of an ObjectIdTable
+         *
+         * Specialized for `void`, so that an ObjectIdSet carries no value array at all.
+         */
+        template<typename T>
+        class ObjectIdTableValues
+        {
+        public:
+            void resize(size_t n)                   { mValues.clear(); mValues.resize(n); }
+            void moveTo(ObjectIdTableValues& o, size_t to, size_t from)
+                                                    { o.mValues[to] = std::move(mValues[from]); }
+            void move(size_t to, size_t from)       { mValues[to] = std::move(mValues[from]); }
+            void reset(size_t i)                    { mValues[i] = T(); }
+            void swap(ObjectIdTableValues& o)       { mValues.swap(o.mValues); }
+
+            T& at(size_t i)                         { return mValues[i]; }
+            const T& at(size_t i) const             { return mValues[i]; }
+
+        private:
+            std::vector<T> mValues;
+        };
+
+        template<>
+        class ObjectIdTableValues<void>
+        {
+        public:
+            void resize(size_t)                                     {}
+            void moveTo(ObjectIdTableValues&, size_t, size_t)       {}
+            void move(size_t, size_t)                               {}
+            void reset(size_t)                                      {}
+            void swap(ObjectIdTableValues&)                         {}
+        };
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Open addressing hash table keyed by ObjectId
+         *
+         * The table is one flat array of keys (plus one of values, for maps) and a parallel array
+         * of control bytes. A control byte is 0 for a free slot; otherwise its high bit is set and
+         * the lower bits carry 7 more bits of the key. Probing is linear and mostly runs over the
+         * control bytes; a key is only compared, if its control byte matches.
+         *
+         * The bits of a SHA-1 are uniformly distributed already. So, the hash is nothing more
+         * than the first 8 bytes of the id, spread by a Fibonacci multiplication.
+         *
+         * The table grows at a load factor of 3/4. Removal uses backward shifting, so there are
+         * no tombstones.
+         */
+        template<typename T>
+        class ObjectIdTable
+        {
+        public:
+            ObjectIdTable()
+                : mShift(64)
+                , mMask(0)
+                , mCount(0)
+            {
+            }
+
+        public:
+            int count() const       { return int(mCount); }
+            int size() const        { return int(mCount); }
+            bool isEmpty() const    { return !mCount; }
+            int capacity() const    { return int(mCtrl.size() - mCtrl.size() / 4); }
+
+            void clear()
+            {
+                std::vector<quint8>().swap(mCtrl);
+                std::vector<ObjectId>().swap(mKeys);
+                ObjectIdTableValues<T>().swap(mValues);
+                mShift = 64;
+                mMask = 0;
+                mCount = 0;
+            }
+
+            /**
+             * @brief       Make room for a number of entries
+             *
+             * After reserving room for @a n entries, inserting up to @a n entries does not
+             * rehash.
+             */
+            void reserve(int n)
+            {
+                size_t slots = 8;
+                while (slots - slots / 4 < size_t(n)) {
+                    slots *= 2;
+                }
+
+                if (slots > mCtrl.size()) {
+                    rehash(slots);
+                }
+            }
+
+            bool contains(const ObjectId& id) const
+            {
+                return find(id) != npos;
+            }
+
+        protected:
+            enum : size_t { npos = size_t(-1) };
+
+            static quint64 hashOf(const ObjectId& id)
+            {
+                quint64 w;
+                memcpy(&w, id.raw(), sizeof(w));
+                return w * Q_UINT64_C(0x9E3779B97F4A7C15);
+            }
+
+            static quint8 tagOf(const ObjectId& id)
+            {
+                return quint8(0x80 | id.raw()[8]);
+            }
+
+            size_t home(const ObjectId& id) const
+            {
+                return size_t(hashOf(id) >> mShift);
+            }
+
+            size_t find(const ObjectId& id) const
+            {
+                if (!mCount) {
+                    return npos;
+                }
+
+                const quint8 tag = tagOf(id);
+
+                for (size_t i = home(id); ; i = (i + 1) & mMask) {
+                    quint8 c = mCtrl[i];
+
+                    if (!c) {
+                        return npos;
+                    }
+
+                    if (c == tag && mKeys[i] == id) {
+                        return i;
+                    }
+                }
+            }
+
+            /**
+             * @brief       Find the slot of a key or claim a free one for it
+             *
+             * @param[in]   id      The key.
+             *
+             * @param[out]  isNew   Set to `true` if the key was not in the table before.
+             *
+             * @return      The slot index. Any iterators and slot indices obtained before are
+             *              invalid if @a isNew is set.
+             */
+            size_t findOrInsert(const ObjectId& id, bool& isNew)
+            {
+                if (mCount + 1 > mCtrl.size() - mCtrl.size() / 4) {
+                    rehash(mCtrl.empty() ? 8 : mCtrl.size() * 2);
+                }
+
+                const quint8 tag = tagOf(id);
+
+                for (size_t i = home(id); ; i = (i + 1) & mMask) {
+                    quint8 c = mCtrl[i];
+
+                    if (!c) {
+                        mCtrl[i] = tag;
+                        mKeys[i] = id;
+                        mCount++;
+                        isNew = true;
+                        return i;
+                    }
+
+                    if (c == tag && mKeys[i] == id) {
+                        isNew = false;
+                        return i;
+                    }
+                }
+            }
+
+            bool removeKey(const ObjectId& id)
+            {
+                size_t i = find(id);
+                if (i == npos) {
+                    return false;
+                }
+
+                // Shift following entries of the cluster back, unless they are at their home slot
+                // or would be moved in front of it.
+                for (size_t j = (i + 1) & mMask; mCtrl[j]; j = (j + 1) & mMask) {
+                    size_t h = home(mKeys[j]);
+
+                    if (((j - h) & mMask) >= ((j - i) & mMask)) {
+                        mCtrl[i] = mCtrl[j];
+                        mKeys[i] = mKeys[j];
+                        mValues.move(i, j);
+                        i = j;
+                    }
+                }
+
+                mCtrl[i] = 0;
+                mValues.reset(i);
+                mCount--;
+                return true;
+            }
+
+            size_t nextUsed(size_t i) const
+            {
+                while (i < mCtrl.size() && !mCtrl[i]) {
+                    ++i;
+                }
+                return i;
+            }
+
+            size_t slotCount() const
+            {
+                return mCtrl.size();
+            }
+
+        private:
+            void rehash(size_t slots)
+            {
+                std::vector<quint8> ctrl(slots, 0);
+                std::vector<ObjectId> keys(slots);
+                ObjectIdTableValues<T> values;
+                values.resize(slots);
+
+                int shift = 64;
+                for (size_t s = slots; s > 1; s >>= 1) {
+                    shift--;
+                }
+
+                size_t mask = slots - 1;
+
+                for (size_t j = 0; j < mCtrl.size(); ++j) {
+                    if (!mCtrl[j]) {
+                        continue;
+                    }
+
+                    size_t i = size_t(hashOf(mKeys[j]) >> shift);
+                    while (ctrl[i]) {
+                        i = (i + 1) & mask;
+                    }
+
+                    ctrl[i] = mCtrl[j];
+                    keys[i] = mKeys[j];
+                    mValues.moveTo(values, i, j);
+                }
+
+                mCtrl.swap(ctrl);
+                mKeys.swap(keys);
+                mValues.swap(values);
+                mShift = shift;
+                mMask = mask;
+            }
+
+        protected:
+            std::vector<quint8>     mCtrl;
+            std::vector<ObjectId>   mKeys;
+            ObjectIdTableValues<T>  mValues;
+            int                     mShift;
+            size_t                  mMask;
+            size_t                  mCount;
+        };
+
+    }
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       A set of ObjectIds
+     *
+     * Use this instead of `QSet<ObjectId>` to track large amounts of ids, i.e. the commits seen
+     * during a walk. It stores the ids in one flat array without per entry allocations and does
+     * not spend time on hashing the ids.
+     *
+     * Unlike Qt's containers, ObjectIdSet is not implicitly shared; copying it copies the data.
+     * Inserting may invalidate all iterators.
+     */
+    class ObjectIdSet : public Internal::ObjectIdTable<void>
+    {
+    public:
+        class const_iterator
+        {
+            friend class ObjectIdSet;
+
+        public:
+            const_iterator() : mSet(nullptr), mSlot(0) {}
+
+        public:
+            const ObjectId& operator*() const   { return mSet->mKeys[mSlot]; }
+            const ObjectId* operator->() const  { return &mSet->mKeys[mSlot]; }
+
+            const_iterator& operator++()        { mSlot = mSet->nextUsed(mSlot + 1); return *this; }
+
+            bool operator==(const const_iterator& o) const { return mSlot == o.mSlot; }
+            bool operator!=(const const_iterator& o) const { return mSlot != o.mSlot; }
+
+        private:
+            const_iterator(const ObjectIdSet* set, size_t slot) : mSet(set), mSlot(slot) {}
+
+        private:
+            const ObjectIdSet*  mSet;
+            size_t              mSlot;
+        };
+
+        typedef const_iterator iterator;
+
+    public:
+        ObjectIdSet()
+        {
+        }
+
+        explicit ObjectIdSet(const ObjectIdList& ids)
+        {
+            insert(ids);
+        }
+
+    public:
+        /**
+         * @brief       Insert an id
+         * @return      `true` if @a id was not in the set before.
+         */
+        bool insert(const ObjectId& id)
+        {
+            bool isNew;
+            findOrInsert(id, isNew);
+            return isNew;
+        }
+
+        /**
+         * @brief       Insert many ids at once
+         * @return      The number of ids that were not in the set before.
+         */
+        int insert(const ObjectIdList& ids)
+        {
+            reserve(count() + ids.count());
+
+            int added = 0;
+            for (int i = 0; i < ids.count(); ++i) {
+                added += insert(ids.at(i)) ? 1 : 0;
+            }
+            return added;
+        }
+
+        bool remove(const ObjectId& id)
+        {
+            return removeKey(id);
+        }
+
+        ObjectIdList toList() const
+        {
+            ObjectIdList list;
+            list.reserve(count());
+            for (const_iterator it = begin(); it != end(); ++it) {
+                list.append(*it);
+            }
+            return list;
+        }
+
+        ObjectIdSet& operator<<(const ObjectId& id)
+        {
+            insert(id);
+            return *this;
+        }
+
+    public:
+        const_iterator begin() const        { return const_iterator(this, nextUsed(0)); }
+        const_iterator end() const          { return const_iterator(this, slotCount()); }
+        const_iterator constBegin() const   { return begin(); }
+        const_iterator constEnd() const     { return end(); }
+    };
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       A hash map with ObjectIds as keys
+     *
+     * Use this instead of `QHash<ObjectId, T>` for large amounts of ids. Entries are stored in
+     * flat arrays without per entry allocations.
+     *
+     * @a T must be default constructible and movable. Unlike Qt's containers, ObjectIdMap is not
+     * implicitly shared; copying it copies the data. Inserting may invalidate all iterators and
+     * pointers returned by find().
+     */
+    template<typename T>
+    class ObjectIdMap : public Internal::ObjectIdTable<T>
+    {
+        typedef Internal::ObjectIdTable<T> Base;
+
+    public:
+        class const_iterator
+        {
+            friend class ObjectIdMap;
+
+        public:
+            const_iterator() : mMap(nullptr), mSlot(0) {}
+
+        public:
+            const ObjectId& key() const         { return mMap->mKeys[mSlot]; }
+            const T& value() const              { return mMap->mValues.at(mSlot); }
+            const T& operator*() const          { return value(); }
+
+            const_iterator& operator++()        { mSlot = mMap->nextUsed(mSlot + 1); return *this; }
+
+            bool operator==(const const_iterator& o) const { return mSlot == o.mSlot; }
+            bool operator!=(const const_iterator& o) const { return mSlot != o.mSlot; }
+
+        private:
+            const_iterator(const ObjectIdMap* map, size_t slot) : mMap(map), mSlot(slot) {}
+
+        private:
+            const ObjectIdMap*  mMap;
+            size_t              mSlot;
+        };
+
+    public:
+        ObjectIdMap()
+        {
+        }
+
+    public:
+        /**
+         * @brief       Insert or replace a value
+         * @return      `true` if @a id was not in the map before.
+         */
+        bool insert(const ObjectId& id, const T& value)
+        {
+            bool isNew;
+            size_t i = Base::findOrInsert(id, isNew);
+            Base::mValues.at(i) = value;
+            return isNew;
+        }
+
+        bool remove(const ObjectId& id)
+        {
+            return Base::removeKey(id);
+        }
+
+        /**
+         * @brief       Find the value for a key
+         * @return      A pointer to the value or `nullptr` if @a id is not in the map.
+         */
+        T* find(const ObjectId& id)
+        {
+            size_t i = Base::find(id);
+            return i == Base::npos ? nullptr : &Base::mValues.at(i);
+        }
+
+        const T* find(const ObjectId& id) const
+        {
+            size_t i = Base::find(id);
+            return i == Base::npos ? nullptr : &Base::mValues.at(i);
+        }
+
+        T value(const ObjectId& id, const T& defaultValue = T()) const
+        {
+            const T* v = find(id);
+            return v ? *v : defaultValue;
+        }
+
+        /**
+         * @brief       Access the value for a key, inserting a default constructed one if needed
+         */
+        T& operator[](const ObjectId& id)
+        {
+            bool isNew;
+            return Base::mValues.at(Base::findOrInsert(id, isNew));
+        }
+
+        ObjectIdList keys() const
+        {
+            ObjectIdList list;
+            list.reserve(Base::count());
+            for (const_iterator it = begin(); it != end(); ++it) {
+                list.append(it.key());
+            }
+            return list;
+        }
+
+        QVector<T> values() const
+        {
+            QVector<T> list;
+            list.reserve(Base::count());
+            for (const_iterator it = begin(); it != end(); ++it) {
+                list.append(it.value());
+            }
+            return list;
+        }
+
+    public:
+        const_iterator begin() const        { return const_iterator(this, Base::nextUsed(0)); }
+        const_iterator end() const          { return const_iterator(this, Base::slotCount()); }
+        const_iterator constBegin() const   { return begin(); }
+        const_iterator constEnd() const     { return end(); }
+    };
+
+}
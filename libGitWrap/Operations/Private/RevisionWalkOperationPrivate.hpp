@@ -0,0 +1,84 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+#include "libGitWrap/RevisionWalker.hpp"
+
+#include "libGitWrap/Operations/RevisionWalkOperation.hpp"
+
+#include "libGitWrap/Operations/Private/BaseOperationPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         *
+         * The tips and limits are only recorded until run() applies them to a RevisionWalker on a
+         * handle of its own. Everything below mMutex is shared between the walk and the consumer.
+         */
+        class RevisionWalkOperationPrivate : public BaseOperationPrivate
+        {
+        public:
+            RevisionWalkOperationPrivate(RevisionWalkOperation* owner);
+            ~RevisionWalkOperationPrivate();
+
+        public:
+            void run();
+            void cancel();
+
+        private:
+            bool setup(RevisionWalker& walker);
+            bool enqueue(const ObjectIdList& batch);
+            void finish();
+
+        public:
+            Repository              mRepo;
+            ObjectIdList            mPush;
+            ObjectIdList            mHide;
+            QStringList             mPushRefs;
+            QStringList             mHideRefs;
+            unsigned int            mSorting;
+            QStringList             mPaths;
+            bool                    mFirstParent;
+            int                     mSkip;
+            int                     mMaxCount;
+            QDateTime               mSince;
+            QDateTime               mUntil;
+            int                     mBatchSize;
+            int                     mMaxQueued;
+
+            mutable QMutex          mMutex;
+            QWaitCondition          mNotFull;
+            QWaitCondition          mNotEmpty;
+            QQueue<ObjectIdList>    mQueue;
+            bool                    mCancel;
+            bool                    mDone;
+        };
+
+    }
+
+}
@@ -0,0 +1,429 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <climits>
+
+#include <QElapsedTimer>
+
+#include "libGitWrap/Operations/Private/RevisionWalkOperationPrivate.hpp"
+
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        RevisionWalkOperationPrivate::RevisionWalkOperationPrivate(RevisionWalkOperation* owner)
+            : BaseOperationPrivate(owner)
+            , mSorting(GIT_SORT_NONE)
+            , mFirstParent(false)
+            , mSkip(0)
+            , mMaxCount(-1)
+            , mBatchSize(RevisionWalkOperation::DefaultBatchSize)
+            , mMaxQueued(RevisionWalkOperation::DefaultMaxQueuedBatches)
+            , mCancel(false)
+            , mDone(false)
+        {
+        }
+
+        RevisionWalkOperationPrivate::~RevisionWalkOperationPrivate()
+        {
+        }
+
+        bool RevisionWalkOperationPrivate::setup(RevisionWalker& walker)
+        {
+            walker.setSorting(mResult, (mSorting & GIT_SORT_TOPOLOGICAL) != 0,
+                              (mSorting & GIT_SORT_TIME) != 0);
+            if (mFirstParent) {
+                walker.simplifyFirstParent(mResult);
+            }
+
+            walker.setPathFilter(mResult, mPaths);
+            walker.setSkip(mResult, mSkip);
+            walker.setMaxCount(mResult, mMaxCount);
+            walker.setDateWindow(mResult, mSince, mUntil);
+
+            foreach (const ObjectId& id, mPush) {
+                walker.push(mResult, id);
+            }
+
+            foreach (const QString& name, mPushRefs) {
+                walker.pushRef(mResult, name);
+            }
+
+            foreach (const ObjectId& id, mHide) {
+                walker.hide(mResult, id);
+            }
+
+            foreach (const QString& name, mHideRefs) {
+                walker.hideRef(mResult, name);
+            }
+
+            return mResult;
+        }
+
+        /**
+         * @internal
+         * @brief       Hand a batch to the consumer
+         *
+         * In background mode, this blocks while the queue is full.
+         *
+         * @return      `false` if the operation was cancelled.
+         */
+        bool RevisionWalkOperationPrivate::enqueue(const ObjectIdList& batch)
+        {
+            QMutexLocker lock(&mMutex);
+
+            while (mBackgroundMode && !mCancel && mQueue.count() >= mMaxQueued) {
+                mNotFull.wait(&mMutex);
+            }
+
+            if (mCancel) {
+                return false;
+            }
+
+            mQueue.enqueue(batch);
+            mNotEmpty.wakeAll();
+            lock.unlock();
+
+            GW_OP_OWNER(RevisionWalkOperation);
+            emit owner->batchReady();
+            return true;
+        }
+
+        void RevisionWalkOperationPrivate::finish()
+        {
+            QMutexLocker lock(&mMutex);
+            mDone = true;
+            mNotEmpty.wakeAll();
+        }
+
+        void RevisionWalkOperationPrivate::cancel()
+        {
+            QMutexLocker lock(&mMutex);
+            mCancel = true;
+            mQueue.clear();
+            mNotFull.wakeAll();
+            mNotEmpty.wakeAll();
+        }
+
+        void RevisionWalkOperationPrivate::run()
+        {
+            // Whatever a previous execute() left behind
+            {
+                QMutexLocker lock(&mMutex);
+                mQueue.clear();
+                mCancel = false;
+                mDone = false;
+            }
+            mResult = Result();
+
+            Repository repo;
+            if (!mRepo.isValid()) {
+                mResult.setInvalidObject();
+            }
+            else if (git_repository* handle =
+                     BasePrivate::dataOf<Repository>(mRepo)->openHandle(mResult)) {
+                repo = new RepositoryPrivate(handle);
+            }
+
+            RevisionWalker walker = RevisionWalker::create(mResult, repo);
+
+            if (mResult && setup(walker)) {
+                ObjectIdList batch;
+
+                forever {
+                    batch.resize(mBatchSize);
+
+                    int count = walker.nextBatch(mResult, batch.data(), mBatchSize);
+
+                    batch.resize(count);
+                    if (count && !enqueue(batch)) {
+                        break;
+                    }
+
+                    if (count < mBatchSize) {
+                        break;
+                    }
+                }
+            }
+
+            finish();
+        }
+
+    }
+
+    /**
+     * @brief       Constructor
+     *
+     * @param[in]   repo    The repository to walk. The walk itself uses a handle of its own.
+     *
+     * @param[in]   parent  The parent QObject.
+     */
+    RevisionWalkOperation::RevisionWalkOperation(const Repository& repo, QObject* parent)
+        : BaseOperation(*new Private(this), parent)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        d->mRepo = repo;
+    }
+
+    /**
+     * @brief       Destructor
+     *
+     * A walk that is still running is cancelled, and the destructor waits for it to stop.
+     */
+    RevisionWalkOperation::~RevisionWalkOperation()
+    {
+        GW_OP_D(RevisionWalkOperation);
+        d->cancel();
+
+        if (d->mThread) {
+            // workerFinished() won't be delivered anymore; so clean up the thread here.
+            d->mThread->wait();
+            d->mThread->disconnect(this);
+            delete d->mThread;
+            d->mThread = nullptr;
+        }
+    }
+
+    Repository RevisionWalkOperation::repository() const
+    {
+        GW_OP_CD(RevisionWalkOperation);
+        return d->mRepo;
+    }
+
+    void RevisionWalkOperation::push(const ObjectId& id)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mPush.append(id);
+    }
+
+    void RevisionWalkOperation::pushRef(const QString& name)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mPushRefs.append(name);
+    }
+
+    void RevisionWalkOperation::pushHead()
+    {
+        pushRef(QStringLiteral("HEAD"));
+    }
+
+    void RevisionWalkOperation::hide(const ObjectId& id)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mHide.append(id);
+    }
+
+    void RevisionWalkOperation::hideRef(const QString& name)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mHideRefs.append(name);
+    }
+
+    void RevisionWalkOperation::hideHead()
+    {
+        hideRef(QStringLiteral("HEAD"));
+    }
+
+    /**
+     * @brief       Set the order of the walk
+     *
+     * @param[in]   topological     Parents are never shown before their children.
+     *
+     * @param[in]   timed           Commits are ordered by their commit time.
+     *
+     * Both sortings delay the first batch until libgit2 has looked at the whole history.
+     */
+    void RevisionWalkOperation::setSorting(bool topological, bool timed)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mSorting = (topological ? GIT_SORT_TOPOLOGICAL : 0) | (timed ? GIT_SORT_TIME : 0);
+    }
+
+    /**
+     * @brief       Limit the walk to the commits that change some paths
+     *
+     * @param[in]   paths   The paths; an empty list removes the filter.
+     *
+     * @see         RevisionWalker::setPathFilter()
+     */
+    void RevisionWalkOperation::setPathFilter(const QStringList& paths)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mPaths = paths;
+    }
+
+    QStringList RevisionWalkOperation::pathFilter() const
+    {
+        GW_OP_CD(RevisionWalkOperation);
+        return d->mPaths;
+    }
+
+    /**
+     * @brief       Follow only the first parent of merge commits
+     *
+     * @see         RevisionWalker::simplifyFirstParent()
+     */
+    void RevisionWalkOperation::simplifyFirstParent()
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mFirstParent = true;
+    }
+
+    /**
+     * @brief       Leave out the first commits of the walk
+     *
+     * @see         RevisionWalker::setSkip()
+     */
+    void RevisionWalkOperation::setSkip(int count)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mSkip = qMax(count, 0);
+    }
+
+    /**
+     * @brief       End the walk after a number of commits
+     *
+     * @see         RevisionWalker::setMaxCount()
+     */
+    void RevisionWalkOperation::setMaxCount(int count)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mMaxCount = count < 0 ? -1 : count;
+    }
+
+    /**
+     * @brief       Return only commits that were committed within a time span
+     *
+     * @see         RevisionWalker::setDateWindow()
+     */
+    void RevisionWalkOperation::setDateWindow(const QDateTime& since, const QDateTime& until)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mSince = since;
+        d->mUntil = until;
+    }
+
+    int RevisionWalkOperation::batchSize() const
+    {
+        GW_OP_CD(RevisionWalkOperation);
+        return d->mBatchSize;
+    }
+
+    void RevisionWalkOperation::setBatchSize(int size)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mBatchSize = qMax(1, size);
+    }
+
+    int RevisionWalkOperation::maxQueuedBatches() const
+    {
+        GW_OP_CD(RevisionWalkOperation);
+        return d->mMaxQueued;
+    }
+
+    void RevisionWalkOperation::setMaxQueuedBatches(int count)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        Q_ASSERT(!isRunning());
+        d->mMaxQueued = qMax(1, count);
+    }
+
+    /**
+     * @brief       Take the next batch of commit ids
+     *
+     * @param[in]   timeout     Milliseconds to wait for a batch, if none is queued; `-1` waits
+     *                          until there is a batch or the walk is over.
+     *
+     * @return      The ids in the order of the walk or an empty list if no batch became ready in
+     *              time. Use atEnd() to tell whether more batches will follow.
+     */
+    ObjectIdList RevisionWalkOperation::takeBatch(int timeout)
+    {
+        GW_OP_D(RevisionWalkOperation);
+        QMutexLocker lock(&d->mMutex);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        while (d->mQueue.isEmpty() && !d->mDone && !d->mCancel) {
+            unsigned long wait = ULONG_MAX;
+            if (timeout >= 0) {
+                qint64 left = timeout - timer.elapsed();
+                if (left <= 0) {
+                    break;
+                }
+                wait = (unsigned long)left;
+            }
+
+            d->mNotEmpty.wait(&d->mMutex, wait);
+        }
+
+        if (d->mQueue.isEmpty()) {
+            return ObjectIdList();
+        }
+
+        ObjectIdList batch = d->mQueue.dequeue();
+        d->mNotFull.wakeAll();
+        return batch;
+    }
+
+    /**
+     * @brief       Check whether all batches have been taken
+     *
+     * @return      `true` if the walk is over (or cancelled) and no batch is queued anymore.
+     */
+    bool RevisionWalkOperation::atEnd() const
+    {
+        GW_OP_CD(RevisionWalkOperation);
+        QMutexLocker lock(&d->mMutex);
+        return (d->mDone || d->mCancel) && d->mQueue.isEmpty();
+    }
+
+    bool RevisionWalkOperation::isCancelled() const
+    {
+        GW_OP_CD(RevisionWalkOperation);
+        QMutexLocker lock(&d->mMutex);
+        return d->mCancel;
+    }
+
+    /**
+     * @brief       Stop the walk
+     *
+     * The walk stops after the batch it is working on; all queued batches are dropped. The
+     * operation finishes as usual.
+     */
+    void RevisionWalkOperation::cancel()
+    {
+        GW_OP_D(RevisionWalkOperation);
+        d->cancel();
+    }
+
+}
@@ -0,0 +1,112 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QDateTime>
+
+#include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/Repository.hpp"
+
+#include "libGitWrap/Operations/BaseOperation.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+        class RevisionWalkOperationPrivate;
+    }
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Walks a repository's history and hands out the commits in batches
+     *
+     * In background mode, the walk runs on its own thread with its own libgit2 handle. Every
+     * time a batch of ids is ready, batchReady() is emitted; takeBatch() hands the batches out in
+     * order. At most maxQueuedBatches() batches are held; the walk pauses until the consumer
+     * takes one. So a view can show the first page of the history right away, while the rest
+     * streams in only as fast as it is needed.
+     *
+     * With topological or time sorting, libgit2 has to look at the whole history before it can
+     * yield the first commit. Without any sorting, the first batch is ready almost immediately.
+     *
+     * The walk is done by a RevisionWalker, so the path filter and the other limits work the same
+     * as there and the batches hold exactly the commits that RevisionWalker::all() would return.
+     *
+     * Without background mode, execute() queues the whole walk before it returns; the queue is
+     * not bounded then.
+     *
+     * cancel() stops the walk after the batch it is working on; pending batches are dropped.
+     *
+     * Once the walk is over, execute() can be called again. The walk then starts over.
+     */
+    class GITWRAP_API RevisionWalkOperation : public BaseOperation
+    {
+        Q_OBJECT
+    public:
+        typedef Internal::RevisionWalkOperationPrivate Private;
+
+        enum
+        {
+            DefaultBatchSize        = 200,
+            DefaultMaxQueuedBatches = 16
+        };
+
+    public:
+        RevisionWalkOperation(const Repository& repo, QObject* parent = 0);
+        ~RevisionWalkOperation();
+
+    public:
+        Repository repository() const;
+
+        void push(const ObjectId& id);
+        void pushRef(const QString& name);
+        void pushHead();
+
+        void hide(const ObjectId& id);
+        void hideRef(const QString& name);
+        void hideHead();
+
+        void setSorting(bool topological, bool timed);
+
+        void setPathFilter(const QStringList& paths);
+        QStringList pathFilter() const;
+
+        void simplifyFirstParent();
+        void setSkip(int count);
+        void setMaxCount(int count);
+        void setDateWindow(const QDateTime& since, const QDateTime& until = QDateTime());
+
+        int batchSize() const;
+        void setBatchSize(int size);
+
+        int maxQueuedBatches() const;
+        void setMaxQueuedBatches(int count);
+
+    public:
+        ObjectIdList takeBatch(int timeout = 0);
+        bool atEnd() const;
+        bool isCancelled() const;
+
+    public slots:
+        void cancel();
+
+    signals:
+        void batchReady();
+    };
+
+}
@@ -80,6 +80,7 @@ namespace Git
         public:
             void addRef() const;
             void delRef() const;
+            bool tryAddRef() const;
 
         private:
             mutable QAtomicInt mRef;
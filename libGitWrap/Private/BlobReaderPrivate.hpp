@@ -0,0 +1,139 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QFile>
+
+#include <zlib.h>
+
+#include "libGitWrap/BlobReader.hpp"
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        class BlobReaderPrivate
+        {
+        public:
+            enum Source
+            {
+                None,
+                Loose,          // inflated from the loose object file by ourselves
+                Packed,         // inflated from an undeltified pack entry by ourselves
+                Stream,         // an ODB read stream
+                Buffer          // a whole object, read by libgit2
+            };
+
+            enum
+            {
+                // "blob " + up to 20 digits + NUL
+                MaxHeaderSize   = 32,
+
+                // Longest header of a pack entry: type and a 64 bit size, 7 bits per byte
+                MaxPackHeader   = 10
+            };
+
+        public:
+            BlobReaderPrivate(const Repository& repo, const ObjectId& id, const QString& path);
+            ~BlobReaderPrivate();
+
+        public:
+            bool open(Result& result);
+            void close();
+
+            qint64 remaining() const;
+            qint64 read(Result& result, char* data, qint64 maxSize);
+
+        private:
+            bool openRaw(Result& result, git_repository* repo);
+            bool reopenRaw(Result& result);
+            void closeRaw();
+
+            bool startInflate(Result& result);
+            bool openLoose(Result& result);
+            bool openPacked(Result& result);
+            bool openStream(Result& result, git_odb* odb);
+            bool openBuffer(Result& result, git_odb* odb);
+            bool openFiltered(Result& result, git_repository* repo, git_filter_list* filters);
+            bool canBuffer(Result& result, qint64 size);
+
+            bool planFilters(Result& result, git_repository* repo, git_filter_list* filters);
+            bool scanText(Result& result, git_repository* repo, git_filter_list* filters);
+
+            qint64 inflateInto(Result& result, char* data, qint64 maxSize);
+            qint64 readRaw(Result& result, char* data, qint64 maxSize);
+            qint64 readFiltered(Result& result, char* data, qint64 maxSize);
+
+        public:
+            Repository          mRepo;
+            ObjectId            mId;
+            QString             mPath;
+            int                 mChunkSize;
+            qint64              mBufferLimit;
+            bool                mBuffered;
+            Result              mResult;
+
+            Source              mSource;
+            qint64              mSize;
+            qint64              mPos;
+
+            // The content as it is stored
+            qint64              mRawSize;
+            qint64              mRawPos;
+
+            // Loose and Packed
+            QString             mFileName;
+            qint64              mOffset;
+            QFile               mFile;
+            QByteArray          mInput;
+            z_stream            mZ;
+            bool                mZInit;
+            bool                mZEnd;
+            char                mHeader[MaxHeaderSize];
+            int                 mHeaderPos;
+            int                 mHeaderEnd;
+
+            // Stream
+            git_odb_stream*     mStream;
+
+            // Buffer
+            git_odb_object*     mObject;
+            git_buf             mFiltered;
+            const char*         mData;
+
+            // Built-in filters, applied while reading. The ident span is in raw offsets.
+            bool                mIdentOn;
+            bool                mCrlfOn;
+            bool                mConvert;
+            bool                mToCrlf;
+            bool                mLoneLfOnly;
+            char                mLastRaw;
+            qint64              mIdentStart;
+            qint64              mIdentEnd;
+            QByteArray          mIdent;
+            QByteArray          mChunk;
+            QByteArray          mPending;
+            int                 mPendingPos;
+        };
+
+    }
+
+}
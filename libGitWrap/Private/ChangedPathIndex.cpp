@@ -0,0 +1,478 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QFile>
+#include <QSet>
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "libGitWrap/Private/ChangedPathIndex.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        enum : quint32
+        {
+            IndexSignature  = 0x47574350,   // "GWCP"
+            IndexVersion    = 1,
+            Seed0           = 0x293ae76f,
+            Seed1           = 0x7e646e2c
+        };
+
+        enum
+        {
+            HeaderSize      = 16,
+            RecordHeader    = ObjectId::SHA1_Length + 4
+        };
+
+        static inline quint32 be32(const uchar* p)
+        {
+            return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3];
+        }
+
+        static inline void appendBe32(QByteArray& data, quint32 v)
+        {
+            data.append(char(v >> 24));
+            data.append(char(v >> 16));
+            data.append(char(v >> 8));
+            data.append(char(v));
+        }
+
+        static inline quint32 rotl32(quint32 v, int n)
+        {
+            return (v << n) | (v >> (32 - n));
+        }
+
+        static quint32 murmur3(quint32 seed, const QByteArray& data)
+        {
+            const quint32 c1 = 0xcc9e2d51;
+            const quint32 c2 = 0x1b873593;
+
+            const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+            const int len = data.length();
+            quint32 h = seed;
+
+            for (int i = 0; i + 4 <= len; i += 4) {
+                quint32 k = quint32(p[i]) | (quint32(p[i + 1]) << 8) |
+                            (quint32(p[i + 2]) << 16) | (quint32(p[i + 3]) << 24);
+                k *= c1;
+                k = rotl32(k, 15);
+                k *= c2;
+
+                h ^= k;
+                h = rotl32(h, 13);
+                h = h * 5 + 0xe6546b64;
+            }
+
+            const uchar* tail = p + (len & ~3);
+            quint32 k = 0;
+
+            switch (len & 3) {
+            case 3: k ^= quint32(tail[2]) << 16;    // fall through
+            case 2: k ^= quint32(tail[1]) << 8;     // fall through
+            case 1: k ^= tail[0];
+                k *= c1;
+                k = rotl32(k, 15);
+                k *= c2;
+                h ^= k;
+            }
+
+            h ^= quint32(len);
+            h ^= h >> 16;
+            h *= 0x85ebca6b;
+            h ^= h >> 13;
+            h *= 0xc2b2ae35;
+            h ^= h >> 16;
+            return h;
+        }
+
+        static inline quint32 bitOf(const ChangedPathIndex::Key& key, int i, quint32 bits)
+        {
+            return (key.hash0 + quint32(i) * key.hash1) % bits;
+        }
+
+        ChangedPathIndex::ChangedPathIndex()
+            : mParsed(0)
+        {
+        }
+
+        void ChangedPathIndex::clear()
+        {
+            mData.clear();
+            mParsed = 0;
+            mFilters.clear();
+        }
+
+        /**
+         * @internal
+         * @brief       Read the records that were appended to the file since the last call
+         *
+         * If the file shrunk or has a header that we don't understand, it is read from scratch
+         * or ignored.
+         */
+        void ChangedPathIndex::refresh(git_repository* repo)
+        {
+            QString fileName = GW_StringToQt(git_repository_path(repo)) +
+                               QStringLiteral("objects/info/gitwrap-changed-paths");
+
+            if (fileName != mFileName) {
+                clear();
+                mFileName = fileName;
+            }
+
+            QFile file(mFileName);
+            if (!file.open(QIODevice::ReadOnly)) {
+                clear();
+                return;
+            }
+
+            const qint64 size = file.size();
+            if (size < mData.size()) {
+                clear();
+            }
+
+            if (mData.isEmpty()) {
+                QByteArray header = file.read(HeaderSize);
+                const uchar* h = reinterpret_cast<const uchar*>(header.constData());
+
+                if (header.size() != HeaderSize || be32(h) != IndexSignature ||
+                        be32(h + 4) != IndexVersion || be32(h + 8) != NumHashes ||
+                        be32(h + 12) != BitsPerEntry) {
+                    return;
+                }
+
+                mData = header;
+                mParsed = HeaderSize;
+            }
+
+            if (size == mData.size() || !file.seek(mData.size())) {
+                return;
+            }
+
+            mData.append(file.read(size - mData.size()));
+
+            const uchar* data = reinterpret_cast<const uchar*>(mData.constData());
+            const int end = mData.size();
+
+            // A record that is cut short is still being written; it's parsed next time.
+            while (mParsed + RecordHeader <= end) {
+                const int length = int(be32(data + mParsed + ObjectId::SHA1_Length));
+                if (length < 1 || length > end - mParsed - RecordHeader) {
+                    break;
+                }
+
+                mFilters.insert(ObjectId::fromRaw(data + mParsed), mParsed + RecordHeader);
+                mParsed += RecordHeader + length;
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Ask whether a commit might have changed any of some paths
+         *
+         * @return      `Unknown` if the commit is not indexed, `No` if none of the paths changed
+         *              and `Maybe` otherwise.
+         */
+        ChangedPathIndex::Answer ChangedPathIndex::query(const ObjectId& commit,
+                                                         const Keys& keys) const
+        {
+            const int* pos = mFilters.find(commit);
+            if (!pos) {
+                return Unknown;
+            }
+
+            const uchar* filter = reinterpret_cast<const uchar*>(mData.constData()) + *pos;
+            const quint32 bits = be32(filter - 4) * 8;
+
+            foreach (const Key& key, keys) {
+                int i = 0;
+                while (i < NumHashes) {
+                    const quint32 bit = bitOf(key, i, bits);
+                    if (!(filter[bit / 8] & (1 << (bit % 8)))) {
+                        break;
+                    }
+                    ++i;
+                }
+
+                if (i == NumHashes) {
+                    return Maybe;
+                }
+            }
+
+            return No;
+        }
+
+        /**
+         * @internal
+         * @brief       Find the commits that are not in the index yet
+         *
+         * @return      The commits of @a commits that have no filter, without duplicates.
+         */
+        ObjectIdList ChangedPathIndex::missingOf(const ObjectIdList& commits) const
+        {
+            ObjectIdList missing;
+            ObjectIdSet queued;
+
+            foreach (const ObjectId& id, commits) {
+                if (!contains(id) && queued.insert(id)) {
+                    missing.append(id);
+                }
+            }
+
+            return missing;
+        }
+
+        /**
+         * @internal
+         * @brief       Create a lock file exclusively
+         *
+         * @return      `false` if the file exists already or cannot be created.
+         */
+        static bool createLockFile(QFile& file)
+        {
+            const QByteArray name = QFile::encodeName(file.fileName());
+
+            #ifdef Q_OS_WIN
+            int fd = ::_open(name.constData(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY,
+                             _S_IREAD | _S_IWRITE);
+            #else
+            int fd = ::open(name.constData(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+            #endif
+
+            if (fd < 0) {
+                return false;
+            }
+
+            if (!file.open(fd, QIODevice::WriteOnly, QFileDevice::AutoCloseHandle)) {
+                #ifdef Q_OS_WIN
+                ::_close(fd);
+                #else
+                ::close(fd);
+                #endif
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Move a lock file into the place of the file that it locks
+         */
+        static bool commitLockFile(const QString& lockName, const QString& fileName)
+        {
+            #ifdef Q_OS_WIN
+            // rename() does not replace existing files on Windows
+            QFile::remove(fileName);
+            #endif
+
+            return ::rename(QFile::encodeName(lockName).constData(),
+                            QFile::encodeName(fileName).constData()) == 0;
+        }
+
+        /**
+         * @internal
+         * @brief       Append records to the index file
+         *
+         * Like git does for its own files, the new content is written to a `.lock` file next to
+         * the index, which is then renamed over the index. Creating the `.lock` file fails while
+         * another process is writing, so no records of other processes get lost. Readers see
+         * either the old or the new file, never one that is half written.
+         *
+         * The new file holds what the index file holds now plus @a records. If the file does not
+         * exist or has a header that we don't understand, it is written from scratch. A record at
+         * its end that was cut short is dropped.
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       repo    The repository that the index belongs to.
+         *
+         * @param[in]       records The records, as created by buildRecord().
+         *
+         * @return          `true` on success.
+         */
+        bool ChangedPathIndex::append(Result& result, git_repository* repo,
+                                      const QByteArray& records)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            refresh(repo);
+
+            const QString lockName = mFileName + QStringLiteral(".lock");
+            QFile lock(lockName);
+            if (!createLockFile(lock)) {
+                result.setError("Cannot lock the changed path index.", GIT_ERROR);
+                return false;
+            }
+
+            // Nobody else can replace the file now; pick up what was written before we locked.
+            refresh(repo);
+
+            QByteArray data;
+
+            if (mData.isEmpty()) {
+                appendBe32(data, IndexSignature);
+                appendBe32(data, IndexVersion);
+                appendBe32(data, NumHashes);
+                appendBe32(data, BitsPerEntry);
+            }
+            else {
+                mData.truncate(mParsed);
+                data = mData;
+            }
+
+            data.append(records);
+
+            bool ok = lock.write(data) == data.size() && lock.flush();
+            lock.close();
+
+            if (!ok || !commitLockFile(lockName, mFileName)) {
+                QFile::remove(lockName);
+                result.setError("Cannot write the changed path index.", GIT_ERROR);
+                return false;
+            }
+
+            refresh(repo);
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Hash a path for queries
+         *
+         * @param[in]   path    The path, UTF-8 encoded and without leading or trailing slashes.
+         */
+        ChangedPathIndex::Key ChangedPathIndex::keyFor(const QByteArray& path)
+        {
+            Key key;
+            key.hash0 = murmur3(Seed0, path);
+            key.hash1 = murmur3(Seed1, path);
+            return key;
+        }
+
+        /**
+         * @internal
+         * @brief       Compute the record for one commit
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       repo    The repository to read the commit and its trees from.
+         *
+         * @param[in]       commit  The commit to compute the filter for.
+         *
+         * @param[in,out]   record  The record is appended to this buffer.
+         *
+         * @return          `true` on success.
+         */
+        bool ChangedPathIndex::buildRecord(Result& result, git_repository* repo,
+                                           const ObjectId& commit, QByteArray& record)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            git_commit* c = nullptr;
+            git_tree* tree = nullptr;
+            git_tree* parentTree = nullptr;
+            git_diff* diff = nullptr;
+
+            result = git_commit_lookup(&c, repo, ObjectId2git(commit));
+
+            if (result) {
+                result = git_commit_tree(&tree, c);
+            }
+
+            if (result && git_commit_parentcount(c)) {
+                git_commit* parent = nullptr;
+                result = git_commit_parent(&parent, c, 0);
+                if (result) {
+                    result = git_commit_tree(&parentTree, parent);
+                    git_commit_free(parent);
+                }
+            }
+
+            if (result) {
+                result = git_diff_tree_to_tree(&diff, repo, parentTree, tree, nullptr);
+            }
+
+            QSet<QByteArray> paths;
+            if (result) {
+                const size_t deltas = git_diff_num_deltas(diff);
+
+                for (size_t i = 0; i < deltas && paths.count() <= MaxChanges; ++i) {
+                    const git_diff_delta* delta = git_diff_get_delta(diff, i);
+                    QByteArray path(delta->new_file.path ? delta->new_file.path
+                                                         : delta->old_file.path);
+
+                    // The path and all of its leading directories
+                    forever {
+                        paths.insert(path);
+
+                        int slash = path.lastIndexOf('/');
+                        if (slash < 1) {
+                            break;
+                        }
+
+                        path.truncate(slash);
+                    }
+                }
+            }
+
+            git_diff_free(diff);
+            git_tree_free(parentTree);
+            git_tree_free(tree);
+            git_commit_free(c);
+
+            GW_CHECK_RESULT(result, false);
+
+            QByteArray filter;
+            if (paths.isEmpty()) {
+                filter = QByteArray(1, char(0x00));
+            }
+            else if (paths.count() > MaxChanges) {
+                filter = QByteArray(1, char(0xff));
+            }
+            else {
+                filter = QByteArray((paths.count() * BitsPerEntry + 7) / 8, char(0));
+                const quint32 bits = quint32(filter.size()) * 8;
+
+                foreach (const QByteArray& path, paths) {
+                    const Key key = keyFor(path);
+                    for (int i = 0; i < NumHashes; ++i) {
+                        const quint32 bit = bitOf(key, i, bits);
+                        filter[int(bit / 8)] = char(filter.at(int(bit / 8)) | (1 << (bit % 8)));
+                    }
+                }
+            }
+
+            record.append(reinterpret_cast<const char*>(commit.raw()), ObjectId::SHA1_Length);
+            appendBe32(record, quint32(filter.size()));
+            record.append(filter);
+            return true;
+        }
+
+    }
+
+}
@@ -0,0 +1,126 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QMutex>
+#include <QVector>
+
+#include "libGitWrap/ObjectIdSet.hpp"
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Bloom filters of the paths that each commit changes
+         *
+         * For every indexed commit, the index holds a Bloom filter of the paths that differ
+         * between the commit and its first parent (or the empty tree for a root commit). The
+         * leading directories of these paths are included. The filters follow git's changed-path
+         * filters: 10 bits per path, 7 hash functions derived from two Murmur3 hashes, a single
+         * zero byte if nothing changed and a single 0xff byte if more than 512 paths changed.
+         *
+         * If a commit's filter says a path did not change, the commit is known to be the same as
+         * its first parent at that path. If it says the path might have changed, the trees have
+         * to be compared.
+         *
+         * The index is stored in `objects/info/gitwrap-changed-paths`. After a 16 byte header,
+         * the file holds one record per commit: the commit's id, the filter's length as big
+         * endian 32 bit value and the filter. Records are only ever appended; refresh() thus
+         * reads only what was appended since the last call. Writers replace the file through a
+         * `.lock` file, the same way git updates its own files.
+         */
+        class ChangedPathIndex
+        {
+        public:
+            enum Answer
+            {
+                Unknown     = -1,
+                No          = 0,
+                Maybe       = 1
+            };
+
+            enum
+            {
+                NumHashes       = 7,
+                BitsPerEntry    = 10,
+                MaxChanges      = 512
+            };
+
+            struct Key
+            {
+                quint32     hash0;
+                quint32     hash1;
+            };
+
+            typedef QVector<Key> Keys;
+
+        public:
+            ChangedPathIndex();
+
+        public:
+            void refresh(git_repository* repo);
+
+            int count() const;
+            bool contains(const ObjectId& commit) const;
+            Answer query(const ObjectId& commit, const Keys& keys) const;
+
+            ObjectIdList missingOf(const ObjectIdList& commits) const;
+            bool append(Result& result, git_repository* repo, const QByteArray& records);
+
+            QMutex& mutex();
+
+        public:
+            static Key keyFor(const QByteArray& path);
+            static bool buildRecord(Result& result, git_repository* repo, const ObjectId& commit,
+                                    QByteArray& record);
+
+        private:
+            void clear();
+
+        private:
+            mutable QMutex      mMutex;
+            QString             mFileName;
+            QByteArray          mData;
+            int                 mParsed;
+            ObjectIdMap<int>    mFilters;
+        };
+
+        inline int ChangedPathIndex::count() const
+        {
+            return mFilters.count();
+        }
+
+        inline bool ChangedPathIndex::contains(const ObjectId& commit) const
+        {
+            return mFilters.find(commit) != nullptr;
+        }
+
+        inline QMutex& ChangedPathIndex::mutex()
+        {
+            return mMutex;
+        }
+
+    }
+
+}
@@ -0,0 +1,431 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QFile>
+#include <QScopedPointer>
+
+#include "libGitWrap/Private/CommitGraph.hpp"
+#include "libGitWrap/Private/FileStamp.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        enum : quint32
+        {
+            GraphSignature  = 0x43475048,   // "CGPH"
+            ChunkOidFanout  = 0x4f494446,   // "OIDF"
+            ChunkOidLookup  = 0x4f49444c,   // "OIDL"
+            ChunkData       = 0x43444154,   // "CDAT"
+            ChunkEdges      = 0x45444745,   // "EDGE"
+
+            ParentNone      = 0x70000000,
+            ParentEdge      = 0x80000000,
+            EdgeLast        = 0x80000000
+        };
+
+        enum
+        {
+            HeaderSize      = 8,
+            ChunkEntrySize  = 12,
+            DataEntrySize   = ObjectId::SHA1_Length + 16
+        };
+
+        static inline quint32 be32(const uchar* p)
+        {
+            return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3];
+        }
+
+        static inline quint64 be64(const uchar* p)
+        {
+            return (quint64(be32(p)) << 32) | be32(p + 4);
+        }
+
+        CommitGraph::Layer::Layer()
+            : file(nullptr)
+            , fanout(nullptr)
+            , oids(nullptr)
+            , data(nullptr)
+            , edges(nullptr)
+            , numEdges(0)
+            , count(0)
+            , base(0)
+        {
+        }
+
+        CommitGraph::Layer::~Layer()
+        {
+            // Closing the file unmaps it
+            delete file;
+        }
+
+        CommitGraph::CommitGraph()
+            : mCount(0)
+        {
+        }
+
+        CommitGraph::~CommitGraph()
+        {
+            qDeleteAll(mLayers);
+        }
+
+        /**
+         * @internal
+         * @brief       Map one commit-graph file and locate its chunks
+         *
+         * @return      The layer or `nullptr` if the file is missing, has an unknown version or
+         *              is truncated.
+         */
+        CommitGraph::Layer* CommitGraph::openLayer(const QString& fileName)
+        {
+            QScopedPointer<Layer> layer(new Layer);
+            layer->file = new QFile(fileName);
+
+            if (!layer->file->open(QIODevice::ReadOnly)) {
+                return nullptr;
+            }
+
+            qint64 size = layer->file->size();
+            if (size < HeaderSize + ChunkEntrySize) {
+                return nullptr;
+            }
+
+            const uchar* map = layer->file->map(0, size);
+            if (!map) {
+                return nullptr;
+            }
+
+            // Version 1, SHA-1 only
+            if (be32(map) != GraphSignature || map[4] != 1 || map[5] != 1) {
+                return nullptr;
+            }
+
+            int numChunks = map[6];
+            quint64 dataLength = 0;
+            if (HeaderSize + qint64(numChunks + 1) * ChunkEntrySize > size) {
+                return nullptr;
+            }
+
+            for (int i = 0; i < numChunks; ++i) {
+                const uchar* entry = map + HeaderSize + i * ChunkEntrySize;
+                quint64 offset = be64(entry + 4);
+                quint64 next = be64(entry + ChunkEntrySize + 4);
+
+                if (offset > quint64(size) || next > quint64(size) || next < offset) {
+                    return nullptr;
+                }
+
+                const uchar* chunk = map + offset;
+                quint64 length = next - offset;
+
+                switch (be32(entry)) {
+                case ChunkOidFanout:
+                    if (length < 256 * 4) {
+                        return nullptr;
+                    }
+                    layer->fanout = chunk;
+                    break;
+
+                case ChunkOidLookup:
+                    layer->oids = chunk;
+                    layer->count = int(length / ObjectId::SHA1_Length);
+                    break;
+
+                case ChunkData:
+                    layer->data = chunk;
+                    dataLength = length;
+                    break;
+
+                case ChunkEdges:
+                    layer->edges = chunk;
+                    layer->numEdges = quint32(length / 4);
+                    break;
+
+                default:
+                    break;
+                }
+            }
+
+            if (!layer->fanout || !layer->oids || !layer->data ||
+                    be32(layer->fanout + 255 * 4) != quint32(layer->count) ||
+                    dataLength < quint64(layer->count) * DataEntrySize) {
+                return nullptr;
+            }
+
+            return layer.take();
+        }
+
+        /**
+         * @internal
+         * @brief       Load the single graph file or the split chain
+         *
+         * In a chain, the first file is the base. The positions of a layer's commits follow the
+         * positions of all commits in the layers below it.
+         *
+         * @return      The graph or a null pointer if there is none or it cannot be read.
+         */
+        CommitGraph::Ptr CommitGraph::load(const QString& infoDir)
+        {
+            Ptr graph(new CommitGraph);
+
+            Layer* single = openLayer(infoDir + QStringLiteral("commit-graph"));
+            if (single) {
+                graph->mLayers.append(single);
+                graph->mCount = single->count;
+                return graph;
+            }
+
+            QFile chain(infoDir + QStringLiteral("commit-graphs/commit-graph-chain"));
+            if (!chain.open(QIODevice::ReadOnly)) {
+                return Ptr();
+            }
+
+            foreach (const QByteArray& line, chain.readAll().split('\n')) {
+                QByteArray hash = line.trimmed();
+                if (hash.isEmpty()) {
+                    continue;
+                }
+
+                Layer* layer = openLayer(infoDir + QStringLiteral("commit-graphs/graph-") +
+                                         QString::fromLatin1(hash) + QStringLiteral(".graph"));
+                if (!layer) {
+                    // A broken chain is useless; the layers above refer to the missing one.
+                    return Ptr();
+                }
+
+                layer->base = graph->mCount;
+                graph->mCount += layer->count;
+                graph->mLayers.append(layer);
+            }
+
+            return graph->mLayers.isEmpty() ? Ptr() : graph;
+        }
+
+        CommitGraphCache::CommitGraphCache()
+            : mGraphStamp(FileStamp::NeverScanned)
+            , mChainStamp(FileStamp::NeverScanned)
+            , mGraftsStamp(FileStamp::NeverScanned)
+        {
+        }
+
+        /**
+         * @internal
+         * @brief       Check for things that change the parents of commits
+         */
+        bool CommitGraphCache::hasOverrides(git_repository* repo)
+        {
+            if (git_repository_is_shallow(repo) == 1) {
+                return true;
+            }
+
+            QString gitDir = GW_StringToQt(git_repository_path(repo));
+            if (QFile::exists(gitDir + QStringLiteral("info/grafts"))) {
+                return true;
+            }
+
+            git_reference* ref = nullptr;
+            git_reference_iterator* it = nullptr;
+            bool found = false;
+
+            if (git_reference_iterator_glob_new(&it, repo, "refs/replace/*") == GIT_OK) {
+                found = git_reference_next(&ref, it) == GIT_OK;
+                if (found) {
+                    git_reference_free(ref);
+                }
+                git_reference_iterator_free(it);
+            }
+
+            giterr_clear();
+            return found;
+        }
+
+        /**
+         * @internal
+         * @brief       Get the up to date graph
+         *
+         * The files are only read again if their time stamps (or the one of the grafts file) have
+         * changed. Replace refs are only looked for at that time, too.
+         *
+         * @return      The graph or a null pointer if the repository has no usable one.
+         */
+        CommitGraph::Ptr CommitGraphCache::graph(git_repository* repo)
+        {
+            QString gitDir = GW_StringToQt(git_repository_path(repo));
+            QString infoDir = gitDir + QStringLiteral("objects/info/");
+            QString chainFile = infoDir + QStringLiteral("commit-graphs/commit-graph-chain");
+            qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+            qint64 graphStamp = FileStamp::stampFor(FileStamp::modificationTime(
+                                    infoDir + QStringLiteral("commit-graph")), now);
+            qint64 chainStamp = FileStamp::stampFor(FileStamp::modificationTime(chainFile), now);
+            qint64 graftsStamp = FileStamp::stampFor(FileStamp::modificationTime(
+                                    gitDir + QStringLiteral("info/grafts")), now);
+
+            QMutexLocker lock(&mMutex);
+
+            if (infoDir == mInfoDir &&
+                    graphStamp == mGraphStamp && graphStamp != FileStamp::NeverScanned &&
+                    chainStamp == mChainStamp && chainStamp != FileStamp::NeverScanned &&
+                    graftsStamp == mGraftsStamp) {
+                return mGraph;
+            }
+
+            mGraph = CommitGraph::Ptr();
+            mInfoDir = infoDir;
+            mGraphStamp = graphStamp;
+            mChainStamp = chainStamp;
+            mGraftsStamp = graftsStamp;
+
+            if (graphStamp == FileStamp::Missing && chainStamp == FileStamp::Missing) {
+                return mGraph;
+            }
+
+            if (hasOverrides(repo)) {
+                return mGraph;
+            }
+
+            mGraph = CommitGraph::load(infoDir);
+            return mGraph;
+        }
+
+        /**
+         * @internal
+         * @brief       Find the position of a commit
+         *
+         * @return      The position or -1 if the commit is not in the graph.
+         */
+        int CommitGraph::find(const ObjectId& id) const
+        {
+            const uchar* raw = id.raw();
+
+            foreach (const Layer* layer, mLayers) {
+                int lo = raw[0] ? int(be32(layer->fanout + (raw[0] - 1) * 4)) : 0;
+                int hi = int(be32(layer->fanout + raw[0] * 4));
+
+                while (lo < hi) {
+                    int mid = lo + (hi - lo) / 2;
+                    int cmp = memcmp(layer->oids + mid * ObjectId::SHA1_Length, raw,
+                                     ObjectId::SHA1_Length);
+                    if (cmp == 0) {
+                        return layer->base + mid;
+                    }
+                    if (cmp < 0) {
+                        lo = mid + 1;
+                    }
+                    else {
+                        hi = mid;
+                    }
+                }
+            }
+
+            return -1;
+        }
+
+        const CommitGraph::Layer* CommitGraph::layerOf(int pos) const
+        {
+            for (int i = mLayers.count() - 1; i >= 0; --i) {
+                if (pos >= mLayers.at(i)->base) {
+                    return pos < mLayers.at(i)->base + mLayers.at(i)->count ? mLayers.at(i)
+                                                                            : nullptr;
+                }
+            }
+            return nullptr;
+        }
+
+        ObjectId CommitGraph::id(int pos) const
+        {
+            const Layer* layer = layerOf(pos);
+            Q_ASSERT(layer);
+
+            return ObjectId::fromRaw(layer->oids + (pos - layer->base) * ObjectId::SHA1_Length);
+        }
+
+        quint32 CommitGraph::generation(int pos) const
+        {
+            const Layer* layer = layerOf(pos);
+            Q_ASSERT(layer);
+
+            const uchar* entry = layer->data + (pos - layer->base) * DataEntrySize;
+            return be32(entry + ObjectId::SHA1_Length + 8) >> 2;
+        }
+
+        qint64 CommitGraph::commitTime(int pos) const
+        {
+            const Layer* layer = layerOf(pos);
+            Q_ASSERT(layer);
+
+            const uchar* entry = layer->data + (pos - layer->base) * DataEntrySize;
+            quint64 high = be32(entry + ObjectId::SHA1_Length + 8) & 0x3;
+            return qint64((high << 32) | be32(entry + ObjectId::SHA1_Length + 12));
+        }
+
+        /**
+         * @internal
+         * @brief       Get the positions of a commit's parents
+         *
+         * @return      `false` if the file is corrupt.
+         */
+        bool CommitGraph::parents(int pos, Parents& parents) const
+        {
+            const Layer* layer = layerOf(pos);
+            Q_ASSERT(layer);
+
+            parents.clear();
+
+            const uchar* entry = layer->data + (pos - layer->base) * DataEntrySize;
+            quint32 p1 = be32(entry + ObjectId::SHA1_Length);
+            quint32 p2 = be32(entry + ObjectId::SHA1_Length + 4);
+
+            if (p1 == ParentNone) {
+                return true;
+            }
+            if (p1 >= quint32(mCount)) {
+                return false;
+            }
+            parents.append(int(p1));
+
+            if (p2 == ParentNone) {
+                return true;
+            }
+
+            if (!(p2 & ParentEdge)) {
+                if (p2 >= quint32(mCount)) {
+                    return false;
+                }
+                parents.append(int(p2));
+                return true;
+            }
+
+            // Octopus merge: The other parents are in the edge list
+            for (quint32 i = p2 & ~ParentEdge; layer->edges && i < layer->numEdges; ++i) {
+                quint32 edge = be32(layer->edges + i * 4);
+                if ((edge & ~EdgeLast) >= quint32(mCount)) {
+                    return false;
+                }
+                parents.append(int(edge & ~EdgeLast));
+                if (edge & EdgeLast) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    }
+
+}
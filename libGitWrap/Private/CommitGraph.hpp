@@ -0,0 +1,143 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QMutex>
+#include <QVarLengthArray>
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+class QFile;
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Reader for git's commit-graph files
+         *
+         * Reads `objects/info/commit-graph` or, if that does not exist, the split chain in
+         * `objects/info/commit-graphs`. The files are memory mapped; nothing is copied.
+         *
+         * Commits are addressed by their position in the graph. For each commit the graph knows
+         * its parents, its commit time and its generation number (the topological level). A
+         * commit's ancestors all have smaller generation numbers. The graph is closed under
+         * ancestry: All ancestors of a commit in the graph are in the graph, too.
+         *
+         * A loaded graph never changes; it can be walked from any thread without locking. Use
+         * CommitGraphCache to get the current graph of a repository. Commits that are newer than
+         * the graph simply aren't found; callers must fall back to parsing those from the ODB.
+         */
+        class CommitGraph : public QSharedData
+        {
+        public:
+            typedef QExplicitlySharedDataPointer<CommitGraph> Ptr;
+
+            enum : quint32
+            {
+                GenerationInfinity  = 0xffffffff,
+                GenerationZero      = 0
+            };
+
+            typedef QVarLengthArray<int, 2> Parents;
+
+        private:
+            struct Layer
+            {
+                Layer();
+                ~Layer();
+
+                QFile*          file;
+                const uchar*    fanout;
+                const uchar*    oids;
+                const uchar*    data;
+                const uchar*    edges;
+                quint32         numEdges;
+                int             count;
+                int             base;
+            };
+
+        public:
+            CommitGraph();
+            ~CommitGraph();
+
+        public:
+            static Ptr load(const QString& infoDir);
+
+            int count() const;
+            int find(const ObjectId& id) const;
+
+            ObjectId id(int pos) const;
+            quint32 generation(int pos) const;
+            qint64 commitTime(int pos) const;
+            bool parents(int pos, Parents& parents) const;
+
+        private:
+            static Layer* openLayer(const QString& fileName);
+            const Layer* layerOf(int pos) const;
+
+        private:
+            Q_DISABLE_COPY(CommitGraph)
+
+            QList<Layer*>   mLayers;
+            int             mCount;
+        };
+
+        inline int CommitGraph::count() const
+        {
+            return mCount;
+        }
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       The current commit-graph of a repository
+         *
+         * graph() reloads the files if they have changed. The graph is not used, if the
+         * repository is shallow or has grafts or replace refs, since the parents in the file
+         * might be wrong then.
+         *
+         * Only graph() itself is serialized. A graph that was handed out stays valid for as long
+         * as the caller holds on to it, even if a later call replaces it.
+         */
+        class CommitGraphCache
+        {
+        public:
+            CommitGraphCache();
+
+        public:
+            CommitGraph::Ptr graph(git_repository* repo);
+
+        private:
+            static bool hasOverrides(git_repository* repo);
+
+        private:
+            QMutex              mMutex;
+            CommitGraph::Ptr    mGraph;
+            QString             mInfoDir;
+            qint64              mGraphStamp;
+            qint64              mChainStamp;
+            qint64              mGraftsStamp;
+        };
+
+    }
+
+}
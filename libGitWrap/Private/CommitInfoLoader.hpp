@@ -0,0 +1,67 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "libGitWrap/CommitInfo.hpp"
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+#include "libGitWrap/Private/StringPool.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        class RepositoryPrivate;
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Decodes the meta data of many commits into a CommitInfoList
+         *
+         * The ids are split into chunks which are decoded on the WorkerPool. Each chunk uses its
+         * own `git_repository` handle, its own StringPool and its own parent list. These are
+         * merged into the final list after all chunks are done.
+         */
+        class CommitInfoLoader
+        {
+        private:
+            struct Chunk
+            {
+                Result          result;
+                StringPool      strings;
+                ObjectIdList    parents;
+            };
+
+        public:
+            CommitInfoLoader(RepositoryPrivate* repo);
+
+        public:
+            CommitInfoList load(Result& result, const ObjectIdList& ids);
+
+        private:
+            void decode(Chunk& chunk, git_repository* repo, const ObjectId* ids, CommitInfo* out,
+                        int count);
+
+        private:
+            RepositoryPrivate*  mRepo;
+        };
+
+    }
+
+}
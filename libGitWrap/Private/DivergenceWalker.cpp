@@ -0,0 +1,211 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libGitWrap/Private/DivergenceWalker.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        DivergenceWalker::DivergenceWalker(git_repository* repo, const CommitGraph* graph)
+            : mRepo(repo)
+            , mGraph(graph)
+            , mWords(0)
+            , mInteresting(0)
+        {
+        }
+
+        int DivergenceWalker::addTip(const ObjectId& id)
+        {
+            int* index = mTipIndex.find(id);
+            if (index) {
+                return *index;
+            }
+
+            mTips.append(id);
+            mTipIndex.insert(id, mTips.count() - 1);
+            return mTips.count() - 1;
+        }
+
+        /**
+         * @internal
+         * @brief       Add a pair of commits to compute the divergence for
+         *
+         * @return      The index of the pair; use it with ahead() and behind() after run().
+         */
+        int DivergenceWalker::addPair(const ObjectId& local, const ObjectId& other)
+        {
+            Pair p;
+            p.local = addTip(local);
+            p.other = addTip(other);
+            p.ahead = 0;
+            p.behind = 0;
+
+            mPairs.push_back(p);
+            return int(mPairs.size()) - 1;
+        }
+
+        bool DivergenceWalker::isInteresting(int node) const
+        {
+            for (size_t i = 0; i < mPairs.size(); ++i) {
+                if (hasBit(node, mPairs[i].local) != hasBit(node, mPairs[i].other)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @internal
+         * @brief       Get the node for a commit, parsing and queueing the commit if it is new
+         *
+         * @return      The node's index or -1 on failure.
+         */
+        int DivergenceWalker::nodeFor(Result& result, const ObjectId& id)
+        {
+            const int* index = mNodeIndex.find(id);
+            if (index) {
+                return *index;
+            }
+
+            Node node;
+            node.id = id;
+            node.firstParent = mParents.count();
+            node.queued = true;
+
+            int pos = mGraph ? mGraph->find(id) : -1;
+            CommitGraph::Parents parents;
+
+            if (pos != -1 && mGraph->parents(pos, parents)) {
+                node.time = mGraph->commitTime(pos);
+                node.numParents = parents.count();
+
+                for (int i = 0; i < parents.count(); ++i) {
+                    mParents.append(mGraph->id(parents[i]));
+                }
+            }
+            else {
+                git_commit* commit = nullptr;
+                result = git_commit_lookup(&commit, mRepo, ObjectId2git(id));
+                GW_CHECK_RESULT(result, -1);
+
+                node.time = git_commit_time(commit);
+                node.numParents = int(git_commit_parentcount(commit));
+
+                for (int i = 0; i < node.numParents; ++i) {
+                    mParents.append(ObjectId::fromRaw(git_commit_parent_id(commit, i)->id));
+                }
+
+                git_commit_free(commit);
+            }
+
+            int n = int(mNodes.size());
+            mNodes.push_back(node);
+            mMasks.resize(mMasks.size() + mWords, 0);
+            mNodeIndex.insert(id, n);
+            mQueue.push(QueueEntry(node.time, n));
+
+            return n;
+        }
+
+        /**
+         * @internal
+         * @brief       Walk the history and count
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @return          `true` on success.
+         */
+        bool DivergenceWalker::run(Result& result)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            mWords = size_t(mTips.count() + 63) / 64;
+
+            for (int i = 0; i < mTips.count(); ++i) {
+                int n = nodeFor(result, mTips.at(i));
+                if (n < 0) {
+                    return false;
+                }
+
+                bool was = isInteresting(n);
+                maskOf(n)[i / 64] |= Q_UINT64_C(1) << (i % 64);
+                mInteresting += int(isInteresting(n)) - int(was);
+            }
+
+            while (mInteresting > 0 && !mQueue.empty()) {
+                int n = mQueue.top().second;
+                mQueue.pop();
+
+                mNodes[n].queued = false;
+
+                if (isInteresting(n)) {
+                    --mInteresting;
+                }
+
+                const int firstParent = mNodes[n].firstParent;
+                const int numParents = mNodes[n].numParents;
+
+                for (int i = 0; i < numParents; ++i) {
+                    int parent = nodeFor(result, mParents.at(firstParent + i));
+                    if (parent < 0) {
+                        return false;
+                    }
+
+                    const quint64* from = maskOf(n);
+                    quint64* to = maskOf(parent);
+                    bool was = isInteresting(parent);
+                    bool grew = false;
+
+                    for (size_t w = 0; w < mWords; ++w) {
+                        grew |= (from[w] & ~to[w]) != 0;
+                        to[w] |= from[w];
+                    }
+
+                    if (mNodes[parent].queued) {
+                        mInteresting += int(isInteresting(parent)) - int(was);
+                    }
+                    else if (grew) {
+                        // The parent left the queue before its child; the commit times are
+                        // skewed. It must hand its new bits down, too.
+                        mNodes[parent].queued = true;
+                        mQueue.push(QueueEntry(mNodes[parent].time, parent));
+                        mInteresting += int(isInteresting(parent));
+                    }
+                }
+            }
+
+            // All commits that are still queued reach each pair's tips equally; they don't count.
+            for (int n = 0; n < int(mNodes.size()); ++n) {
+                for (size_t i = 0; i < mPairs.size(); ++i) {
+                    Pair& p = mPairs[i];
+                    bool reachedLocal = hasBit(n, p.local);
+                    bool reachedOther = hasBit(n, p.other);
+
+                    if (reachedLocal != reachedOther) {
+                        ++(reachedLocal ? p.ahead : p.behind);
+                    }
+                }
+            }
+
+            return true;
+        }
+
+    }
+
+}
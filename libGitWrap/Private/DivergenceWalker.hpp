@@ -0,0 +1,114 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <queue>
+#include <vector>
+
+#include "libGitWrap/ObjectIdSet.hpp"
+
+#include "libGitWrap/Private/CommitGraph.hpp"
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Computes ahead/behind counts for many pairs of commits in one walk
+         *
+         * Every distinct tip gets one bit. The walk visits commits in order of their commit time
+         * and hands the set of tips that can reach a commit down to the commit's parents. In the
+         * end, for every pair, a commit counts as "ahead" if only the pair's first tip reaches it
+         * and as "behind" if only the second one does.
+         *
+         * The walk stops once no queued commit can make a difference for any pair anymore, i.e.
+         * each pair's tips either both or both not reach every queued commit. A commit that gets
+         * new bits after it was visited (because of skewed commit times) is queued again.
+         *
+         * Every commit is parsed only once, no matter how many pairs it is relevant for. Commits
+         * that are in the commit-graph are not parsed at all.
+         */
+        class DivergenceWalker
+        {
+        private:
+            struct Node
+            {
+                ObjectId    id;
+                qint64      time;
+                int         firstParent;
+                int         numParents;
+                bool        queued;
+            };
+
+            struct Pair
+            {
+                int         local;
+                int         other;
+                size_t      ahead;
+                size_t      behind;
+            };
+
+            typedef std::pair<qint64, int> QueueEntry;
+
+        public:
+            DivergenceWalker(git_repository* repo, const CommitGraph* graph = nullptr);
+
+        public:
+            int addPair(const ObjectId& local, const ObjectId& other);
+            bool run(Result& result);
+
+            size_t ahead(int pair) const    { return mPairs[pair].ahead; }
+            size_t behind(int pair) const   { return mPairs[pair].behind; }
+
+        private:
+            int addTip(const ObjectId& id);
+            int nodeFor(Result& result, const ObjectId& id);
+            bool isInteresting(int node) const;
+
+            quint64* maskOf(int node)               { return &mMasks[size_t(node) * mWords]; }
+            const quint64* maskOf(int node) const   { return &mMasks[size_t(node) * mWords]; }
+
+            bool hasBit(int node, int bit) const
+            {
+                return (maskOf(node)[bit / 64] >> (bit % 64)) & 1;
+            }
+
+        private:
+            git_repository*             mRepo;
+            const CommitGraph*          mGraph;
+            ObjectIdList                mTips;
+            ObjectIdMap<int>            mTipIndex;
+            std::vector<Pair>           mPairs;
+
+            std::vector<Node>           mNodes;
+            ObjectIdMap<int>            mNodeIndex;
+            ObjectIdList                mParents;
+            std::vector<quint64>        mMasks;
+            size_t                      mWords;
+
+            std::priority_queue<QueueEntry> mQueue;
+            int                         mInteresting;
+        };
+
+    }
+
+}
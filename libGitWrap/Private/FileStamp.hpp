@@ -0,0 +1,71 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QFileInfo>
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Helpers to detect changes of files and directories by their mtime
+         *
+         * A path that was modified within the granularity of the file system's time stamps
+         * might be modified again without its time stamp changing visibly. Such a path is
+         * "racily clean"; stampFor() returns `NeverScanned` for it, so the caller looks at it
+         * again next time.
+         */
+        namespace FileStamp
+        {
+
+            enum : qint64
+            {
+                NeverScanned    = Q_INT64_C(-0x7fffffffffffffff),
+                Missing         = -1,
+                RacyMSecs       = 2000
+            };
+
+            /**
+             * @internal
+             * @brief       Modification time of a path in msecs since the epoch or `Missing`
+             */
+            inline qint64 modificationTime(const QString& path)
+            {
+                QFileInfo fi(path);
+                return fi.exists() ? fi.lastModified().toMSecsSinceEpoch() : qint64(Missing);
+            }
+
+            /**
+             * @internal
+             * @brief       The stamp to remember for a path that was just looked at
+             */
+            inline qint64 stampFor(qint64 mtime, qint64 now = QDateTime::currentMSecsSinceEpoch())
+            {
+                return mtime >= 0 && now - mtime < RacyMSecs ? qint64(NeverScanned) : mtime;
+            }
+
+        }
+
+    }
+
+}
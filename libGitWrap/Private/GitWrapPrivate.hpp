@@ -42,11 +42,12 @@ namespace Git
         class RepositoryPrivate;
 
         // Some internal helpers
-        Signature git2Signature( const git_signature* gitsig );
+        Signature git2Signature( const git_signature* gitsig, RepositoryPrivate* repo = nullptr );
         git_signature* signature2git( Result& result, const Signature& sig );
         RefSpec mkRefSpec( const git_refspec* refspec );
         QStringList slFromStrArray( git_strarray* arry );
         FileInfo mkFileInfo(const git_diff_file* df);
+        bool internSignatures();
 
         template<typename T>
         class GitPtr
@@ -392,6 +393,7 @@ namespace Git
             if ( v & GIT_STATUS_WT_MODIFIED )       s |= FileWorkingTreeModified;
             if ( v & GIT_STATUS_WT_DELETED )        s |= FileWorkingTreeDeleted;
             if ( v & GIT_STATUS_WT_TYPECHANGE )     s |= FileWorkingTreeTypeChange;
+            if ( v & GIT_STATUS_WT_RENAMED )        s |= FileWorkingTreeRenamed;
             if ( v & GIT_STATUS_IGNORED )           s |= FileIgnored;
 
             return s;
@@ -0,0 +1,286 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "libGitWrap/Private/HexCodec.hpp"
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#   define GW_HEX_AVX2 1
+#   define GW_HEX_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define GW_HEX_SSE2 1
+#endif
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        namespace HexCodec
+        {
+
+            // 40 hex digits make one SHA-1
+            enum { RawLength = 20, HexLength = 40 };
+
+            static const char sDigits[] = "0123456789abcdef";
+
+            // Value of a hex digit or -1
+            static const signed char sValues[256] = {
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+                -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+            };
+
+            /**
+             * @internal
+             * @brief       Decode 40 hex digits into 20 bytes
+             *
+             * @return      `false` if @a hex contains anything but hex digits. @a raw is undefined
+             *              in that case.
+             */
+            bool decodeIdScalar(const char* hex, unsigned char* raw)
+            {
+                int bad = 0;
+
+                for (int i = 0; i < RawLength; ++i) {
+                    int hi = sValues[(unsigned char) hex[2 * i]];
+                    int lo = sValues[(unsigned char) hex[2 * i + 1]];
+                    bad |= hi | lo;
+                    raw[i] = (unsigned char) ((unsigned(hi) << 4) | unsigned(lo));
+                }
+
+                return bad >= 0;
+            }
+
+            /**
+             * @internal
+             * @brief       Encode 20 bytes into 40 lower case hex digits
+             *
+             * No terminating zero is written.
+             */
+            void encodeIdScalar(const unsigned char* raw, char* hex)
+            {
+                for (int i = 0; i < RawLength; ++i) {
+                    hex[2 * i]      = sDigits[raw[i] >> 4];
+                    hex[2 * i + 1]  = sDigits[raw[i] & 0x0f];
+                }
+            }
+
+        #ifdef GW_HEX_SSE2
+
+            // Convert 16 ascii chars to their nibble values; sets `valid` to false for non hex in
+            // any of the lanes selected by `lanes`
+            static inline __m128i nibbles128(__m128i v, bool& valid, int lanes = 0xffff)
+            {
+                const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+                const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                                    _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+                const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                                    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+                valid &= (_mm_movemask_epi8(_mm_or_si128(digit, alpha)) & lanes) == lanes;
+
+                // '0'..'9' -> 0..9 and 'a'..'f' -> 49..54 -> 10..15
+                __m128i n = _mm_sub_epi8(lower, _mm_set1_epi8('0'));
+                return _mm_sub_epi8(n, _mm_and_si128(alpha, _mm_set1_epi8('a' - '0' - 10)));
+            }
+
+            // Combine pairs of nibbles (high nibble first) into 8 bytes in the low half
+            static inline __m128i packNibbles128(__m128i n)
+            {
+                const __m128i hi = _mm_and_si128(n, _mm_set1_epi16(0x00ff));
+                const __m128i lo = _mm_srli_epi16(n, 8);
+                const __m128i b = _mm_or_si128(_mm_slli_epi16(hi, 4), lo);
+                return _mm_packus_epi16(b, _mm_setzero_si128());
+            }
+
+            // Convert 16 nibbles to lower case hex digits
+            static inline __m128i digits128(__m128i n)
+            {
+                const __m128i alpha = _mm_cmpgt_epi8(n, _mm_set1_epi8(9));
+                n = _mm_add_epi8(n, _mm_set1_epi8('0'));
+                return _mm_add_epi8(n, _mm_and_si128(alpha, _mm_set1_epi8('a' - '0' - 10)));
+            }
+
+            // Spread 8 bytes in the low half into 16 nibbles, high nibble first
+            static inline __m128i spread128(__m128i b)
+            {
+                const __m128i mask = _mm_set1_epi8(0x0f);
+                const __m128i hi = _mm_and_si128(_mm_srli_epi16(b, 4), mask);
+                const __m128i lo = _mm_and_si128(b, mask);
+                return _mm_unpacklo_epi8(hi, lo);
+            }
+
+        #endif
+
+        #ifdef GW_HEX_AVX2
+
+            static inline __m256i nibbles256(__m256i v, bool& valid)
+            {
+                const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+                const __m256i digit = _mm256_and_si256(
+                            _mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+                const __m256i alpha = _mm256_and_si256(
+                            _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+
+                valid &= unsigned(_mm256_movemask_epi8(_mm256_or_si256(digit, alpha)))
+                        == 0xffffffffu;
+
+                __m256i n = _mm256_sub_epi8(lower, _mm256_set1_epi8('0'));
+                return _mm256_sub_epi8(n, _mm256_and_si256(alpha,
+                                                           _mm256_set1_epi8('a' - '0' - 10)));
+            }
+
+        #endif
+
+            /**
+             * @internal
+             * @brief       Decode 40 hex digits into 20 bytes
+             *
+             * Exactly 40 bytes are read from @a hex and 20 bytes are written to @a raw.
+             *
+             * @return      `false` if @a hex contains anything but hex digits. @a raw is undefined
+             *              in that case.
+             */
+            bool decodeId(const char* hex, unsigned char* raw)
+            {
+            #if defined(GW_HEX_AVX2)
+                bool valid = true;
+
+                // 32 digits -> 16 bytes; packus works per 128 bit lane, so gather qwords 0 and 2
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex));
+                __m256i n = nibbles256(v, valid);
+                __m256i hi = _mm256_and_si256(n, _mm256_set1_epi16(0x00ff));
+                __m256i lo = _mm256_srli_epi16(n, 8);
+                __m256i b = _mm256_or_si256(_mm256_slli_epi16(hi, 4), lo);
+                b = _mm256_packus_epi16(b, _mm256_setzero_si256());
+                b = _mm256_permute4x64_epi64(b, 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(raw), _mm256_castsi256_si128(b));
+
+                // 8 digits -> 4 bytes
+                __m128i t = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(hex + 32));
+                t = packNibbles128(nibbles128(t, valid, 0x00ff));
+                int last = _mm_cvtsi128_si32(t);
+                memcpy(raw + 16, &last, 4);
+
+                return valid;
+
+            #elif defined(GW_HEX_SSE2)
+                bool valid = true;
+
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 16));
+                __m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(hex + 32));
+
+                a = packNibbles128(nibbles128(a, valid));
+                b = packNibbles128(nibbles128(b, valid));
+                c = packNibbles128(nibbles128(c, valid, 0x00ff));
+
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(raw), a);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(raw + 8), b);
+                int last = _mm_cvtsi128_si32(c);
+                memcpy(raw + 16, &last, 4);
+
+                return valid;
+
+            #else
+                return decodeIdScalar(hex, raw);
+            #endif
+            }
+
+            /**
+             * @internal
+             * @brief       Encode 20 bytes into 40 lower case hex digits
+             *
+             * Exactly 40 bytes are written to @a hex; no terminating zero is written.
+             */
+            void encodeId(const unsigned char* raw, char* hex)
+            {
+            #if defined(GW_HEX_AVX2)
+                // 16 bytes -> 32 digits. Widening to 16 bit lanes keeps everything lane local.
+                __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw));
+                __m256i w = _mm256_cvtepu8_epi16(r);
+                __m256i hi = _mm256_srli_epi16(w, 4);
+                __m256i lo = _mm256_slli_epi16(_mm256_and_si256(w, _mm256_set1_epi16(0x0f)), 8);
+                __m256i n = _mm256_or_si256(hi, lo);
+                __m256i alpha = _mm256_cmpgt_epi8(n, _mm256_set1_epi8(9));
+                n = _mm256_add_epi8(n, _mm256_set1_epi8('0'));
+                n = _mm256_add_epi8(n, _mm256_and_si256(alpha, _mm256_set1_epi8('a' - '0' - 10)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(hex), n);
+
+                // 4 bytes -> 8 digits
+                int last;
+                memcpy(&last, raw + 16, 4);
+                __m128i t = digits128(spread128(_mm_cvtsi32_si128(last)));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(hex + 32), t);
+
+            #elif defined(GW_HEX_SSE2)
+                __m128i a = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw));
+                __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw + 8));
+                int last;
+                memcpy(&last, raw + 16, 4);
+                __m128i c = _mm_cvtsi32_si128(last);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(hex), digits128(spread128(a)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 16), digits128(spread128(b)));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(hex + 32), digits128(spread128(c)));
+
+            #else
+                encodeIdScalar(raw, hex);
+            #endif
+            }
+
+            /**
+             * @internal
+             * @brief       Name of the implementation that decodeId() and encodeId() use
+             */
+            const char* implementation()
+            {
+            #if defined(GW_HEX_AVX2)
+                return "AVX2";
+            #elif defined(GW_HEX_SSE2)
+                return "SSE2";
+            #else
+                return "scalar";
+            #endif
+            }
+
+        }
+
+    }
+
+}
@@ -0,0 +1,51 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Conversion of object ids from and to hex
+         *
+         * There are SSE2 and AVX2 implementations which are selected at compile time, depending
+         * on the target's instruction set (`__SSE2__` / `__AVX2__`). Everything else uses a table
+         * driven scalar implementation.
+         *
+         * Upper case hex digits are accepted when decoding; encoding always produces lower case.
+         */
+        namespace HexCodec
+        {
+
+            bool decodeId(const char* hex, unsigned char* raw);
+            void encodeId(const unsigned char* raw, char* hex);
+
+            bool decodeIdScalar(const char* hex, unsigned char* raw);
+            void encodeIdScalar(const unsigned char* raw, char* hex);
+
+            const char* implementation();
+
+        }
+
+    }
+
+}
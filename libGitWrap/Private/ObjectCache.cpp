@@ -0,0 +1,493 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libGitWrap/Repository.hpp"
+
+#include "libGitWrap/Private/ObjectCache.hpp"
+#include "libGitWrap/Private/ObjectPrivate.hpp"
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        // Totals over the caches of all repositories; see GitWrap::cacheStats()
+        static QAtomicInt               sTotalCount[otTag + 1];
+        static QAtomicInteger<qint64>   sTotalMemory;
+
+        ObjectCache::ObjectCache()
+            : mStamp(0)
+            , mMemoryUsed(0)
+            , mHits(0)
+            , mRevived(0)
+            , mMisses(0)
+            , mEvictions(0)
+        {
+            for (int i = 0; i < TypeCount; ++i) {
+                mHead[i] = mTail[i] = nullptr;
+                mCount[i] = 0;
+            }
+
+            setLimits(ObjectCacheLimits());
+        }
+
+        ObjectCache::~ObjectCache()
+        {
+            clear();
+
+            // Every ObjectPrivate holds a reference to the RepositoryPrivate that owns this cache.
+            // So, when we get here, there cannot be any wrappers left.
+            Q_ASSERT(mEntries.isEmpty());
+        }
+
+        /**
+         * @internal
+         * @brief       Map a libgit2 object type to an index into the per type arrays
+         *
+         * The indices match the values of the ObjectType enumeration.
+         */
+        int ObjectCache::typeIndex(git_otype type)
+        {
+            switch (type) {
+            case GIT_OBJ_TREE:      return otTree;
+            case GIT_OBJ_COMMIT:    return otCommit;
+            case GIT_OBJ_BLOB:      return otBlob;
+            case GIT_OBJ_TAG:       return otTag;
+            default:                Q_ASSERT(false); return otBlob;
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Estimate the memory that libgit2 uses for a parsed object
+         *
+         * This is not exact, but good enough to enforce a memory budget.
+         */
+        size_t ObjectCache::objectCost(const git_object* o)
+        {
+            git_object* obj = const_cast<git_object*>(o);
+
+            switch (git_object_type(o)) {
+            case GIT_OBJ_COMMIT: {
+                const char* msg = git_commit_message(reinterpret_cast<git_commit*>(obj));
+                return 256 + (msg ? strlen(msg) : 0);
+            }
+
+            case GIT_OBJ_TREE:
+                return 64 + 64 * git_tree_entrycount(reinterpret_cast<git_tree*>(obj));
+
+            case GIT_OBJ_BLOB:
+                return 64 + size_t(git_blob_rawsize(reinterpret_cast<git_blob*>(obj)));
+
+            case GIT_OBJ_TAG: {
+                const char* msg = git_tag_message(reinterpret_cast<git_tag*>(obj));
+                return 192 + (msg ? strlen(msg) : 0);
+            }
+
+            default:
+                return 64;
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Add a new entry without wrapper and without retained object
+         *
+         * Must be called with the mutex locked and only if there is no entry for @a id yet.
+         */
+        ObjectCache::Entry* ObjectCache::insert(const ObjectId& id, git_otype type)
+        {
+            Entry* e = new Entry;
+            e->id = id;
+            e->wrapper = nullptr;
+            e->object = nullptr;
+            e->cost = 0;
+            e->stamp = 0;
+            e->type = typeIndex(type);
+            e->prev = e->next = nullptr;
+            mEntries.insert(id, e);
+            return e;
+        }
+
+        void ObjectCache::link(Entry* e)
+        {
+            e->prev = nullptr;
+            e->next = mHead[e->type];
+
+            if (e->next) {
+                e->next->prev = e;
+            }
+            else {
+                mTail[e->type] = e;
+            }
+
+            mHead[e->type] = e;
+        }
+
+        void ObjectCache::unlink(Entry* e)
+        {
+            if (e->prev) {
+                e->prev->next = e->next;
+            }
+            else {
+                mHead[e->type] = e->next;
+            }
+
+            if (e->next) {
+                e->next->prev = e->prev;
+            }
+            else {
+                mTail[e->type] = e->prev;
+            }
+
+            e->prev = e->next = nullptr;
+        }
+
+        /**
+         * @internal
+         * @brief       Take ownership of a git_object and put it at the front of the LRU list
+         *
+         * If the per type limit for @a o's type is zero, the object is not retained at all and
+         * will be freed along with the others in @a toFree.
+         */
+        void ObjectCache::retain(Entry* e, git_object* o, QVector<git_object*>& toFree)
+        {
+            Q_ASSERT(!e->object);
+
+            if (!mMaxCount[e->type]) {
+                toFree.append(o);
+                return;
+            }
+
+            e->object = o;
+            e->cost = objectCost(o);
+            e->stamp = ++mStamp;
+            link(e);
+
+            mCount[e->type]++;
+            mMemoryUsed += e->cost;
+
+            sTotalCount[e->type].ref();
+            sTotalMemory.fetchAndAddRelaxed(qint64(e->cost));
+        }
+
+        /**
+         * @internal
+         * @brief       Drop the retained git_object of an entry
+         *
+         * If no wrapper is alive for the entry, the entry itself is removed, too. The git_object is
+         * not freed but appended to @a toFree, so the caller can free it outside of the lock.
+         */
+        void ObjectCache::release(Entry* e, QVector<git_object*>& toFree)
+        {
+            if (e->object) {
+                unlink(e);
+
+                toFree.append(e->object);
+                e->object = nullptr;
+
+                mCount[e->type]--;
+                mMemoryUsed -= e->cost;
+
+                sTotalCount[e->type].deref();
+                sTotalMemory.fetchAndAddRelaxed(-qint64(e->cost));
+                e->cost = 0;
+            }
+
+            if (!e->wrapper) {
+                mEntries.remove(e->id);
+                delete e;
+            }
+        }
+
+        void ObjectCache::trim(QVector<git_object*>& toFree)
+        {
+            for (int i = 0; i < TypeCount; ++i) {
+                while (mCount[i] > mMaxCount[i]) {
+                    release(mTail[i], toFree);
+                    mEvictions++;
+                }
+            }
+
+            while (mMemoryUsed > mMaxMemory) {
+                Entry* victim = nullptr;
+
+                for (int i = 0; i < TypeCount; ++i) {
+                    if (mTail[i] && (!victim || mTail[i]->stamp < victim->stamp)) {
+                        victim = mTail[i];
+                    }
+                }
+
+                Q_ASSERT(victim);
+                release(victim, toFree);
+                mEvictions++;
+            }
+        }
+
+        /**
+         * @internal
+         * @brief           Lookup an object through the cache
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       repo    The repository that owns this cache
+         *
+         * @param[in]       id      The id of the object to look up
+         *
+         * @param[in]       ot      The expected type of the object or `otAny`
+         *
+         * @return          A pointer to the (probably shared) wrapper or a `nullptr` GitPtr if the
+         *                  object cannot be found or is not of type @a ot.
+         */
+        GitPtr<ObjectPrivate> ObjectCache::lookup(Result& result, RepositoryPrivate* repo,
+                                                  const ObjectId& id, ObjectType ot)
+        {
+            GW_CHECK_RESULT( result, GitPtr<ObjectPrivate>() );
+
+            QVector<git_object*> toFree;
+            git_object* obj = nullptr;
+
+            QMutexLocker lock(&mMutex);
+
+            Entry* e = mEntries.value(id, nullptr);
+
+            if (e) {
+                if (e->object) {
+                    unlink(e);
+                    e->stamp = ++mStamp;
+                    link(e);
+                }
+
+                // The wrapper might be in the middle of its destruction; in that case its refcount
+                // is already zero and tryAddRef() fails.
+                ObjectPrivate* op = e->wrapper;
+                if (op && op->tryAddRef()) {
+                    mHits++;
+                    lock.unlock();
+
+                    GitPtr<ObjectPrivate> ptr(op);
+                    op->delRef();
+
+                    if (ot != otAny && ptr->objectType() != ot) {
+                        result.setError("The requested type does not match the type in the ODB",
+                                        GIT_ENOTFOUND);
+                        return GitPtr<ObjectPrivate>();
+                    }
+
+                    return ptr;
+                }
+
+                if (e->object) {
+                    git_object_dup(&obj, e->object);
+                    mRevived++;
+                }
+            }
+
+            if (!obj) {
+                mMisses++;
+            }
+
+            lock.unlock();
+
+            if (obj) {
+                if (ot != otAny && git_object_type(obj) != objectType2git(ot)) {
+                    git_object_free(obj);
+                    result.setError("The requested type does not match the type in the ODB",
+                                    GIT_ENOTFOUND);
+                    return GitPtr<ObjectPrivate>();
+                }
+            }
+            else {
+                result = git_object_lookup(&obj, repo->mRepo, ObjectId2git(id), objectType2git(ot));
+                GW_CHECK_RESULT( result, GitPtr<ObjectPrivate>() );
+            }
+
+            ObjectPrivate* op = ObjectPrivate::create(repo, obj);
+            if (!op) {
+                git_object_free(obj);
+                result.setError("Unsupported object type.", GIT_ERROR);
+                return GitPtr<ObjectPrivate>();
+            }
+
+            GitPtr<ObjectPrivate> ptr(op);
+            op->mCached = true;
+
+            lock.relock();
+
+            e = mEntries.value(id, nullptr);
+            if (!e) {
+                e = insert(id, git_object_type(obj));
+            }
+
+            e->wrapper = op;
+
+            if (!e->object) {
+                git_object* retained = nullptr;
+                git_object_dup(&retained, obj);
+                retain(e, retained, toFree);
+                trim(toFree);
+            }
+
+            lock.unlock();
+
+            foreach (git_object* o, toFree) {
+                git_object_free(o);
+            }
+
+            return ptr;
+        }
+
+        /**
+         * @internal
+         * @brief       Remove a wrapper from the weak index
+         *
+         * This is called from the destructor of ObjectPrivate for every wrapper that was created
+         * through lookup().
+         */
+        void ObjectCache::forget(ObjectPrivate* op)
+        {
+            QVector<git_object*> toFree;
+            ObjectId id = BasePrivate::oid2sha(git_object_id(op->mObj));
+
+            QMutexLocker lock(&mMutex);
+
+            Entry* e = mEntries.value(id, nullptr);
+            if (e && e->wrapper == op) {
+                e->wrapper = nullptr;
+                if (!e->object) {
+                    release(e, toFree);
+                }
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Drop all retained objects
+         *
+         * Wrappers that are still alive will remain in the weak index.
+         */
+        void ObjectCache::clear()
+        {
+            QVector<git_object*> toFree;
+
+            QMutexLocker lock(&mMutex);
+
+            // release() removes entries from mEntries
+            foreach (Entry* e, mEntries.values()) {
+                release(e, toFree);
+            }
+
+            lock.unlock();
+
+            foreach (git_object* o, toFree) {
+                git_object_free(o);
+            }
+        }
+
+        void ObjectCache::setLimits(const ObjectCacheLimits& limits)
+        {
+            QVector<git_object*> toFree;
+
+            QMutexLocker lock(&mMutex);
+
+            mMaxMemory          = limits.maxMemory;
+            mMaxPrefetch        = limits.maxPrefetchMemory;
+            mMaxCount[otTree]   = qMax(0, limits.maxTrees);
+            mMaxCount[otCommit] = qMax(0, limits.maxCommits);
+            mMaxCount[otBlob]   = qMax(0, limits.maxBlobs);
+            mMaxCount[otTag]    = qMax(0, limits.maxTags);
+
+            trim(toFree);
+
+            lock.unlock();
+
+            foreach (git_object* o, toFree) {
+                git_object_free(o);
+            }
+        }
+
+        ObjectCacheLimits ObjectCache::limits() const
+        {
+            QMutexLocker lock(&mMutex);
+
+            ObjectCacheLimits l;
+            l.maxMemory         = mMaxMemory;
+            l.maxPrefetchMemory = mMaxPrefetch;
+            l.maxTrees          = mMaxCount[otTree];
+            l.maxCommits        = mMaxCount[otCommit];
+            l.maxBlobs          = mMaxCount[otBlob];
+            l.maxTags           = mMaxCount[otTag];
+            return l;
+        }
+
+        ObjectCacheStats ObjectCache::stats() const
+        {
+            QMutexLocker lock(&mMutex);
+
+            ObjectCacheStats s;
+            s.hits          = mHits;
+            s.revived       = mRevived;
+            s.misses        = mMisses;
+            s.evictions     = mEvictions;
+            s.memoryUsed    = mMemoryUsed;
+            s.wrappers      = 0;
+            s.trees         = mCount[otTree];
+            s.commits       = mCount[otCommit];
+            s.blobs         = mCount[otBlob];
+            s.tags          = mCount[otTag];
+
+            for (ObjectIdMap<Entry*>::const_iterator it = mEntries.begin();
+                 it != mEntries.end(); ++it) {
+                if (it.value()->wrapper) {
+                    s.wrappers++;
+                }
+            }
+
+            return s;
+        }
+
+        /**
+         * @internal
+         * @brief       Sum up the retained objects of the caches of all repositories
+         *
+         * Only the memory and the per type counts of the result are filled in.
+         */
+        ObjectCacheStats ObjectCache::totals()
+        {
+            ObjectCacheStats s;
+            s.memoryUsed    = quint64(qMax(Q_INT64_C(0), sTotalMemory.load()));
+            s.trees         = sTotalCount[otTree].load();
+            s.commits       = sTotalCount[otCommit].load();
+            s.blobs         = sTotalCount[otBlob].load();
+            s.tags          = sTotalCount[otTag].load();
+            return s;
+        }
+
+        /**
+         * @internal
+         * @brief       Get the number of bytes that one prefetch may read ahead
+         */
+        quint64 ObjectCache::prefetchBudget() const
+        {
+            QMutexLocker lock(&mMutex);
+            return mMaxPrefetch;
+        }
+
+    }
+
+}
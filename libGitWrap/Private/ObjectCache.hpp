@@ -0,0 +1,124 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QAtomicInteger>
+#include <QMutex>
+
+#include "libGitWrap/ObjectIdSet.hpp"
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    struct ObjectCacheLimits;
+    struct ObjectCacheStats;
+
+    namespace Internal
+    {
+
+        class ObjectPrivate;
+        class RepositoryPrivate;
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Per repository cache of object wrappers
+         *
+         * The cache has two layers:
+         *
+         * - A weak index of all ObjectPrivate instances that were handed out by Repository::lookup
+         *   and are still alive. A lookup of such an object simply returns the existing shared
+         *   private - there is neither a call into libgit2 nor an allocation.
+         *
+         * - A LRU list of `git_object`s that are retained by the cache itself. When the last
+         *   wrapper of an object goes away, the libgit2 object stays parsed in memory until it is
+         *   evicted due to the memory budget or the per type limits.
+         *
+         * The retained layer deliberately holds `git_object`s and not ObjectPrivates: An
+         * ObjectPrivate owns a reference to its repository, which would keep the repository alive
+         * forever.
+         */
+        class ObjectCache
+        {
+        private:
+            struct Entry
+            {
+                ObjectId        id;
+                ObjectPrivate*  wrapper;    // weak
+                git_object*     object;     // strong, owned by the cache; nullptr if not retained
+                size_t          cost;
+                quint64         stamp;
+                int             type;
+                Entry*          prev;
+                Entry*          next;
+            };
+
+            enum { TypeCount = 4 };
+
+        public:
+            ObjectCache();
+            ~ObjectCache();
+
+        public:
+            GitPtr<ObjectPrivate> lookup(Result& result, RepositoryPrivate* repo,
+                                         const ObjectId& id, ObjectType ot);
+            void forget(ObjectPrivate* op);
+            void clear();
+
+            void setLimits(const ObjectCacheLimits& limits);
+            ObjectCacheLimits limits() const;
+            ObjectCacheStats stats() const;
+            quint64 prefetchBudget() const;
+
+            static ObjectCacheStats totals();
+
+        private:
+            static size_t objectCost(const git_object* o);
+            static int typeIndex(git_otype type);
+
+            Entry* insert(const ObjectId& id, git_otype type);
+            void link(Entry* e);
+            void unlink(Entry* e);
+            void release(Entry* e, QVector<git_object*>& toFree);
+            void retain(Entry* e, git_object* o, QVector<git_object*>& toFree);
+            void trim(QVector<git_object*>& toFree);
+
+        private:
+            mutable QMutex          mMutex;
+            ObjectIdMap<Entry*>     mEntries;
+
+            Entry*                  mHead[TypeCount];
+            Entry*                  mTail[TypeCount];
+            int                     mCount[TypeCount];
+            int                     mMaxCount[TypeCount];
+
+            quint64                 mStamp;
+            quint64                 mMemoryUsed;
+            quint64                 mMaxMemory;
+            quint64                 mMaxPrefetch;
+
+            quint64                 mHits;
+            quint64                 mRevived;
+            quint64                 mMisses;
+            quint64                 mEvictions;
+        };
+
+    }
+
+}
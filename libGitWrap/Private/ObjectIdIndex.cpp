@@ -0,0 +1,503 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include <QDir>
+#include <QFile>
+
+#include "libGitWrap/Private/FileStamp.hpp"
+#include "libGitWrap/Private/HexCodec.hpp"
+#include "libGitWrap/Private/ObjectIdIndex.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        // Same as git's limit for nested alternates
+        static const int sMaxAlternateDepth = 5;
+
+        static inline bool idLess(const ObjectId& a, const ObjectId& b)
+        {
+            return memcmp(a.raw(), b.raw(), ObjectId::SHA1_Length) < 0;
+        }
+
+        static inline bool firstByteLess(const ObjectId& id, int byte)
+        {
+            return id.raw()[0] < byte;
+        }
+
+        // Range of the ids in a sorted list that start with a given byte
+        static void bucketRange(const ObjectIdList& ids, int byte, int& begin, int& end)
+        {
+            ObjectIdList::const_iterator first = ids.constBegin();
+            ObjectIdList::const_iterator last = ids.constEnd();
+
+            begin = int(std::lower_bound(first, last, byte, firstByteLess) - first);
+            end = int(std::lower_bound(first + begin, last, byte + 1, firstByteLess) - first);
+        }
+
+        static inline quint32 be32(const uchar* p)
+        {
+            return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3];
+        }
+
+        // Number of leading hex digits that a and b have in common
+        static int commonHexDigits(const ObjectId& a, const ObjectId& b)
+        {
+            const uchar* pa = a.raw();
+            const uchar* pb = b.raw();
+
+            for (int i = 0; i < ObjectId::SHA1_Length; ++i) {
+                if (pa[i] != pb[i]) {
+                    return 2 * i + ((pa[i] & 0xf0) == (pb[i] & 0xf0) ? 1 : 0);
+                }
+            }
+
+            return ObjectId::SHA1_LengthHex;
+        }
+
+        ObjectIdIndex::ObjectDir::ObjectDir()
+            : packDirStamp(FileStamp::NeverScanned)
+        {
+            for (int i = 0; i < 256; ++i) {
+                looseStamps[i] = FileStamp::NeverScanned;
+            }
+        }
+
+        ObjectIdIndex::ObjectIdIndex()
+        {
+        }
+
+        ObjectIdIndex::~ObjectIdIndex()
+        {
+            qDeleteAll(mDirs);
+        }
+
+        /**
+         * @internal
+         * @brief       Read all object ids from a pack index file
+         *
+         * Both versions of the pack index format are supported. The ids in a pack index are
+         * sorted already.
+         *
+         * @return      `false` if the file cannot be read or is not a pack index.
+         */
+        bool ObjectIdIndex::readPackIndex(const QString& fileName, ObjectIdList& ids)
+        {
+            QFile f(fileName);
+            if (!f.open(QIODevice::ReadOnly)) {
+                return false;
+            }
+
+            qint64 size = f.size();
+            const uchar* data = f.map(0, size);
+            if (!data) {
+                return false;
+            }
+
+            static const uchar v2Magic[4] = { 0xff, 't', 'O', 'c' };
+
+            const uchar* fanout;
+            const uchar* names;
+            int step;
+
+            if (size >= 8 && !memcmp(data, v2Magic, 4)) {
+                if (be32(data + 4) != 2) {
+                    return false;
+                }
+                fanout = data + 8;
+                names = fanout + 256 * 4;
+                step = ObjectId::SHA1_Length;
+            }
+            else {
+                fanout = data;
+                names = fanout + 256 * 4 + 4;
+                step = ObjectId::SHA1_Length + 4;
+            }
+
+            if (fanout + 256 * 4 > data + size) {
+                return false;
+            }
+
+            quint32 count = be32(fanout + 255 * 4);
+            if (names + qint64(count) * step > data + size) {
+                return false;
+            }
+
+            ids.resize(int(count));
+            for (quint32 i = 0; i < count; ++i) {
+                memcpy(ids[i].rawWritable(), names + i * step, ObjectId::SHA1_Length);
+            }
+
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Rescan a pack directory
+         *
+         * @param[in,out]   dir     The object directory.
+         *
+         * @param[out]      added   The ids of every new pack are appended to this.
+         *
+         * @return          `true` if a pack went away.
+         */
+        bool ObjectIdIndex::refreshPacks(ObjectDir& dir, QList<ObjectIdList>& added)
+        {
+            QString packPath = dir.path + QStringLiteral("/pack");
+            qint64 mtime = FileStamp::modificationTime(packPath);
+
+            if (mtime == dir.packDirStamp) {
+                return false;
+            }
+
+            dir.packDirStamp = FileStamp::stampFor(mtime);
+
+            bool removed = false;
+
+            for (QHash<QString, Pack>::iterator it = dir.packs.begin(); it != dir.packs.end(); ++it) {
+                it.value().seen = false;
+            }
+
+            QStringList indices = QDir(packPath).entryList(QStringList() << QStringLiteral("*.idx"),
+                                                           QDir::Files);
+
+            foreach (const QString& name, indices) {
+                QHash<QString, Pack>::iterator it = dir.packs.find(name);
+
+                if (it != dir.packs.end()) {
+                    it.value().seen = true;
+                    continue;
+                }
+
+                Pack pack;
+                if (readPackIndex(packPath + QChar(L'/') + name, pack.ids)) {
+                    pack.seen = true;
+                    dir.packs.insert(name, pack);
+                    added.append(pack.ids);
+                }
+            }
+
+            for (QHash<QString, Pack>::iterator it = dir.packs.begin(); it != dir.packs.end(); ) {
+                if (!it.value().seen) {
+                    it = dir.packs.erase(it);
+                    removed = true;
+                }
+                else {
+                    ++it;
+                }
+            }
+
+            return removed;
+        }
+
+        bool ObjectIdIndex::refreshLoose(ObjectDir& dir, int fanout)
+        {
+            char hex[ObjectId::SHA1_LengthHex];
+            hex[0] = "0123456789abcdef"[fanout >> 4];
+            hex[1] = "0123456789abcdef"[fanout & 0x0f];
+
+            QString subPath = dir.path + QChar(L'/') + QLatin1String(hex, 2);
+            qint64 mtime = FileStamp::modificationTime(subPath);
+
+            if (mtime == dir.looseStamps[fanout]) {
+                return false;
+            }
+
+            dir.looseStamps[fanout] = FileStamp::stampFor(mtime);
+
+            ObjectIdList ids;
+
+            if (mtime >= 0) {
+                QStringList names = QDir(subPath).entryList(QDir::Files);
+                ids.reserve(names.count());
+
+                foreach (const QString& name, names) {
+                    if (name.length() != ObjectId::SHA1_LengthHex - 2) {
+                        continue;
+                    }
+
+                    QByteArray rest = name.toLatin1();
+                    memcpy(hex + 2, rest.constData(), ObjectId::SHA1_LengthHex - 2);
+
+                    ObjectId id;
+                    if (HexCodec::decodeId(hex, id.rawWritable())) {
+                        ids.append(id);
+                    }
+                }
+
+                std::sort(ids.begin(), ids.end(), idLess);
+            }
+
+            if (ids == dir.loose[fanout]) {
+                return false;
+            }
+
+            dir.loose[fanout] = ids;
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Find the object directory and all of its alternates
+         */
+        QStringList ObjectIdIndex::objectDirs(const QString& objectsPath) const
+        {
+            QStringList dirs;
+            QStringList todo;
+            QList<int> depth;
+
+            todo << QDir::cleanPath(objectsPath);
+            depth << 0;
+
+            while (!todo.isEmpty()) {
+                QString path = todo.takeFirst();
+                int level = depth.takeFirst();
+
+                if (dirs.contains(path)) {
+                    continue;
+                }
+
+                dirs << path;
+
+                if (level >= sMaxAlternateDepth) {
+                    continue;
+                }
+
+                QFile f(path + QStringLiteral("/info/alternates"));
+                if (!f.open(QIODevice::ReadOnly)) {
+                    continue;
+                }
+
+                foreach (const QByteArray& line, f.readAll().split('\n')) {
+                    QString alt = QString::fromUtf8(line.trimmed());
+
+                    if (alt.isEmpty() || alt.startsWith(QChar(L'#'))) {
+                        continue;
+                    }
+
+                    todo << QDir::cleanPath(QDir(path).absoluteFilePath(alt));
+                    depth << level + 1;
+                }
+            }
+
+            return dirs;
+        }
+
+        /**
+         * @internal
+         * @brief       Merge a sorted list of ids into the index
+         */
+        void ObjectIdIndex::mergeIds(const ObjectIdList& ids)
+        {
+            ObjectIdList all(mAll.count() + ids.count());
+
+            ObjectIdList::iterator end = std::merge(mAll.constBegin(), mAll.constEnd(),
+                                                    ids.constBegin(), ids.constEnd(),
+                                                    all.begin(), idLess);
+
+            // Objects may be in more than one pack or loose and packed at the same time.
+            end = std::unique(all.begin(), end);
+            all.erase(end, all.end());
+
+            mAll = all;
+        }
+
+        /**
+         * @internal
+         * @brief       Rebuild the ranges of ids that start with some bytes
+         *
+         * The ids of a range are collected from all packs and loose object directories and only
+         * that range is sorted. All other ranges are copied as they are.
+         *
+         * @param[in]   dirty   Has a bit set for every first byte whose range shall be rebuilt.
+         */
+        void ObjectIdIndex::rebuildBuckets(const QBitArray& dirty)
+        {
+            ObjectIdList all;
+            all.reserve(mAll.count());
+
+            for (int byte = 0; byte < 256; ++byte) {
+                int begin, end;
+
+                if (!dirty.testBit(byte)) {
+                    bucketRange(mAll, byte, begin, end);
+                    for (int i = begin; i < end; ++i) {
+                        all.append(mAll.at(i));
+                    }
+                    continue;
+                }
+
+                ObjectIdList ids;
+
+                foreach (const ObjectDir* dir, mDirs) {
+                    foreach (const Pack& pack, dir->packs) {
+                        bucketRange(pack.ids, byte, begin, end);
+                        for (int i = begin; i < end; ++i) {
+                            ids.append(pack.ids.at(i));
+                        }
+                    }
+
+                    ids += dir->loose[byte];
+                }
+
+                std::sort(ids.begin(), ids.end(), idLess);
+                ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+                all += ids;
+            }
+
+            mAll = all;
+        }
+
+        /**
+         * @internal
+         * @brief           Bring the index up to date
+         *
+         * Must be called with mutex() locked.
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       repo    The repository whose object directory shall be indexed.
+         */
+        void ObjectIdIndex::refresh(Result& result, git_repository* repo)
+        {
+            GW_CHECK_RESULT(result, void());
+
+            QString objectsPath = GW_StringToQt(git_repository_path(repo))
+                    + QStringLiteral("objects");
+            QStringList paths = objectDirs(objectsPath);
+            QList<ObjectIdList> added;
+            QBitArray dirty(256);
+            bool removed = false;
+
+            for (int i = mDirs.count() - 1; i >= 0; --i) {
+                if (!paths.contains(mDirs.at(i)->path)) {
+                    delete mDirs.takeAt(i);
+                    removed = true;
+                }
+            }
+
+            foreach (const QString& path, paths) {
+                ObjectDir* dir = nullptr;
+
+                foreach (ObjectDir* d, mDirs) {
+                    if (d->path == path) {
+                        dir = d;
+                        break;
+                    }
+                }
+
+                if (!dir) {
+                    dir = new ObjectDir;
+                    dir->path = path;
+                    mDirs.append(dir);
+                }
+
+                removed |= refreshPacks(*dir, added);
+
+                for (int i = 0; i < 256; ++i) {
+                    if (refreshLoose(*dir, i)) {
+                        dirty.setBit(i);
+                    }
+                }
+            }
+
+            if (removed) {
+                // We don't know which ids went with the pack; rebuild everything.
+                dirty.fill(true);
+            }
+            else {
+                foreach (const ObjectIdList& ids, added) {
+                    mergeIds(ids);
+                }
+            }
+
+            if (dirty.count(true)) {
+                rebuildBuckets(dirty);
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Find the objects whose id starts with a given prefix
+         *
+         * Must be called with mutex() locked.
+         *
+         * @param[in]   prefix      The prefix, padded with zeros.
+         *
+         * @param[in]   hexLength   Number of significant hex digits in @a prefix.
+         *
+         * @param[out]  match       The first matching id.
+         *
+         * @return      The number of matches, but at most 2.
+         */
+        int ObjectIdIndex::findPrefix(const ObjectId& prefix, int hexLength, ObjectId& match) const
+        {
+            ObjectIdList::const_iterator it = std::lower_bound(mAll.constBegin(), mAll.constEnd(),
+                                                               prefix, idLess);
+            int found = 0;
+
+            for (; found < 2 && it != mAll.constEnd(); ++it, ++found) {
+                if (commonHexDigits(*it, prefix) < hexLength) {
+                    break;
+                }
+
+                if (!found) {
+                    match = *it;
+                }
+            }
+
+            return found;
+        }
+
+        /**
+         * @internal
+         * @brief       Find the number of hex digits that are needed to identify an id
+         *
+         * Must be called with mutex() locked.
+         *
+         * @param[in]   id      The id. It does not need to be in the index; in that case, the
+         *                      result is the length that would not match any indexed object.
+         *
+         * @return      The length of the shortest unique abbreviation of @a id.
+         */
+        int ObjectIdIndex::uniqueLength(const ObjectId& id) const
+        {
+            ObjectIdList::const_iterator it = std::lower_bound(mAll.constBegin(), mAll.constEnd(),
+                                                               id, idLess);
+            int common = 0;
+
+            if (it != mAll.constBegin()) {
+                common = commonHexDigits(*(it - 1), id);
+            }
+
+            if (it != mAll.constEnd() && *it == id) {
+                ++it;
+            }
+
+            if (it != mAll.constEnd()) {
+                common = qMax(common, commonHexDigits(*it, id));
+            }
+
+            return qMin(common + 1, int(ObjectId::SHA1_LengthHex));
+        }
+
+    }
+
+}
@@ -0,0 +1,104 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QBitArray>
+#include <QMutex>
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Sorted in memory index of all object ids of a repository
+         *
+         * The index is built from the pack index files and the loose object directories of the
+         * repository's object directory and of its alternates. It is used to resolve abbreviated
+         * ids and to find the shortest unique abbreviation of ids, without probing the ODB for
+         * every single id.
+         *
+         * refresh() is incremental: Pack indices are read only when they appear and loose object
+         * directories are only rescanned if their modification time has changed. Directories that
+         * were modified very recently are rescanned on the next refresh, too; a change within the
+         * granularity of the file system's time stamps would be missed otherwise.
+         *
+         * The sorted list is not sorted from scratch after a change, either: The ids of a new
+         * pack are merged into it, and a changed loose object directory only rebuilds the range
+         * of ids that start with that directory's byte. Only if a pack or an alternate goes away
+         * are all 256 ranges rebuilt, each from the sorted runs of its sources.
+         */
+        class ObjectIdIndex
+        {
+        private:
+            struct Pack
+            {
+                ObjectIdList    ids;
+                bool            seen;
+            };
+
+            struct ObjectDir
+            {
+                ObjectDir();
+
+                QString                 path;
+                qint64                  packDirStamp;
+                QHash<QString, Pack>    packs;
+                qint64                  looseStamps[256];
+                ObjectIdList            loose[256];
+            };
+
+        public:
+            ObjectIdIndex();
+            ~ObjectIdIndex();
+
+        public:
+            void refresh(Result& result, git_repository* repo);
+
+            int findPrefix(const ObjectId& prefix, int hexLength, ObjectId& match) const;
+            int uniqueLength(const ObjectId& id) const;
+
+            QMutex& mutex();
+
+        private:
+            bool refreshPacks(ObjectDir& dir, QList<ObjectIdList>& added);
+            bool refreshLoose(ObjectDir& dir, int fanout);
+            QStringList objectDirs(const QString& objectsPath) const;
+            void mergeIds(const ObjectIdList& ids);
+            void rebuildBuckets(const QBitArray& dirty);
+
+            static bool readPackIndex(const QString& fileName, ObjectIdList& ids);
+
+        private:
+            mutable QMutex      mMutex;
+            QList<ObjectDir*>   mDirs;
+            ObjectIdList        mAll;
+        };
+
+        inline QMutex& ObjectIdIndex::mutex()
+        {
+            return mMutex;
+        }
+
+    }
+
+}
@@ -0,0 +1,216 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringBuilder>
+
+#include "libGitWrap/Private/ObjectLocator.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        enum
+        {
+            // Like libgit2, don't follow alternates of alternates of alternates...
+            MaxAlternatesDepth  = 5,
+
+            FanoutSize          = 256 * 4,
+            IndexV2Header       = 8
+        };
+
+        static inline quint32 be32(const uchar* p)
+        {
+            return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | p[3];
+        }
+
+        ObjectLocator::ObjectLocator(git_repository* repo)
+        {
+            QString objects = QString::fromLocal8Bit(qgetenv("GIT_OBJECT_DIRECTORY"));
+            if (objects.isEmpty()) {
+                objects = GW_StringToQt(git_repository_path(repo)) % QStringLiteral("objects");
+            }
+
+            addDirectory(objects, 0);
+        }
+
+        void ObjectLocator::addDirectory(const QString& dir, int depth)
+        {
+            const QString path = QDir::cleanPath(dir);
+            if (mDirs.contains(path) || !QFileInfo(path).isDir()) {
+                return;
+            }
+
+            mDirs.append(path);
+
+            if (depth >= MaxAlternatesDepth) {
+                return;
+            }
+
+            QFile alternates(path % QStringLiteral("/info/alternates"));
+            if (!alternates.open(QIODevice::ReadOnly)) {
+                return;
+            }
+
+            foreach (const QByteArray& line, alternates.readAll().split('\n')) {
+                const QString alternate = QString::fromLocal8Bit(line.trimmed());
+                if (alternate.isEmpty() || alternate.startsWith(QLatin1Char('#'))) {
+                    continue;
+                }
+
+                // Relative paths are relative to the object directory that lists them
+                addDirectory(QDir(path).absoluteFilePath(alternate), depth + 1);
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Find the file that holds an object
+         *
+         * Packs are searched before loose objects, as libgit2 does.
+         *
+         * @return      For a loose object, the name of its file. For a packed one, the name of the
+         *              pack file and the offset of the object's entry in it.
+         */
+        ObjectLocator::Location ObjectLocator::find(const ObjectId& id) const
+        {
+            Location loc;
+            const QString hex = id.toString();
+
+            foreach (const QString& dir, mDirs) {
+                QDir packDir(dir % QStringLiteral("/pack"));
+                QStringList indexes = packDir.entryList(QStringList() << QStringLiteral("*.idx"),
+                                                        QDir::Files, QDir::Name);
+
+                foreach (const QString& idx, indexes) {
+                    const QString idxFile = packDir.filePath(idx);
+                    const qint64 offset = findInPackIndex(idxFile, id);
+                    if (offset < 0) {
+                        continue;
+                    }
+
+                    loc.fileName = idxFile.left(idxFile.length() - 4) % QStringLiteral(".pack");
+                    if (QFileInfo(loc.fileName).isFile()) {
+                        loc.kind = Packed;
+                        loc.offset = offset;
+                        return loc;
+                    }
+                }
+            }
+
+            foreach (const QString& dir, mDirs) {
+                const QString fileName = dir % QLatin1Char('/') % hex.left(2) %
+                                         QLatin1Char('/') % hex.mid(2);
+                if (QFileInfo(fileName).isFile()) {
+                    loc.kind = Loose;
+                    loc.fileName = fileName;
+                    return loc;
+                }
+            }
+
+            return Location();
+        }
+
+        /**
+         * @internal
+         * @brief       Look an object up in a pack index
+         *
+         * Both versions of the index format are understood. The index is mapped into memory, not
+         * read.
+         *
+         * @return      The offset of the object in the pack or `-1` if it's not in this pack or
+         *              the index cannot be read.
+         */
+        qint64 ObjectLocator::findInPackIndex(const QString& idxFile, const ObjectId& id)
+        {
+            QFile file(idxFile);
+            if (!file.open(QIODevice::ReadOnly)) {
+                return -1;
+            }
+
+            const qint64 size = file.size();
+            const uchar* data = file.map(0, size);
+            if (!data) {
+                return -1;
+            }
+
+            const bool v2 = size >= IndexV2Header && std::memcmp(data, "\377tOc", 4) == 0;
+            if (v2 && be32(data + 4) != 2) {
+                return -1;
+            }
+
+            const uchar* fanout = data + (v2 ? IndexV2Header : 0);
+            if (fanout + FanoutSize > data + size) {
+                return -1;
+            }
+
+            const uchar* raw = id.raw();
+            const quint32 count = be32(fanout + 255 * 4);
+            quint32 lo = raw[0] ? be32(fanout + (raw[0] - 1) * 4) : 0;
+            quint32 hi = be32(fanout + raw[0] * 4);
+
+            // v1: entries of a 4 byte offset and the id. v2: ids, crcs, offsets, large offsets.
+            const uchar* table = fanout + FanoutSize;
+            const int stride = v2 ? ObjectId::SHA1_Length : ObjectId::SHA1_Length + 4;
+            const uchar* ids = v2 ? table : table + 4;
+            const uchar* offsets = table + qint64(count) * (ObjectId::SHA1_Length + 4);
+            const uchar* largeOffsets = offsets + qint64(count) * 4;
+
+            if (hi > count || lo > hi ||
+                    (v2 ? largeOffsets : offsets) > data + size) {
+                return -1;
+            }
+
+            while (lo < hi) {
+                const quint32 mid = lo + (hi - lo) / 2;
+                const int cmp = std::memcmp(ids + qint64(mid) * stride, raw,
+                                            ObjectId::SHA1_Length);
+                if (cmp < 0) {
+                    lo = mid + 1;
+                }
+                else if (cmp > 0) {
+                    hi = mid;
+                }
+                else if (!v2) {
+                    return be32(table + qint64(mid) * stride);
+                }
+                else {
+                    const quint32 offset = be32(offsets + qint64(mid) * 4);
+                    if (!(offset & 0x80000000u)) {
+                        return offset;
+                    }
+
+                    const uchar* large = largeOffsets + qint64(offset & 0x7fffffffu) * 8;
+                    if (large + 8 > data + size) {
+                        return -1;
+                    }
+
+                    return qint64((quint64(be32(large)) << 32) | be32(large + 4));
+                }
+            }
+
+            return -1;
+        }
+
+    }
+
+}
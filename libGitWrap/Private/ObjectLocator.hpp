@@ -0,0 +1,85 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QStringList>
+
+#include "libGitWrap/ObjectId.hpp"
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Find the file that an object is stored in
+         *
+         * The object directories are the ones that libgit2's default ODB backends read from: the
+         * repository's `objects` directory (or `GIT_OBJECT_DIRECTORY`, if it is set) and all
+         * directories listed in `objects/info/alternates`, recursively.
+         *
+         * An object that an ODB backend of its own serves is not found here. Callers have to ask
+         * the ODB first whether the object exists at all and fall back to the ODB if it isn't
+         * found in a file.
+         */
+        class ObjectLocator
+        {
+        public:
+            enum Kind
+            {
+                NotFound,
+                Loose,
+                Packed
+            };
+
+            struct Location
+            {
+                Location() : kind(NotFound), offset(0) {}
+
+                Kind            kind;
+                QString         fileName;
+                qint64          offset;
+            };
+
+        public:
+            ObjectLocator(git_repository* repo);
+
+        public:
+            QStringList directories() const;
+            Location find(const ObjectId& id) const;
+
+        private:
+            void addDirectory(const QString& dir, int depth);
+            static qint64 findInPackIndex(const QString& idxFile, const ObjectId& id);
+
+        private:
+            QStringList     mDirs;
+        };
+
+        inline QStringList ObjectLocator::directories() const
+        {
+            return mDirs;
+        }
+
+    }
+
+}
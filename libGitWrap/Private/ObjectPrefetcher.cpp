@@ -0,0 +1,501 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+
+#include "git2/sys/odb_backend.h"
+
+#include "libGitWrap/Private/ObjectPrefetcher.hpp"
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
+#include "libGitWrap/Private/WorkerPool.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @brief       ODB backend that hands out the objects read by the ObjectPrefetcher
+         *
+         * The workers add to the stage; libgit2 reads from it on whatever thread looks up an
+         * object in the repository. An object is dropped from the stage once it was read, since
+         * libgit2 caches it from then on.
+         */
+        struct PrefetchStage
+        {
+            enum
+            {
+                // Asked before the loose (1) and the pack (2) backends
+                Priority        = 100
+            };
+
+            struct Staged
+            {
+                Staged() : type(GIT_OBJ_BAD) {}
+
+                git_otype       type;
+                QByteArray      data;
+            };
+
+            // Must be the first member; libgit2 only knows about this part
+            git_odb_backend     backend;
+
+            QMutex              mutex;
+            ObjectIdMap<Staged> objects;
+            QQueue<ObjectId>    order;
+            quint64             size;
+            quint64             staged;
+            quint64             served;
+
+            PrefetchStage();
+
+            bool add(const ObjectId& id, git_otype type, const char* data, size_t length,
+                     quint64 limit);
+            void clear();
+
+            static PrefetchStage* stageOf(git_odb_backend* backend);
+            static int read(void** data, size_t* length, git_otype* type,
+                            git_odb_backend* backend, const git_oid* oid);
+            static int readHeader(size_t* length, git_otype* type, git_odb_backend* backend,
+                                  const git_oid* oid);
+            static int forEach(git_odb_backend* backend, git_odb_foreach_cb cb, void* payload);
+            static void destroy(git_odb_backend* backend);
+        };
+
+        PrefetchStage::PrefetchStage()
+            : size(0)
+            , staged(0)
+            , served(0)
+        {
+            git_odb_init_backend(&backend, GIT_ODB_BACKEND_VERSION);
+            backend.read        = &PrefetchStage::read;
+            backend.read_header = &PrefetchStage::readHeader;
+            backend.foreach     = &PrefetchStage::forEach;
+            backend.free        = &PrefetchStage::destroy;
+        }
+
+        /**
+         * @internal
+         * @brief       Stage an object
+         *
+         * @param[in]   limit   The number of bytes the stage may hold. The objects that were
+         *                      staged first are dropped to make room.
+         *
+         * @return      `false` if the object alone exceeds @a limit.
+         */
+        bool PrefetchStage::add(const ObjectId& id, git_otype type, const char* data,
+                                size_t length, quint64 limit)
+        {
+            QMutexLocker lock(&mutex);
+
+            if (objects.find(id)) {
+                return true;
+            }
+
+            if (length > limit) {
+                return false;
+            }
+
+            while (size + length > limit && !order.isEmpty()) {
+                ObjectId oldest = order.dequeue();
+                if (const Staged* o = objects.find(oldest)) {
+                    size -= quint64(o->data.size());
+                    objects.remove(oldest);
+                }
+            }
+
+            // Ids of objects that were read already are only dropped from the order when they
+            // come up for eviction; don't let them pile up.
+            if (order.count() > 2 * objects.count() + 64) {
+                QQueue<ObjectId> alive;
+                foreach (const ObjectId& queued, order) {
+                    if (objects.find(queued)) {
+                        alive.enqueue(queued);
+                    }
+                }
+                order.swap(alive);
+            }
+
+            Staged& o = objects[id];
+            o.type = type;
+            o.data = QByteArray(data, int(length));
+            order.enqueue(id);
+            size += length;
+            staged++;
+
+            return true;
+        }
+
+        void PrefetchStage::clear()
+        {
+            QMutexLocker lock(&mutex);
+
+            objects.clear();
+            order.clear();
+            size = 0;
+        }
+
+        PrefetchStage* PrefetchStage::stageOf(git_odb_backend* backend)
+        {
+            return reinterpret_cast<PrefetchStage*>(backend);
+        }
+
+        int PrefetchStage::read(void** data, size_t* length, git_otype* type,
+                                git_odb_backend* backend, const git_oid* oid)
+        {
+            PrefetchStage* stage = stageOf(backend);
+            ObjectId id = ObjectId::fromRaw(oid->id);
+
+            QMutexLocker lock(&stage->mutex);
+
+            const Staged* o = stage->objects.find(id);
+            if (!o) {
+                return GIT_ENOTFOUND;
+            }
+
+            void* buffer = git_odb_backend_malloc(backend, size_t(o->data.size()));
+            if (!buffer) {
+                return GIT_ERROR;
+            }
+
+            memcpy(buffer, o->data.constData(), size_t(o->data.size()));
+            *data = buffer;
+            *length = size_t(o->data.size());
+            *type = o->type;
+
+            stage->size -= quint64(o->data.size());
+            stage->objects.remove(id);
+            stage->served++;
+
+            return GIT_OK;
+        }
+
+        int PrefetchStage::readHeader(size_t* length, git_otype* type, git_odb_backend* backend,
+                                      const git_oid* oid)
+        {
+            PrefetchStage* stage = stageOf(backend);
+
+            QMutexLocker lock(&stage->mutex);
+
+            const Staged* o = stage->objects.find(ObjectId::fromRaw(oid->id));
+            if (!o) {
+                return GIT_ENOTFOUND;
+            }
+
+            *length = size_t(o->data.size());
+            *type = o->type;
+            return GIT_OK;
+        }
+
+        int PrefetchStage::forEach(git_odb_backend*, git_odb_foreach_cb, void*)
+        {
+            // Everything in here is also in one of the real backends
+            return GIT_OK;
+        }
+
+        void PrefetchStage::destroy(git_odb_backend* backend)
+        {
+            delete stageOf(backend);
+        }
+
+        /**
+         * @internal
+         * @brief       Find the objects that a raw object refers to
+         *
+         * Commits refer to their tree, tags to their target (unless that is a blob) and trees to
+         * their subtrees.
+         */
+        static void childrenOf(git_otype type, const char* data, size_t size,
+                               ObjectIdList& children)
+        {
+            ObjectId id;
+
+            switch (type) {
+            case GIT_OBJ_COMMIT:
+                // "tree <hex>\n"
+                if (size > 45 && !memcmp(data, "tree ", 5) &&
+                        ObjectId::parseMany(data + 5, 1, &id) == 1) {
+                    children.append(id);
+                }
+                break;
+
+            case GIT_OBJ_TAG:
+                // "object <hex>\ntype <type>\n"
+                if (size > 58 && !memcmp(data, "object ", 7) && !memcmp(data + 48, "type ", 5) &&
+                        memcmp(data + 53, "blob\n", 5) &&
+                        ObjectId::parseMany(data + 7, 1, &id) == 1) {
+                    children.append(id);
+                }
+                break;
+
+            case GIT_OBJ_TREE: {
+                // "<octal mode> <name>\0<raw id>" for each entry; subtrees have the mode 40000
+                const char* end = data + size;
+                const char* p = data;
+
+                while (p < end) {
+                    const char* nul = static_cast<const char*>(memchr(p, 0, size_t(end - p)));
+                    if (!nul || end - nul <= GIT_OID_RAWSZ) {
+                        break;
+                    }
+
+                    if (!memcmp(p, "40000 ", 6)) {
+                        children.append(ObjectId::fromRaw(
+                                            reinterpret_cast<const unsigned char*>(nul + 1)));
+                    }
+
+                    p = nul + 1 + GIT_OID_RAWSZ;
+                }
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+
+        ObjectPrefetcher::ObjectPrefetcher(RepositoryPrivate* repo)
+            : mRepo(repo)
+            , mStage(nullptr)
+            , mUsed(0)
+            , mGeneration(0)
+            , mWorkers(0)
+        {
+        }
+
+        ObjectPrefetcher::~ObjectPrefetcher()
+        {
+            cancel();
+            waitForDone();
+        }
+
+        /**
+         * @internal
+         * @brief       Queue objects and start workers for them
+         *
+         * @param[in]   ids     The objects to read.
+         *
+         * @param[in]   depth   How many levels to follow from each of the objects.
+         *
+         * Ids that were queued since the queue last ran empty are not queued again. This must be
+         * called on a thread that may use the repository's handle.
+         */
+        void ObjectPrefetcher::prefetch(const ObjectIdList& ids, int depth)
+        {
+            QMutexLocker lock(&mMutex);
+
+            if (!mStage) {
+                git_odb* odb = nullptr;
+                if (git_repository_odb(&odb, mRepo->mRepo) < 0) {
+                    giterr_clear();
+                    return;
+                }
+
+                // The ODB owns the stage from now on and frees it along with the repository.
+                PrefetchStage* stage = new PrefetchStage;
+                if (git_odb_add_backend(odb, &stage->backend, PrefetchStage::Priority) < 0) {
+                    giterr_clear();
+                    delete stage;
+                    git_odb_free(odb);
+                    return;
+                }
+
+                git_odb_free(odb);
+                mStage = stage;
+            }
+
+            foreach (const ObjectId& id, ids) {
+                enqueue(id, qMax(0, depth));
+            }
+
+            int wanted = qMin(int(MaxWorkers), WorkerPool::chunksFor(mQueue.count(), MinPerWorker));
+            while (!mQueue.isEmpty() && mWorkers < wanted) {
+                mWorkers++;
+                WorkerPool::start([this]() { work(); });
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Drop all pending objects
+         *
+         * Workers finish the object they are reading and then stop. The objects that they find
+         * on the way are not queued anymore. Objects that are staged already stay there.
+         */
+        void ObjectPrefetcher::cancel()
+        {
+            QMutexLocker lock(&mMutex);
+
+            mQueue.clear();
+            mGeneration++;
+            reset();
+        }
+
+        /**
+         * @internal
+         * @brief       Block until all workers have stopped
+         */
+        void ObjectPrefetcher::waitForDone()
+        {
+            QMutexLocker lock(&mMutex);
+
+            while (mWorkers) {
+                mIdle.wait(&mMutex);
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Drop the staged objects that were not asked for yet
+         */
+        void ObjectPrefetcher::clear()
+        {
+            QMutexLocker lock(&mMutex);
+
+            if (mStage) {
+                mStage->clear();
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Get the number of objects that were read ahead so far
+         */
+        quint64 ObjectPrefetcher::prefetched() const
+        {
+            QMutexLocker lock(&mMutex);
+
+            if (!mStage) {
+                return 0;
+            }
+
+            QMutexLocker stageLock(&mStage->mutex);
+            return mStage->staged;
+        }
+
+        /**
+         * @internal
+         * @brief       Get the number of lookups that libgit2 served from the read ahead objects
+         */
+        quint64 ObjectPrefetcher::served() const
+        {
+            QMutexLocker lock(&mMutex);
+
+            if (!mStage) {
+                return 0;
+            }
+
+            QMutexLocker stageLock(&mStage->mutex);
+            return mStage->served;
+        }
+
+        // Must be called with the mutex locked
+        void ObjectPrefetcher::enqueue(const ObjectId& id, int depth)
+        {
+            if (mQueued.insert(id)) {
+                Item item = { id, depth, mGeneration };
+                mQueue.enqueue(item);
+            }
+        }
+
+        // Must be called with the mutex locked
+        void ObjectPrefetcher::reset()
+        {
+            mQueued.clear();
+            mUsed = 0;
+        }
+
+        bool ObjectPrefetcher::next(Item& item)
+        {
+            QMutexLocker lock(&mMutex);
+
+            if (mQueue.isEmpty()) {
+                if (!--mWorkers) {
+                    reset();
+                    mIdle.wakeAll();
+                }
+                return false;
+            }
+
+            item = mQueue.dequeue();
+            return true;
+        }
+
+        void ObjectPrefetcher::work()
+        {
+            Item item;
+
+            Result r;
+            git_repository* repo = mRepo->openHandle(r);
+            git_odb* odb = nullptr;
+
+            if (r) {
+                r = git_repository_odb(&odb, repo);
+            }
+
+            if (!r) {
+                // Without a handle of our own, there is nothing we can do.
+                QMutexLocker lock(&mMutex);
+                mQueue.clear();
+            }
+
+            while (next(item)) {
+                git_odb_object* obj = nullptr;
+                if (git_odb_read(&obj, odb, ObjectId2git(item.id)) < 0) {
+                    giterr_clear();
+                    continue;
+                }
+
+                const git_otype type = git_odb_object_type(obj);
+                const char* data = static_cast<const char*>(git_odb_object_data(obj));
+                const size_t size = git_odb_object_size(obj);
+
+                ObjectIdList children;
+                if (item.depth > 0) {
+                    childrenOf(type, data, size, children);
+                }
+
+                quint64 budget = mRepo->mObjects.prefetchBudget();
+                bool staged = mStage->add(item.id, type, data, size, budget);
+                git_odb_object_free(obj);
+
+                QMutexLocker lock(&mMutex);
+
+                if (item.generation != mGeneration) {
+                    // Cancelled while we were reading
+                    continue;
+                }
+
+                mUsed += size;
+                if (!staged || mUsed > budget) {
+                    mQueue.clear();
+                    continue;
+                }
+
+                foreach (const ObjectId& child, children) {
+                    enqueue(child, item.depth - 1);
+                }
+            }
+
+            git_odb_free(odb);
+            git_repository_free(repo);
+        }
+
+    }
+
+}
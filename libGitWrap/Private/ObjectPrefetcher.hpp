@@ -0,0 +1,106 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QMutex>
+#include <QQueue>
+#include <QWaitCondition>
+
+#include "libGitWrap/ObjectIdSet.hpp"
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        class RepositoryPrivate;
+        struct PrefetchStage;
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Reads objects ahead of their use on GitWrap's worker threads
+         *
+         * A git_repository must not be used by more than one thread at a time. So each worker
+         * opens a handle of its own (RepositoryPrivate::openHandle()) and reads and inflates the
+         * objects through that. The raw data is then put into a PrefetchStage: an ODB backend
+         * that is added to the repository's own handle with the highest priority. When a later
+         * lookup() asks libgit2 for one of these objects, it is served from the stage. It only
+         * has to be parsed then; neither the disk nor zlib is waited for.
+         *
+         * With a depth greater than zero, the workers follow a commit to its tree, a tag to its
+         * target and a tree to its subtrees; each step uses up one level. Blobs are only read if
+         * they are asked for directly.
+         *
+         * Every staged object is charged against the prefetch budget of the ObjectCache. Once it
+         * is used up, the queue is dropped. The budget is reset when the queue runs empty or is
+         * cancelled. The stage itself never holds more than one budget; the objects that were
+         * staged first are dropped first.
+         */
+        class ObjectPrefetcher
+        {
+        private:
+            struct Item
+            {
+                ObjectId    id;
+                int         depth;
+                int         generation;
+            };
+
+            enum
+            {
+                MaxWorkers      = 2,
+                MinPerWorker    = 16
+            };
+
+        public:
+            ObjectPrefetcher(RepositoryPrivate* repo);
+            ~ObjectPrefetcher();
+
+        public:
+            void prefetch(const ObjectIdList& ids, int depth);
+            void cancel();
+            void waitForDone();
+            void clear();
+
+            quint64 prefetched() const;
+            quint64 served() const;
+
+        private:
+            void work();
+            bool next(Item& item);
+            void enqueue(const ObjectId& id, int depth);
+            void reset();
+
+        private:
+            RepositoryPrivate*  mRepo;
+            PrefetchStage*      mStage;     // owned by the ODB of mRepo->mRepo
+            mutable QMutex      mMutex;
+            QWaitCondition      mIdle;
+            QQueue<Item>        mQueue;
+            ObjectIdSet         mQueued;
+            quint64             mUsed;
+            int                 mGeneration;
+            int                 mWorkers;
+        };
+
+    }
+
+}
@@ -31,6 +31,9 @@ namespace Git
          */
         class ObjectPrivate : public RepoObjectPrivate
         {
+        public:
+            typedef GitPtr<ObjectPrivate> Ptr;
+
         protected:
             ObjectPrivate(RepositoryPrivate* repo, git_object* o);
 
@@ -49,6 +52,7 @@ namespace Git
 
         public:
             git_object* mObj;
+            bool        mCached;
         };
 
     }
@@ -0,0 +1,350 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+
+#include "libGitWrap/Private/PathLimiter.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @brief       Constructor
+         *
+         * @param[in]   paths   The paths to limit the walk to, relative to the repository's root.
+         *                      Empty paths are ignored.
+         *
+         * @param[in]   index   The repository's changed path index or `nullptr`.
+         */
+        PathLimiter::PathLimiter(const QStringList& paths, ChangedPathIndex* index)
+            : mCache(CacheSlots)
+            , mIndex(index)
+            , mIndexFresh(false)
+            , mFirstParent(false)
+        {
+            Node root;
+            root.leaf = false;
+            mNodes.append(root);
+
+            foreach (const QString& path, paths) {
+                QByteArray normalized;
+                int node = 0;
+
+                foreach (const QByteArray& part, GW_EncodeQString(path).split('/')) {
+                    if (part.isEmpty()) {
+                        continue;
+                    }
+
+                    int child = -1;
+                    foreach (int c, mNodes.at(node).children) {
+                        if (mNodes.at(c).name == part) {
+                            child = c;
+                            break;
+                        }
+                    }
+
+                    if (child == -1) {
+                        Node n;
+                        n.name = part;
+                        n.leaf = false;
+
+                        child = mNodes.count();
+                        mNodes.append(n);
+                        mNodes[node].children.append(child);
+                    }
+
+                    node = child;
+
+                    if (!normalized.isEmpty()) {
+                        normalized.append('/');
+                    }
+                    normalized.append(part);
+                }
+
+                if (node) {
+                    mNodes[node].leaf = true;
+                    mPaths.append(path);
+                    mKeys.append(ChangedPathIndex::keyFor(normalized));
+                }
+            }
+        }
+
+        /**
+         * @brief       Decide whether a commit is part of the simplified history
+         *
+         * Must be called once for each commit of the walk, in the walk's order.
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       repo        The repository to read the commits and trees from.
+         *
+         * @param[in]       commit      The commit that the walk returned. It stays owned by the
+         *                              caller.
+         *
+         * @return      `true` if the commit shall be handed out.
+         */
+        bool PathLimiter::check(Result& result, git_repository* repo, const git_commit* commit)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            const ObjectId id = ObjectId::fromRaw(git_commit_id(commit)->id);
+
+            // A commit is seen here after all of its children, so its state is final now.
+            quint8 state = 0;
+            if (const quint8* s = mState.find(id)) {
+                state = *s;
+                mState.remove(id);
+            }
+
+            unsigned int count = git_commit_parentcount(commit);
+            if (mFirstParent && count > 1) {
+                count = 1;
+            }
+
+            // Reached only through parents that merges did not follow
+            if ((state & Seen) && !(state & Kept)) {
+                for (unsigned int i = 0; i < count; ++i) {
+                    mState[ObjectId::fromRaw(git_commit_parent_id(commit, i)->id)] |= Seen;
+                }
+
+                return false;
+            }
+
+            const git_oid* tree = git_commit_tree_id(commit);
+            int rc = 0;
+            int follow = -1;
+
+            if (unchangedInIndex(repo, id)) {
+                // Same as the first parent or, for a root commit, as the empty tree
+                follow = count ? 0 : -1;
+            }
+            else if (!count) {
+                rc = compareTrees(result, repo, 0, tree, nullptr);
+            }
+
+            for (unsigned int i = 0; i < count && follow == -1; ++i) {
+                git_commit* parent = nullptr;
+                result = git_commit_lookup(&parent, repo, git_commit_parent_id(commit, i));
+                if (!result) {
+                    rc = -1;
+                    break;
+                }
+
+                rc = compareTrees(result, repo, 0, tree, git_commit_tree_id(parent));
+                git_commit_free(parent);
+
+                if (rc < 0) {
+                    break;
+                }
+
+                if (rc == 0) {
+                    follow = int(i);
+                }
+            }
+
+            if (rc >= 0) {
+                for (unsigned int i = 0; i < count; ++i) {
+                    quint8 flags = Seen;
+                    if (follow == -1 || follow == int(i)) {
+                        flags |= Kept;
+                    }
+
+                    mState[ObjectId::fromRaw(git_commit_parent_id(commit, i)->id)] |= flags;
+                }
+            }
+
+            if (rc < 0) {
+                return false;
+            }
+
+            return count ? follow == -1 : rc > 0;
+        }
+
+        /**
+         * @brief       Forget the state of the current walk
+         *
+         * The results of the tree comparisons are kept; they don't depend on the walk. The index
+         * is refreshed before it is used next.
+         */
+        void PathLimiter::reset()
+        {
+            mState.clear();
+            mIndexFresh = false;
+        }
+
+        /**
+         * @internal
+         * @brief       Ask the changed path index whether a commit left all paths alone
+         *
+         * The index is refreshed once per walk.
+         *
+         * @return      `true` only if the index has a filter for @a commit and it rules out
+         *              changes to all paths.
+         */
+        bool PathLimiter::unchangedInIndex(git_repository* repo, const ObjectId& commit)
+        {
+            if (!mIndex) {
+                return false;
+            }
+
+            QMutexLocker lock(&mIndex->mutex());
+
+            if (!mIndexFresh) {
+                mIndex->refresh(repo);
+                mIndexFresh = true;
+            }
+
+            return mIndex->query(commit, mKeys) == ChangedPathIndex::No;
+        }
+
+        /**
+         * @internal
+         * @brief       Compare two trees along the paths below a node
+         *
+         * A missing tree is treated as an empty one.
+         *
+         * @return      `0` if the trees are the same on all paths, `1` if they differ and `-1` if
+         *              an error occurred.
+         */
+        int PathLimiter::compareTrees(Result& result, git_repository* repo, int node,
+                                      const git_oid* a, const git_oid* b)
+        {
+            if (a == b || (a && b && git_oid_equal(a, b))) {
+                return 0;
+            }
+
+            if (mNodes.at(node).leaf) {
+                return 1;
+            }
+
+            const int slot = slotFor(node, a, b);
+            if (mCache.at(slot).node == node) {
+                return mCache.at(slot).differs ? 1 : 0;
+            }
+
+            git_tree* ta = nullptr;
+            git_tree* tb = nullptr;
+
+            if (a) {
+                result = git_tree_lookup(&ta, repo, a);
+                GW_CHECK_RESULT(result, -1);
+            }
+
+            if (b) {
+                result = git_tree_lookup(&tb, repo, b);
+                if (!result) {
+                    git_tree_free(ta);
+                    return -1;
+                }
+            }
+
+            int rc = 0;
+            foreach (int child, mNodes.at(node).children) {
+                const char* name = mNodes.at(child).name.constData();
+                rc = compareEntries(result, repo, child,
+                                    ta ? git_tree_entry_byname(ta, name) : nullptr,
+                                    tb ? git_tree_entry_byname(tb, name) : nullptr);
+                if (rc) {
+                    break;
+                }
+            }
+
+            git_tree_free(ta);
+            git_tree_free(tb);
+
+            if (rc >= 0) {
+                Slot& s = mCache[slot];
+                s.a = a ? ObjectId::fromRaw(a->id) : ObjectId();
+                s.b = b ? ObjectId::fromRaw(b->id) : ObjectId();
+                s.node = node;
+                s.differs = rc > 0;
+            }
+
+            return rc;
+        }
+
+        int PathLimiter::compareEntries(Result& result, git_repository* repo, int node,
+                                        const git_tree_entry* a, const git_tree_entry* b)
+        {
+            if (!a && !b) {
+                return 0;
+            }
+
+            if (mNodes.at(node).leaf) {
+                if (!a || !b) {
+                    return 1;
+                }
+
+                return git_tree_entry_filemode(a) != git_tree_entry_filemode(b) ||
+                       !git_oid_equal(git_tree_entry_id(a), git_tree_entry_id(b)) ? 1 : 0;
+            }
+
+            // Anything that is not a tree can't contain the paths below this node
+            const git_oid* ta = nullptr;
+            const git_oid* tb = nullptr;
+
+            if (a && git_tree_entry_type(a) == GIT_OBJ_TREE) {
+                ta = git_tree_entry_id(a);
+            }
+
+            if (b && git_tree_entry_type(b) == GIT_OBJ_TREE) {
+                tb = git_tree_entry_id(b);
+            }
+
+            return compareTrees(result, repo, node, ta, tb);
+        }
+
+        /**
+         * @internal
+         * @brief       Find the cache slot for a pair of trees
+         *
+         * The table is direct mapped: A pair has exactly one slot and replaces what was there
+         * before. The returned slot holds the pair's result only, if its node and ids match.
+         *
+         * @return      The index of the slot. If the slot does not hold the pair, its node is
+         *              set to `-1`.
+         */
+        int PathLimiter::slotFor(int node, const git_oid* a, const git_oid* b)
+        {
+            quint32 ha = 0;
+            quint32 hb = 0;
+
+            if (a) {
+                memcpy(&ha, a->id, sizeof(ha));
+            }
+
+            if (b) {
+                memcpy(&hb, b->id, sizeof(hb));
+            }
+
+            const int slot = int((ha ^ (hb * 31) ^ quint32(node) * 0x9E3779B9u) % CacheSlots);
+
+            Slot& s = mCache[slot];
+            if (s.node != node ||
+                    s.a != (a ? ObjectId::fromRaw(a->id) : ObjectId()) ||
+                    s.b != (b ? ObjectId::fromRaw(b->id) : ObjectId())) {
+                s.node = -1;
+            }
+
+            return slot;
+        }
+
+    }
+
+}
@@ -0,0 +1,134 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QStringList>
+#include <QVector>
+
+#include "libGitWrap/ObjectIdSet.hpp"
+
+#include "libGitWrap/Private/ChangedPathIndex.hpp"
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Limits a revision walk to the commits that change a set of paths
+         *
+         * This implements git's default history simplification: A commit is shown, if the
+         * content at the paths differs from each of its parents. A merge that has the same
+         * content as one of its parents is not shown, and the walk follows only that parent; the
+         * commits that are reachable through the other parents alone are dropped, too.
+         *
+         * The walk must hand out the commits in topological order, so that every commit is seen
+         * only after all of its children.
+         *
+         * Two trees are compared only along the paths: Starting at the root, the entries of the
+         * next path component are looked up in both trees. Equal tree ids end the comparison for
+         * everything below them. The results for recently compared pairs of subtrees are kept in
+         * a small table, so the same pair isn't read twice when it shows up for several commits.
+         *
+         * If the walk follows only first parents, merges are compared to their first parent only.
+         *
+         * If a ChangedPathIndex is given and its filter for a commit rules out changes to all
+         * paths, the commit is taken to be the same as its first parent without reading a tree.
+         *
+         * The paths are literal; there are no wildcards. A path that names a directory matches
+         * everything below it.
+         */
+        class PathLimiter
+        {
+        private:
+            struct Node
+            {
+                QByteArray      name;
+                bool            leaf;
+                QVector<int>    children;
+            };
+
+            struct Slot
+            {
+                Slot() : node(-1), differs(false) {}
+
+                ObjectId        a;
+                ObjectId        b;
+                int             node;
+                bool            differs;
+            };
+
+            enum
+            {
+                CacheSlots      = 4096,
+
+                Seen            = 1 << 0,
+                Kept            = 1 << 1
+            };
+
+        public:
+            PathLimiter(const QStringList& paths, ChangedPathIndex* index = nullptr);
+
+        public:
+            bool isEmpty() const;
+            QStringList paths() const;
+            void setFirstParentOnly(bool firstParentOnly);
+
+            bool check(Result& result, git_repository* repo, const git_commit* commit);
+            void reset();
+
+        private:
+            int compareTrees(Result& result, git_repository* repo, int node,
+                             const git_oid* a, const git_oid* b);
+            int compareEntries(Result& result, git_repository* repo, int node,
+                               const git_tree_entry* a, const git_tree_entry* b);
+            int slotFor(int node, const git_oid* a, const git_oid* b);
+            bool unchangedInIndex(git_repository* repo, const ObjectId& commit);
+
+        private:
+            QStringList         mPaths;
+            QVector<Node>       mNodes;
+            QVector<Slot>       mCache;
+            ObjectIdMap<quint8> mState;
+            ChangedPathIndex*   mIndex;
+            ChangedPathIndex::Keys mKeys;
+            bool                mIndexFresh;
+            bool                mFirstParent;
+        };
+
+        inline bool PathLimiter::isEmpty() const
+        {
+            return mNodes.count() < 2;
+        }
+
+        inline QStringList PathLimiter::paths() const
+        {
+            return mPaths;
+        }
+
+        inline void PathLimiter::setFirstParentOnly(bool firstParentOnly)
+        {
+            mFirstParent = firstParentOnly;
+        }
+
+    }
+
+}
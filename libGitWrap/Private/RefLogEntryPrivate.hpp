@@ -19,6 +19,7 @@
 #pragma once
 
 #include "libGitWrap/Private/BasePrivate.hpp"
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
 
 namespace Git
 {
@@ -34,10 +35,11 @@ namespace Git
         class RefLogEntryPrivate : public BasePrivate
         {
         public:
-            explicit RefLogEntryPrivate(const git_reflog_entry *entry);
+            RefLogEntryPrivate(RepositoryPrivate* repo, const git_reflog_entry *entry);
             ~RefLogEntryPrivate();
 
         public:
+            RepositoryPrivate::Ptr      mRepo;
             const git_reflog_entry *    mEntry;
         };
     }
@@ -0,0 +1,71 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "libGitWrap/ObjectIdSet.hpp"
+
+#include "libGitWrap/Private/RepoObjectPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        class RefSnapshotPrivate : public RepoObjectPrivate
+        {
+        public:
+            enum Flags
+            {
+                IsSymbolic      = 1 << 0,
+                IsAnnotatedTag  = 1 << 1
+            };
+
+        public:
+            RefSnapshotPrivate(RepositoryPrivate* repo);
+            ~RefSnapshotPrivate();
+
+        public:
+            bool read(Result& result, const QHash<QString, qint64>& stamps);
+            void collectStamps(QHash<QString, qint64>& stamps) const;
+            bool isStale(const QHash<QString, qint64>& stamps) const;
+
+            const char* nameAt(int index) const;
+
+        private:
+            bool peel(git_odb* odb, const ObjectId& target, ObjectId& peeled);
+            int internSymbolic(const char* name);
+            void sortByName();
+
+        public:
+            QByteArray              mArena;
+            QVector<int>            mNames;
+            QVector<int>            mSymbolic;
+            QVector<quint8>         mFlags;
+            ObjectIdList            mTargets;
+            ObjectIdList            mPeeled;
+
+            QHash<QString, qint64>  mStamps;
+
+            // Peel results of the last read; most of them are still valid on refresh
+            ObjectIdMap<ObjectId>   mPeelCache;
+            QHash<QByteArray, int>  mSymbolicIndex;
+        };
+
+    }
+
+}
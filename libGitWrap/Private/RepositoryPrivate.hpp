@@ -17,7 +17,13 @@
 #pragma once
 
 #include "libGitWrap/Private/BasePrivate.hpp"
+#include "libGitWrap/Private/ChangedPathIndex.hpp"
+#include "libGitWrap/Private/CommitGraph.hpp"
 #include "libGitWrap/Private/GitWrapPrivate.hpp"
+#include "libGitWrap/Private/ObjectCache.hpp"
+#include "libGitWrap/Private/ObjectIdIndex.hpp"
+#include "libGitWrap/Private/ObjectPrefetcher.hpp"
+#include "libGitWrap/Private/StringPool.hpp"
 
 #include "libGitWrap/Submodule.hpp"
 
@@ -38,11 +44,18 @@ namespace Git
 
         public:
             Reference getHead(Result& result) const;
+            git_repository* openHandle(Result& result) const;
 
         public:
             git_repository* mRepo;
             IndexPrivate*   mIndex;
             Submodule       openedFrom;
+            ObjectCache     mObjects;
+            ObjectIdIndex   mIdIndex;
+            CommitGraphCache mCommitGraph;
+            ChangedPathIndex mChangedPaths;
+            StringInterner  mSignatureStrings;
+            ObjectPrefetcher mPrefetcher;
         };
 
     }
@@ -25,6 +25,8 @@ namespace Git
     namespace Internal
     {
 
+        class PathLimiter;
+
         /**
          * @internal
          * @ingroup     GitWrap
@@ -38,7 +40,27 @@ namespace Git
             ~RevisionWalkerPrivate();
 
         public:
-            git_revwalk* mWalker;
+            bool next(Result& result, git_oid* oid);
+            bool hasDateWindow() const;
+            bool inDateWindow(qint64 time);
+            void applySorting();
+
+        public:
+            git_revwalk*    mWalker;
+            unsigned int    mSorting;
+            PathLimiter*    mLimiter;
+            bool            mFirstParent;
+
+            // Limits, set by the user
+            int             mSkip;
+            int             mMaxCount;
+            qint64          mSince;
+            qint64          mUntil;
+
+            // Progress of the current walk
+            int             mSkipped;
+            int             mReturned;
+            int             mOlder;
         };
 
     }
@@ -0,0 +1,122 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+
+#include "libGitWrap/StatusMonitor.hpp"
+
+class QFileSystemWatcher;
+class QSocketNotifier;
+class QTimer;
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        class StatusMonitorPrivate
+        {
+        public:
+            enum
+            {
+                // Milliseconds to wait for more events before looking at the changed paths
+                FlushDelay      = 20,
+
+                // With more changed paths than this, a full rescan is cheaper
+                MaxPendingPaths = 4096
+            };
+
+        public:
+            StatusMonitorPrivate(StatusMonitor* owner, const Repository& repo,
+                                 const StatusOptions& opts);
+            ~StatusMonitorPrivate();
+
+        public:
+            bool startWatching(Result& result);
+            void stopWatching();
+
+            bool watchGitDir(Result& result, const QString& relDir);
+            void watchGitDirs();
+            void readHeadRef();
+            QStringList gitFiles() const;
+            void gitFileChanged(const QString& relPath);
+            void gitDirChanged();
+
+            bool watchTree(Result& result, const QString& relDir, bool revisit = false);
+            void unwatchTree(const QString& relDir);
+            bool addWatch(Result& result, const QString& relDir);
+
+            void readEvents();
+            void handleEvent(int wd, quint32 mask, const char* name);
+            void directoryChanged(const QString& absPath);
+            QStringList trackedFilesIn(const QString& relDir) const;
+
+            void touch(const QString& relPath);
+            void scheduleFlush();
+            void flush();
+            void rescan();
+            void update(const QStringList& relPaths);
+            bool touchesRename(const QStringList& relPaths, const StatusHash& fresh) const;
+
+            QString absolutePath(const QString& relPath) const;
+            QString relativePath(const QString& absPath) const;
+            bool isInGitDir(const QString& relPath) const;
+
+        public:
+            StatusMonitor*              mOwner;
+            Repository                  mRepo;
+            StatusOptions               mOpts;
+            QString                     mWorkDir;
+            QString                     mGitDir;
+            QString                     mRelGitDir;
+            bool                        mRunning;
+            Result                      mResult;
+
+            QMap<QString, StatusFlags>  mSnapshot;
+
+            QSet<QString>               mPending;
+            bool                        mNeedsRescan;
+            bool                        mIgnoreChanged;
+            QTimer*                     mFlushTimer;
+
+            // relative directory -> watch; the root directory is the empty string
+            QHash<QString, int>         mWatchOf;
+
+            // The ref that HEAD points to, relative to the git directory; empty if detached
+            QString                     mHeadRef;
+
+            // directory in the git directory (relative to it) -> watch
+            QHash<QString, int>         mGitWatchOf;
+
+            // inotify backend
+            int                         mFd;
+            QHash<int, QString>         mWatches;
+            QHash<int, QString>         mGitWatches;
+            QSocketNotifier*            mNotifier;
+
+            // QFileSystemWatcher backend
+            QFileSystemWatcher*         mWatcher;
+            QHash<QString, qint64>      mGitStamps;
+        };
+
+    }
+
+}
@@ -0,0 +1,160 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libGitWrap/Private/StringPool.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        StringPool::StringPool()
+        {
+            mStrings.append(QString());
+        }
+
+        /**
+         * @internal
+         * @brief       Add a string to the pool, unless it already is in there
+         *
+         * @param[in]   str     Pointer to UTF-8 encoded data.
+         *
+         * @param[in]   len     Length of @a str in bytes.
+         *
+         * @return      The index of the string in the pool.
+         */
+        int StringPool::intern(const char* str, int len)
+        {
+            if (!len) {
+                return 0;
+            }
+
+            // Probe without copying the data
+            QHash<QByteArray, int>::const_iterator it = mIndex.constFind(
+                        QByteArray::fromRawData(str, len));
+
+            if (it != mIndex.constEnd()) {
+                return it.value();
+            }
+
+            int index = mStrings.count();
+            mStrings.append(QString::fromUtf8(str, len));
+            mIndex.insert(QByteArray(str, len), index);
+            return index;
+        }
+
+        /**
+         * @internal
+         * @brief       Add a string to the pool without looking for an equal one
+         *
+         * @param[in]   str     Pointer to UTF-8 encoded data.
+         *
+         * @param[in]   len     Length of @a str in bytes.
+         *
+         * @return      The index of the string in the pool.
+         */
+        int StringPool::append(const char* str, int len)
+        {
+            if (!len) {
+                return 0;
+            }
+
+            mStrings.append(QString::fromUtf8(str, len));
+            return mStrings.count() - 1;
+        }
+
+        /**
+         * @internal
+         * @brief       Move all strings of another pool into this one
+         *
+         * Interned strings of @a other are interned into this pool, all others are appended.
+         *
+         * @param[in]   other   The pool to merge.
+         *
+         * @return      A table that maps the indices of @a other to the indices in this pool.
+         */
+        QVector<int> StringPool::merge(const StringPool& other)
+        {
+            QVector<int> map(other.mStrings.count(), -1);
+            map[0] = 0;
+
+            mStrings.reserve(mStrings.count() + other.mStrings.count() - 1);
+
+            for (QHash<QByteArray, int>::const_iterator it = other.mIndex.constBegin();
+                 it != other.mIndex.constEnd(); ++it) {
+
+                QHash<QByteArray, int>::const_iterator mine = mIndex.constFind(it.key());
+
+                if (mine != mIndex.constEnd()) {
+                    map[it.value()] = mine.value();
+                }
+                else {
+                    int index = mStrings.count();
+                    mStrings.append(other.mStrings.at(it.value()));
+                    mIndex.insert(it.key(), index);
+                    map[it.value()] = index;
+                }
+            }
+
+            for (int i = 1; i < map.count(); ++i) {
+                if (map[i] == -1) {
+                    map[i] = mStrings.count();
+                    mStrings.append(other.mStrings.at(i));
+                }
+            }
+
+            return map;
+        }
+
+        /**
+         * @internal
+         * @brief       Get the shared QString for a UTF-8 string
+         *
+         * @param[in]   str     NUL terminated, UTF-8 encoded data; may be `nullptr`.
+         *
+         * @return      A QString that shares its data with all earlier results for the same bytes.
+         *              For an empty @a str, this is an empty QString that is not null, just like
+         *              the one QString::fromUtf8() returns. Only for a `nullptr`, the QString is
+         *              null.
+         */
+        QString StringInterner::intern(const char* str)
+        {
+            if (!str) {
+                return QString();
+            }
+
+            int len = int(strlen(str));
+            if (!len) {
+                return QString::fromLatin1("");
+            }
+
+            QByteArray key = QByteArray::fromRawData(str, len);
+            QMutexLocker lock(&mMutex);
+
+            QHash<QByteArray, QString>::const_iterator it = mStrings.constFind(key);
+            if (it != mStrings.constEnd()) {
+                return it.value();
+            }
+
+            QString string = QString::fromUtf8(str, len);
+            mStrings.insert(QByteArray(str, len), string);
+            return string;
+        }
+
+    }
+
+}
@@ -0,0 +1,105 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QMutex>
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       A table of strings, where equal strings can be shared
+         *
+         * Strings are identified by their index into the table. Index 0 is always the empty
+         * string.
+         *
+         * intern() converts a given UTF-8 string only once to a QString; later calls with the same
+         * bytes return the index of the existing string. append() always adds a new string and is
+         * meant for data that is unlikely to repeat (like commit summaries).
+         *
+         * A StringPool is not thread safe. Use one pool per thread and merge() them afterwards.
+         */
+        class StringPool
+        {
+        public:
+            StringPool();
+
+        public:
+            int intern(const char* str, int len);
+            int intern(const char* str);
+            int append(const char* str, int len);
+
+            QVector<int> merge(const StringPool& other);
+
+            int count() const;
+            const QString& at(int index) const;
+            QVector<QString> strings() const;
+
+        private:
+            QHash<QByteArray, int>  mIndex;
+            QVector<QString>        mStrings;
+        };
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       A thread safe set of strings, to share the data of equal QStrings
+         *
+         * Unlike StringPool, there are no indices; intern() returns the shared QString itself.
+         * Strings are never removed, so this is meant for a small set of often repeated strings,
+         * like the names and email addresses in signatures.
+         */
+        class StringInterner
+        {
+        public:
+            QString intern(const char* str);
+
+        private:
+            QMutex                      mMutex;
+            QHash<QByteArray, QString>  mStrings;
+        };
+
+        inline int StringPool::intern(const char* str)
+        {
+            return intern(str, str ? int(strlen(str)) : 0);
+        }
+
+        inline int StringPool::count() const
+        {
+            return mStrings.count();
+        }
+
+        inline const QString& StringPool::at(int index) const
+        {
+            return mStrings.at(index);
+        }
+
+        inline QVector<QString> StringPool::strings() const
+        {
+            return mStrings;
+        }
+
+    }
+
+}
@@ -0,0 +1,556 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
+#include "libGitWrap/Private/TreeWalker.hpp"
+#include "libGitWrap/Private/WorkerPool.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        void TreeWalker::setBase(const QByteArray& base)
+        {
+            mPath.resize(0);
+            mPath.append(base.constData(), base.length());
+        }
+
+        bool TreeWalker::isReported(ObjectType type, TreeWalkFlags flags)
+        {
+            switch (type) {
+            case otTree:            return !flags.testFlag(TreeWalkSkipTrees);
+            case otCommit:          return !flags.testFlag(TreeWalkSkipSubmodules);
+            default:                return true;
+            }
+        }
+
+        bool TreeWalker::walkTree(Result& result, const git_tree* tree, int depth)
+        {
+            size_t count = git_tree_entrycount(tree);
+
+            for (size_t i = 0; i < count; ++i) {
+                if (!visitEntry(result, git_tree_entry_byindex(tree, i), depth)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Walk the entries of a tree that is not the root of the walk
+         *
+         * @param[in]   path        Path of the tree itself, without a trailing slash.
+         *
+         * @param[in]   depth       Depth of the tree's entries.
+         */
+        bool TreeWalker::walkSubtree(Result& result, const ObjectId& id, const char* path,
+                                     int pathLength, int depth)
+        {
+            git_tree* tree = nullptr;
+            result = git_tree_lookup(&tree, mRepo, ObjectId2git(id));
+            GW_CHECK_RESULT(result, false);
+
+            mPath.resize(0);
+            mPath.append(path, pathLength);
+            mPath.append('/');
+
+            bool goOn = walkTree(result, tree, depth);
+
+            git_tree_free(tree);
+            return goOn;
+        }
+
+        bool TreeWalker::descend(Result& result, const git_tree_entry* entry, int depth)
+        {
+            git_tree* tree = nullptr;
+            result = git_tree_lookup(&tree, mRepo, git_tree_entry_id(entry));
+            GW_CHECK_RESULT(result, false);
+
+            // Turn the entry's path into the base of the subtree: "dir\0" becomes "dir/"
+            int base = mPath.size();
+            mPath[base - 1] = '/';
+
+            bool goOn = walkTree(result, tree, depth + 1);
+
+            mPath.resize(base);
+            mPath[base - 1] = '\0';
+
+            git_tree_free(tree);
+            return goOn;
+        }
+
+        /**
+         * @internal
+         * @brief       Report an entry and walk into it, if it is a tree
+         *
+         * @return      `false` if the walk shall end, because of an error or because the visitor
+         *              asked for it.
+         */
+        bool TreeWalker::visitEntry(Result& result, const git_tree_entry* entry, int depth)
+        {
+            const char* name = git_tree_entry_name(entry);
+            int nameLength = int(std::strlen(name));
+            int base = mPath.size();
+
+            mPath.resize(base + nameLength + 1);
+            std::memcpy(mPath.data() + base, name, size_t(nameLength) + 1);
+
+            TreeVisitor::Entry e;
+            e.pathLength = base + nameLength;
+            e.depth = depth;
+            e.type = gitotype2ObjectType(git_tree_entry_type(entry));
+            e.mode = FileModes(git_tree_entry_filemode(entry));
+            e.id = ObjectId::fromRaw(git_tree_entry_id(entry)->id);
+
+            bool isTree = e.type == otTree;
+            bool report = isReported(e.type, mFlags);
+            bool goOn = true;
+
+            if (report && (!isTree || mOrder == TreeWalkPreOrder)) {
+                e.path = mPath.constData();
+                e.name = e.path + base;
+
+                switch (mVisitor->visit(e)) {
+                case TreeVisitor::Stop:         goOn = false;   break;
+                case TreeVisitor::SkipSubtree:  isTree = false; break;
+                case TreeVisitor::Continue:     break;
+                }
+            }
+
+            if (goOn && isTree) {
+                goOn = descend(result, entry, depth);
+
+                if (goOn && report && mOrder == TreeWalkPostOrder) {
+                    e.path = mPath.constData();
+                    e.name = e.path + base;
+                    goOn = mVisitor->visit(e) != TreeVisitor::Stop;
+                }
+            }
+
+            mPath.resize(base);
+            return goOn;
+        }
+
+        TreeVisitor::Action TreeRecorder::visit(const Entry& entry)
+        {
+            Record r;
+            r.id = entry.id;
+            r.pathOffset = mPaths.size();
+            r.pathLength = entry.pathLength;
+            r.nameOffset = int(entry.name - entry.path);
+            r.depth = entry.depth;
+            r.type = entry.type;
+            r.mode = entry.mode;
+
+            mRecords.push_back(r);
+            mPaths.append(entry.path, entry.pathLength + 1);
+
+            return Continue;
+        }
+
+        void TreeRecorder::entry(int index, Entry& entry) const
+        {
+            const Record& r = mRecords[index];
+
+            entry.path = mPaths.constData() + r.pathOffset;
+            entry.pathLength = r.pathLength;
+            entry.name = entry.path + r.nameOffset;
+            entry.depth = r.depth;
+            entry.type = r.type;
+            entry.mode = r.mode;
+            entry.id = r.id;
+        }
+
+        /**
+         * @internal
+         * @brief       Hands the entries to the visitor from many threads and shares its Stop
+         */
+        class ParallelTreeWalker::SharedStop : public TreeVisitor
+        {
+        public:
+            SharedStop(TreeVisitor* visitor, QAtomicInt& stop)
+                : mVisitor(visitor)
+                , mStop(stop)
+            {
+            }
+
+        public:
+            Action visit(const Entry& entry)
+            {
+                if (mStop.loadAcquire()) {
+                    return Stop;
+                }
+
+                Action action = mVisitor->visit(entry);
+                if (action == Stop) {
+                    mStop.storeRelease(1);
+                }
+
+                return action;
+            }
+
+        private:
+            TreeVisitor*    mVisitor;
+            QAtomicInt&     mStop;
+        };
+
+        ParallelTreeWalker::ParallelTreeWalker(RepositoryPrivate* repo, TreeVisitor* visitor,
+                                               TreeWalkOrder order, TreeWalkFlags flags,
+                                               int splitDepth)
+            : mRepo(repo)
+            , mVisitor(visitor)
+            , mOrder(order)
+            , mFlags(flags)
+            , mSplitDepth(qMax(1, splitDepth))
+            , mUnordered(flags.testFlag(TreeWalkUnordered))
+            , mStop(0)
+            , mNext(0)
+            , mReplayed(0)
+            , mAhead(0)
+            , mSkipDepth(-1)
+        {
+        }
+
+        /**
+         * @internal
+         * @brief       Plan the walk: Record the entries above the split depth and find the tasks
+         *
+         * In the unordered pre-order mode, the entries are handed to the visitor right away, so
+         * it can skip subtrees before they become tasks.
+         */
+        TreeVisitor::Action ParallelTreeWalker::visit(const Entry& entry)
+        {
+            if (mUnordered && mOrder == TreeWalkPreOrder
+                    && TreeWalker::isReported(entry.type, mFlags)) {
+                Action action = mVisitor->visit(entry);
+                if (action != Continue) {
+                    return action;
+                }
+            }
+
+            int record = mPlan.count();
+            mPlan.visit(entry);
+
+            if (entry.type == otTree && entry.depth == mSplitDepth - 1) {
+                Task task;
+                task.record = record;
+                mTasks.push_back(task);
+                return SkipSubtree;
+            }
+
+            return Continue;
+        }
+
+        bool ParallelTreeWalker::walk(Result& result, const git_tree* tree)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            TreeWalker planner(mRepo->mRepo, this, TreeWalkPreOrder, TreeWalkNone);
+            if (!planner.walkTree(result, tree, 0)) {
+                return false;
+            }
+
+            if (!runTasks(result)) {
+                return false;
+            }
+
+            return !mUnordered || mOrder == TreeWalkPreOrder || replayPlan();
+        }
+
+        bool ParallelTreeWalker::runTask(Result& result, git_repository* repo, Task& task,
+                                         TreeVisitor* sharedVisitor)
+        {
+            Entry tree;
+            mPlan.entry(task.record, tree);
+
+            TreeWalker walker(repo, mUnordered ? sharedVisitor : &task.recorder,
+                              mUnordered ? mOrder : TreeWalkPreOrder,
+                              mUnordered ? mFlags : TreeWalkNone);
+
+            return walker.walkSubtree(result, tree.id, tree.path, tree.pathLength,
+                                      tree.depth + 1);
+        }
+
+        /**
+         * @internal
+         * @brief       Run the tasks on the worker threads
+         *
+         * In the ordered mode, the calling thread replays the walk meanwhile.
+         *
+         * @return      `false` if a task failed or the visitor stopped the walk.
+         */
+        bool ParallelTreeWalker::runTasks(Result& result)
+        {
+            const int count = int(mTasks.size());
+            if (!count) {
+                return mUnordered || replayTasks(result, mRepo->mRepo);
+            }
+
+            int chunks = WorkerPool::chunksFor(count, 1);
+            std::vector<Result> results(chunks);
+            Result* chunkResults = results.data();
+            SharedStop shared(mVisitor, mStop);
+            bool replayed = true;
+
+            mAhead = 2 * chunks;
+
+            WorkerPool::run(chunks, count, [&](int chunk, int, int) {
+                Result& r = chunkResults[chunk];
+
+                // Like for CommitInfoLoader: The calling thread uses the repository's handle.
+                if (!chunk && !mUnordered) {
+                    replayed = replayTasks(r, mRepo->mRepo);
+                    return;
+                }
+
+                git_repository* repo = mRepo->mRepo;
+                if (chunk) {
+                    repo = mRepo->openHandle(r);
+                    if (!r) {
+                        stop();
+                        return;
+                    }
+                }
+
+                for (int t = claim(); t >= 0; t = claim()) {
+                    bool ok = runTask(r, repo, mTasks[t], &shared);
+                    finished(t, ok);
+                    if (!ok) {
+                        break;
+                    }
+                }
+
+                if (chunk) {
+                    git_repository_free(repo);
+                }
+            });
+
+            for (int i = 0; i < chunks; ++i) {
+                if (!results[i]) {
+                    result = results[i];
+                    return false;
+                }
+            }
+
+            // Only the visitor can have stopped the walk now.
+            return mUnordered ? !mStop.loadAcquire() : replayed;
+        }
+
+        /**
+         * @internal
+         * @brief       Take the next task for a worker
+         *
+         * In the ordered mode, this blocks while the worker would get too far ahead of the replay.
+         *
+         * @return      The index of the task or `-1` if there is none left or the walk stopped.
+         */
+        int ParallelTreeWalker::claim()
+        {
+            QMutexLocker lock(&mMutex);
+
+            while (!mUnordered && !mStop.loadAcquire() && mNext < int(mTasks.size())
+                   && mNext >= mReplayed + mAhead) {
+                mChanged.wait(&mMutex);
+            }
+
+            if (mStop.loadAcquire() || mNext >= int(mTasks.size())) {
+                return -1;
+            }
+
+            return mNext++;
+        }
+
+        /**
+         * @internal
+         * @brief       Wait until a task is done, so it can be replayed
+         *
+         * If no worker took the task yet, the calling thread runs it itself.
+         *
+         * @return      `false` if the task failed or the walk was stopped.
+         */
+        bool ParallelTreeWalker::await(Result& result, git_repository* repo, int task)
+        {
+            QMutexLocker lock(&mMutex);
+
+            forever {
+                if (mStop.loadAcquire()) {
+                    return false;
+                }
+
+                if (mTasks[task].done) {
+                    return true;
+                }
+
+                // All tasks before this one are replayed and so were taken.
+                if (mNext == task) {
+                    mNext++;
+                    lock.unlock();
+
+                    bool ok = runTask(result, repo, mTasks[task], nullptr);
+                    finished(task, ok);
+                    return ok;
+                }
+
+                mChanged.wait(&mMutex);
+            }
+        }
+
+        void ParallelTreeWalker::finished(int task, bool ok)
+        {
+            QMutexLocker lock(&mMutex);
+
+            mTasks[task].done = true;
+            if (!ok) {
+                mStop.storeRelease(1);
+            }
+
+            mChanged.wakeAll();
+        }
+
+        void ParallelTreeWalker::stop()
+        {
+            QMutexLocker lock(&mMutex);
+            mStop.storeRelease(1);
+            mChanged.wakeAll();
+        }
+
+        bool ParallelTreeWalker::report(const TreeRecorder& recorder, int index)
+        {
+            if (!TreeWalker::isReported(recorder.type(index), mFlags)) {
+                return true;
+            }
+
+            Entry e;
+            recorder.entry(index, e);
+
+            Action action = mVisitor->visit(e);
+            if (action == SkipSubtree && e.type == otTree && mOrder == TreeWalkPreOrder) {
+                mSkipDepth = e.depth;
+            }
+
+            return action != Stop;
+        }
+
+        /**
+         * @internal
+         * @brief       Post-order: Report the trees that are done before an entry at @a depth
+         */
+        bool ParallelTreeWalker::closeTrees(int depth)
+        {
+            while (!mOpen.isEmpty() && mOpen.last().depth >= depth) {
+                Open o = mOpen.takeLast();
+                if (!report(*o.recorder, o.index)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool ParallelTreeWalker::replayEntry(const TreeRecorder& recorder, int index)
+        {
+            const int depth = recorder.depth(index);
+
+            if (!closeTrees(depth)) {
+                return false;
+            }
+
+            if (mSkipDepth >= 0) {
+                if (depth > mSkipDepth) {
+                    return true;
+                }
+                mSkipDepth = -1;
+            }
+
+            if (recorder.type(index) == otTree && mOrder == TreeWalkPostOrder) {
+                Open o = { &recorder, index, depth };
+                mOpen.append(o);
+                return true;
+            }
+
+            return report(recorder, index);
+        }
+
+        /**
+         * @internal
+         * @brief       Hand the entries above the split depth to the visitor
+         *
+         * This is for the unordered post-order mode, where the workers have reported everything
+         * below the split depth already.
+         */
+        bool ParallelTreeWalker::replayPlan()
+        {
+            for (int i = 0; i < mPlan.count(); ++i) {
+                if (!replayEntry(mPlan, i)) {
+                    return false;
+                }
+            }
+
+            return closeTrees(0);
+        }
+
+        /**
+         * @internal
+         * @brief       Hand all entries to the visitor in the order of Tree::walk()
+         *
+         * Each task's entries are replayed right after the task's tree, as soon as the task is
+         * done. Its recording is dropped then.
+         */
+        bool ParallelTreeWalker::replayTasks(Result& result, git_repository* repo)
+        {
+            size_t task = 0;
+
+            for (int i = 0; i < mPlan.count(); ++i) {
+                bool ok = replayEntry(mPlan, i);
+
+                if (ok && task < mTasks.size() && mTasks[task].record == i) {
+                    Task& t = mTasks[task];
+                    ok = await(result, repo, int(task));
+
+                    // Otherwise, a worker might still be recording
+                    if (ok) {
+                        for (int j = 0; ok && j < t.recorder.count(); ++j) {
+                            ok = replayEntry(t.recorder, j);
+                        }
+
+                        // Nothing may refer to the recording once it is dropped
+                        ok = ok && closeTrees(mPlan.depth(i) + 1);
+                        t.recorder = TreeRecorder();
+                    }
+
+                    QMutexLocker lock(&mMutex);
+                    mReplayed = int(++task);
+                    mChanged.wakeAll();
+                }
+
+                if (!ok) {
+                    stop();
+                    return false;
+                }
+            }
+
+            return closeTrees(0);
+        }
+
+    }
+
+}
@@ -0,0 +1,199 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVarLengthArray>
+#include <QWaitCondition>
+
+#include "libGitWrap/TreeVisitor.hpp"
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        class RepositoryPrivate;
+
+        /**
+         * @internal
+         * @brief       Implementation of Tree::walk()
+         *
+         * mPath holds the path of the tree that is currently walked, including a trailing slash.
+         * Each entry's name is appended in place, so the buffer only grows with the deepest path.
+         */
+        class TreeWalker
+        {
+        public:
+            TreeWalker(git_repository* repo, TreeVisitor* visitor, TreeWalkOrder order,
+                       TreeWalkFlags flags)
+                : mRepo(repo)
+                , mVisitor(visitor)
+                , mOrder(order)
+                , mFlags(flags)
+            {
+            }
+
+        public:
+            bool walkTree(Result& result, const git_tree* tree, int depth);
+            bool walkSubtree(Result& result, const ObjectId& id, const char* path, int pathLength,
+                             int depth);
+            bool visitEntry(Result& result, const git_tree_entry* entry, int depth);
+            void setBase(const QByteArray& base);
+
+            static bool isReported(ObjectType type, TreeWalkFlags flags);
+
+        private:
+            bool descend(Result& result, const git_tree_entry* entry, int depth);
+
+        private:
+            git_repository*             mRepo;
+            TreeVisitor*                mVisitor;
+            TreeWalkOrder               mOrder;
+            TreeWalkFlags               mFlags;
+            QVarLengthArray<char, 1024> mPath;
+        };
+
+        /**
+         * @internal
+         * @brief       A TreeVisitor that stores the entries in pre-order, for a replay
+         *
+         * All paths are kept in one buffer, NUL separated.
+         */
+        class TreeRecorder : public TreeVisitor
+        {
+        private:
+            struct Record
+            {
+                ObjectId        id;
+                int             pathOffset;
+                int             pathLength;
+                int             nameOffset;
+                int             depth;
+                ObjectType      type;
+                FileModes       mode;
+            };
+
+        public:
+            Action visit(const Entry& entry);
+
+            int count() const                       { return int(mRecords.size()); }
+            int depth(int index) const              { return mRecords[index].depth; }
+            ObjectType type(int index) const        { return mRecords[index].type; }
+            void entry(int index, Entry& entry) const;
+
+        private:
+            std::vector<Record>         mRecords;
+            QByteArray                  mPaths;
+        };
+
+        /**
+         * @internal
+         * @brief       Implementation of Tree::parallelWalk()
+         *
+         * The calling thread walks the tree down to the split depth. The trees at that depth are
+         * the tasks. The workers take the tasks one by one, so that few big subtrees don't leave
+         * the other threads idle. Each worker has its own repository handle and thus its own
+         * object cache.
+         *
+         * In the ordered mode, the workers record their subtrees and the calling thread replays
+         * everything in the order that Tree::walk() would use. A subtree is replayed as soon as it
+         * and all tasks before it are done, and its recording is dropped right after that. The
+         * workers don't take tasks further ahead of the replay than a few per thread, so only
+         * that many subtrees are held in memory at a time. If no worker took the next task yet,
+         * the calling thread runs it by itself.
+         *
+         * In the unordered mode, the workers call the visitor themselves.
+         */
+        class ParallelTreeWalker : public TreeVisitor
+        {
+        private:
+            struct Task
+            {
+                Task() : record(-1), done(false) {}
+
+                int             record;
+                bool            done;
+                TreeRecorder    recorder;
+            };
+
+            struct Open
+            {
+                const TreeRecorder* recorder;
+                int                 index;
+                int                 depth;
+            };
+
+            class SharedStop;
+
+        public:
+            ParallelTreeWalker(RepositoryPrivate* repo, TreeVisitor* visitor,
+                               TreeWalkOrder order, TreeWalkFlags flags, int splitDepth);
+
+        public:
+            bool walk(Result& result, const git_tree* tree);
+
+        private:
+            Action visit(const Entry& entry);
+
+            bool runTasks(Result& result);
+            bool runTask(Result& result, git_repository* repo, Task& task,
+                         TreeVisitor* sharedVisitor);
+
+            int claim();
+            bool await(Result& result, git_repository* repo, int task);
+            void finished(int task, bool ok);
+            void stop();
+
+            bool replayPlan();
+            bool replayTasks(Result& result, git_repository* repo);
+            bool replayEntry(const TreeRecorder& recorder, int index);
+            bool closeTrees(int depth);
+            bool report(const TreeRecorder& recorder, int index);
+
+        private:
+            RepositoryPrivate*          mRepo;
+            TreeVisitor*                mVisitor;
+            TreeWalkOrder               mOrder;
+            TreeWalkFlags               mFlags;
+            int                         mSplitDepth;
+            bool                        mUnordered;
+
+            TreeRecorder                mPlan;
+            std::vector<Task>           mTasks;
+            QAtomicInt                  mStop;
+
+            // Hand out of the tasks and progress of the replay
+            QMutex                      mMutex;
+            QWaitCondition              mChanged;
+            int                         mNext;
+            int                         mReplayed;
+            int                         mAhead;
+
+            QVector<Open>               mOpen;
+            int                         mSkipDepth;
+        };
+
+    }
+
+}
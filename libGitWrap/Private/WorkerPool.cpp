@@ -0,0 +1,177 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QThreadStorage>
+
+#include "libGitWrap/Private/WorkerPool.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        Q_GLOBAL_STATIC(QThreadPool, sWorkerPool)
+
+        // Set for the threads of the pool while they execute a chunk
+        static QThreadStorage<bool> sInWorker;
+
+        namespace
+        {
+
+            class WorkerPoolTask : public QRunnable
+            {
+            public:
+                WorkerPoolTask(const WorkerPool::Job& job, int chunk, int begin, int end,
+                               QSemaphore& done)
+                    : mJob(job)
+                    , mChunk(chunk)
+                    , mBegin(begin)
+                    , mEnd(end)
+                    , mDone(done)
+                {
+                    setAutoDelete(true);
+                }
+
+            public:
+                void run()
+                {
+                    sInWorker.setLocalData(true);
+                    mJob(mChunk, mBegin, mEnd);
+                    sInWorker.setLocalData(false);
+                    mDone.release();
+                }
+
+            private:
+                const WorkerPool::Job&  mJob;
+                int                     mChunk;
+                int                     mBegin;
+                int                     mEnd;
+                QSemaphore&             mDone;
+            };
+
+            class WorkerPoolAsyncTask : public QRunnable
+            {
+            public:
+                WorkerPoolAsyncTask(const WorkerPool::Task& task)
+                    : mTask(task)
+                {
+                    setAutoDelete(true);
+                }
+
+            public:
+                void run()
+                {
+                    sInWorker.setLocalData(true);
+                    mTask();
+                    sInWorker.setLocalData(false);
+                }
+
+            private:
+                WorkerPool::Task        mTask;
+            };
+
+        }
+
+        QThreadPool* WorkerPool::pool()
+        {
+            return sWorkerPool();
+        }
+
+        /**
+         * @internal
+         * @brief       Calculate the number of chunks to split a job into
+         *
+         * @param[in]   count       Number of items to process
+         *
+         * @param[in]   minPerChunk Minimum number of items that make it worth to start another
+         *                          thread.
+         *
+         * @return      The number of chunks, at least 1 and at most the number of threads in the
+         *              pool plus the calling thread.
+         */
+        int WorkerPool::chunksFor(int count, int minPerChunk)
+        {
+            int maxChunks = pool()->maxThreadCount() + 1;
+            int chunks = count / qMax(1, minPerChunk);
+            return qBound(1, chunks, maxChunks);
+        }
+
+        /**
+         * @internal
+         * @brief       Run a job in parallel
+         *
+         * @param[in]   chunks  Number of chunks to split the items into; see chunksFor().
+         *
+         * @param[in]   count   Number of items to process.
+         *
+         * @param[in]   job     The function to call for each chunk. It is called with the index
+         *                      of the chunk and the half open range `[begin, end)` of items. The
+         *                      chunks are contiguous and ordered by their index.
+         *
+         * If this is called from inside of a job, all chunks are run on the calling thread. The
+         * pool's threads might all be waiting for their nested jobs otherwise.
+         */
+        void WorkerPool::run(int chunks, int count, const Job& job)
+        {
+            chunks = qBound(1, chunks, qMax(1, count));
+
+            bool nested = sInWorker.hasLocalData() && sInWorker.localData();
+            int per = count / chunks;
+            int extra = count % chunks;
+            int firstEnd = per + (extra ? 1 : 0);
+            int begin = firstEnd;
+            int started = 0;
+            QSemaphore done;
+
+            for (int i = 1; i < chunks; ++i) {
+                int end = begin + per + (i < extra ? 1 : 0);
+
+                if (nested) {
+                    job(i, begin, end);
+                }
+                else {
+                    pool()->start(new WorkerPoolTask(job, i, begin, end, done));
+                    started++;
+                }
+
+                begin = end;
+            }
+
+            job(0, 0, firstEnd);
+            done.acquire(started);
+        }
+
+        /**
+         * @internal
+         * @brief       Run a task in the background
+         *
+         * @param[in]   task    The function to call on one of the pool's threads. It is copied.
+         *
+         * Unlike run(), this returns immediately. Jobs that the task runs are run on the task's
+         * thread only.
+         */
+        void WorkerPool::start(const Task& task)
+        {
+            pool()->start(new WorkerPoolAsyncTask(task));
+        }
+
+    }
+
+}
@@ -0,0 +1,62 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <functional>
+
+#include "libGitWrap/Private/GitWrapPrivate.hpp"
+
+class QThreadPool;
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        /**
+         * @internal
+         * @ingroup     GitWrap
+         * @brief       Runs chunks of work in parallel on GitWrap's own thread pool
+         *
+         * GitWrap does not use QThreadPool::globalInstance() because the application might keep
+         * it busy; a blocking call into GitWrap would then dead lock or at least serialize.
+         *
+         * The first chunk of a job always runs on the calling thread. run() returns after all
+         * chunks are done.
+         *
+         * start() queues a task that runs in the background; the caller has to synchronize with
+         * it by itself.
+         */
+        class WorkerPool
+        {
+        public:
+            typedef std::function<void(int chunk, int begin, int end)> Job;
+            typedef std::function<void()> Task;
+
+        public:
+            static int chunksFor(int count, int minPerChunk);
+            static void run(int chunks, int count, const Job& job);
+            static void start(const Task& task);
+
+        private:
+            static QThreadPool* pool();
+        };
+
+    }
+
+}
@@ -31,8 +31,10 @@ namespace Git
 
         //-- RefLogEntryPrivate -->8
 
-        RefLogEntryPrivate::RefLogEntryPrivate(const git_reflog_entry* entry)
-            : mEntry( entry )
+        RefLogEntryPrivate::RefLogEntryPrivate(RepositoryPrivate* repo,
+                                               const git_reflog_entry* entry)
+            : mRepo( repo )
+            , mEntry( entry )
         {
         }
 
@@ -65,7 +67,7 @@ namespace Git
     {
         GW_CD(RefLogEntry);
         const git_signature * sig = git_reflog_entry_committer( d->mEntry );
-        return Internal::git2Signature( sig );
+        return Internal::git2Signature( sig, d->mRepo.data() );
     }
 
     QString RefLogEntry::message() const
@@ -106,7 +108,7 @@ namespace Git
         const git_reflog_entry *entry = git_reflog_entry_byindex( d->reflog, index);
         Q_ASSERT( entry );
 
-        return new RefLogEntry::Private(entry);
+        return new RefLogEntry::Private(d->repo(), entry);
     }
 
     void RefLog::append(Git::Result& result, const Git::ObjectId& oid, const Git::Signature& committer, const QString& message)
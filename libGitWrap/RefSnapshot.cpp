@@ -0,0 +1,510 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include <QDirIterator>
+
+#include "libGitWrap/RefSnapshot.hpp"
+#include "libGitWrap/Repository.hpp"
+
+#include "libGitWrap/Private/FileStamp.hpp"
+#include "libGitWrap/Private/RefSnapshotPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        RefSnapshotPrivate::RefSnapshotPrivate(RepositoryPrivate* repo)
+            : RepoObjectPrivate(repo)
+        {
+        }
+
+        RefSnapshotPrivate::~RefSnapshotPrivate()
+        {
+        }
+
+        const char* RefSnapshotPrivate::nameAt(int index) const
+        {
+            return mArena.constData() + mNames.at(index);
+        }
+
+        /**
+         * @internal
+         * @brief       Collect the time stamps of everything that a reference update touches
+         *
+         * Git updates references by renaming a lock file into place. This modifies the directory
+         * that contains the reference. So, we need the `refs` directory and all of its sub
+         * directories, the `packed-refs` file and the git directory itself (for `HEAD`).
+         */
+        void RefSnapshotPrivate::collectStamps(QHash<QString, qint64>& stamps) const
+        {
+            QString gitDir = GW_StringToQt(git_repository_path(mRepo->mRepo));
+            QString refsDir = gitDir + QStringLiteral("refs");
+            qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+            stamps.insert(gitDir, FileStamp::stampFor(FileStamp::modificationTime(gitDir), now));
+            stamps.insert(gitDir + QStringLiteral("packed-refs"),
+                          FileStamp::stampFor(FileStamp::modificationTime(
+                                                  gitDir + QStringLiteral("packed-refs")), now));
+            stamps.insert(refsDir, FileStamp::stampFor(FileStamp::modificationTime(refsDir), now));
+
+            QDirIterator it(refsDir, QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden,
+                            QDirIterator::Subdirectories);
+
+            while (it.hasNext()) {
+                it.next();
+                stamps.insert(it.filePath(), FileStamp::stampFor(
+                                  it.fileInfo().lastModified().toMSecsSinceEpoch(), now));
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Compare freshly collected @a stamps to the ones of the last read
+         *
+         * A directory that was "racily clean" at the last read has to be looked at again, even if
+         * its stamp still is the same.
+         */
+        bool RefSnapshotPrivate::isStale(const QHash<QString, qint64>& stamps) const
+        {
+            if (stamps != mStamps) {
+                return true;
+            }
+
+            foreach (qint64 stamp, mStamps) {
+                if (stamp == FileStamp::NeverScanned) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        int RefSnapshotPrivate::internSymbolic(const char* name)
+        {
+            QByteArray key = QByteArray::fromRawData(name, int(strlen(name)));
+            QHash<QByteArray, int>::const_iterator it = mSymbolicIndex.constFind(key);
+
+            if (it != mSymbolicIndex.constEnd()) {
+                return it.value();
+            }
+
+            int offset = mArena.size();
+            mArena.append(name, key.size() + 1);
+            mSymbolicIndex.insert(QByteArray(name, key.size()), offset);
+            return offset;
+        }
+
+        /**
+         * @internal
+         * @brief       Find the object that a target finally points to
+         *
+         * Only annotated tags have to be looked up. For anything else, the object header is
+         * enough to know that there is nothing to peel.
+         *
+         * @return      `true` if @a target is an annotated tag.
+         */
+        bool RefSnapshotPrivate::peel(git_odb* odb, const ObjectId& target, ObjectId& peeled)
+        {
+            if (const ObjectId* cached = mPeelCache.find(target)) {
+                peeled = *cached;
+                return peeled != target;
+            }
+
+            size_t len;
+            git_otype type;
+
+            if (git_odb_read_header(&len, &type, odb, ObjectId2git(target)) < 0) {
+                // A broken reference; there is nothing to peel.
+                giterr_clear();
+                peeled = ObjectId();
+                return false;
+            }
+
+            peeled = target;
+
+            if (type == GIT_OBJ_TAG) {
+                git_tag* tag = nullptr;
+                git_object* obj = nullptr;
+
+                if (!git_tag_lookup(&tag, mRepo->mRepo, ObjectId2git(target)) &&
+                        !git_tag_peel(&obj, tag)) {
+                    peeled = BasePrivate::oid2sha(git_object_id(obj));
+                }
+                else {
+                    giterr_clear();
+                }
+
+                git_object_free(obj);
+                git_tag_free(tag);
+            }
+
+            mPeelCache.insert(target, peeled);
+            return type == GIT_OBJ_TAG;
+        }
+
+        void RefSnapshotPrivate::sortByName()
+        {
+            const char* arena = mArena.constData();
+            const QVector<int>& names = mNames;
+
+            QVector<int> order(mNames.count());
+            for (int i = 0; i < order.count(); ++i) {
+                order[i] = i;
+            }
+
+            std::sort(order.begin(), order.end(), [arena, &names](int a, int b) {
+                return strcmp(arena + names[a], arena + names[b]) < 0;
+            });
+
+            QVector<int> sortedNames(order.count());
+            QVector<int> sortedSymbolic(order.count());
+            QVector<quint8> sortedFlags(order.count());
+            ObjectIdList sortedTargets(order.count());
+            ObjectIdList sortedPeeled(order.count());
+
+            for (int i = 0; i < order.count(); ++i) {
+                int j = order[i];
+                sortedNames[i]      = mNames[j];
+                sortedSymbolic[i]   = mSymbolic[j];
+                sortedFlags[i]      = mFlags[j];
+                sortedTargets[i]    = mTargets[j];
+                sortedPeeled[i]     = mPeeled[j];
+            }
+
+            mNames      = sortedNames;
+            mSymbolic   = sortedSymbolic;
+            mFlags      = sortedFlags;
+            mTargets    = sortedTargets;
+            mPeeled     = sortedPeeled;
+        }
+
+        /**
+         * @internal
+         * @brief           (Re-)read all references
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       stamps  The stamps as collected by collectStamps() _before_ reading. A
+         *                          change while we're reading will then be seen by the next
+         *                          refresh.
+         *
+         * @return          `true` on success.
+         */
+        bool RefSnapshotPrivate::read(Result& result, const QHash<QString, qint64>& stamps)
+        {
+            GW_CHECK_RESULT(result, false);
+
+            git_odb* odb = nullptr;
+            result = git_repository_odb(&odb, mRepo->mRepo);
+            GW_CHECK_RESULT(result, false);
+
+            git_reference_iterator* it = nullptr;
+            result = git_reference_iterator_new(&it, mRepo->mRepo);
+            if (!result) {
+                git_odb_free(odb);
+                return false;
+            }
+
+            int capacity = qMax(mNames.count(), 64);
+
+            mArena.clear();
+            mArena.reserve(capacity * 32);
+            mSymbolicIndex.clear();
+            mNames.clear();
+            mNames.reserve(capacity);
+            mSymbolic.clear();
+            mSymbolic.reserve(capacity);
+            mFlags.clear();
+            mFlags.reserve(capacity);
+            mTargets.clear();
+            mTargets.reserve(capacity);
+            mPeeled.clear();
+            mPeeled.reserve(capacity);
+
+            // Only keep peel results that are still referenced
+            ObjectIdMap<ObjectId> oldCache;
+            std::swap(oldCache, mPeelCache);
+
+            git_reference* ref = nullptr;
+            int rc;
+
+            while ((rc = git_reference_next(&ref, it)) == 0) {
+                const char* name = git_reference_name(ref);
+                mNames.append(mArena.size());
+                mArena.append(name, int(strlen(name)) + 1);
+
+                quint8 flags = 0;
+                int symbolic = -1;
+                const git_oid* target = nullptr;
+                const git_oid* peeled = nullptr;
+                git_reference* resolved = nullptr;
+
+                if (git_reference_type(ref) == GIT_REF_SYMBOLIC) {
+                    flags |= IsSymbolic;
+                    symbolic = internSymbolic(git_reference_symbolic_target(ref));
+
+                    if (git_reference_resolve(&resolved, ref) == 0) {
+                        target = git_reference_target(resolved);
+                        peeled = git_reference_target_peel(resolved);
+                    }
+                    else {
+                        // i.e. an unborn branch
+                        giterr_clear();
+                    }
+                }
+                else {
+                    target = git_reference_target(ref);
+                    peeled = git_reference_target_peel(ref);
+                }
+
+                ObjectId targetId = target ? BasePrivate::oid2sha(target) : ObjectId();
+                ObjectId peeledId;
+
+                if (peeled) {
+                    // packed-refs knows it already
+                    peeledId = BasePrivate::oid2sha(peeled);
+                    flags |= IsAnnotatedTag;
+                    mPeelCache.insert(targetId, peeledId);
+                }
+                else if (target) {
+                    if (const ObjectId* cached = oldCache.find(targetId)) {
+                        mPeelCache.insert(targetId, *cached);
+                    }
+
+                    if (peel(odb, targetId, peeledId)) {
+                        flags |= IsAnnotatedTag;
+                    }
+                }
+
+                mSymbolic.append(symbolic);
+                mFlags.append(flags);
+                mTargets.append(targetId);
+                mPeeled.append(peeledId);
+
+                git_reference_free(resolved);
+                git_reference_free(ref);
+            }
+
+            git_reference_iterator_free(it);
+            git_odb_free(odb);
+
+            if (rc != GIT_ITEROVER) {
+                result = rc;
+                mStamps.clear();
+                return false;
+            }
+
+            sortByName();
+            mStamps = stamps;
+            return true;
+        }
+
+    }
+
+    GW_PRIVATE_IMPL(RefSnapshot, RepoObject)
+
+    /**
+     * @brief           Take a snapshot of all references of a repository
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       repo    The repository.
+     *
+     * @return          The snapshot or an invalid RefSnapshot on failure.
+     */
+    RefSnapshot RefSnapshot::create(Result& result, const Repository& repo)
+    {
+        GW_CHECK_RESULT(result, RefSnapshot());
+
+        if (!repo.isValid()) {
+            result.setInvalidObject();
+            return RefSnapshot();
+        }
+
+        Repository::Private* rp = Private::dataOf<Repository>(repo);
+        PrivatePtr ptr(new Private(rp));
+
+        QHash<QString, qint64> stamps;
+        ptr->collectStamps(stamps);
+
+        if (!ptr->read(result, stamps)) {
+            return RefSnapshot();
+        }
+
+        return ptr;
+    }
+
+    /**
+     * @brief           Bring this snapshot up to date
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          `true` if the references were re-read, `false` if nothing has changed
+     *                  (or on failure).
+     *
+     * The references are only re-read if the time stamps of the reference directories, the
+     * `packed-refs` file or the git directory have changed. Peeled targets of annotated tags
+     * are kept from the previous snapshot, as long as a reference still points to the tag.
+     */
+    bool RefSnapshot::refresh(Result& result)
+    {
+        GW_D_CHECKED(RefSnapshot, false, result);
+
+        QHash<QString, qint64> stamps;
+        d->collectStamps(stamps);
+
+        if (!d->isStale(stamps)) {
+            return false;
+        }
+
+        return d->read(result, stamps);
+    }
+
+    /**
+     * @brief       Get the number of references in this snapshot
+     */
+    int RefSnapshot::count() const
+    {
+        GW_CD(RefSnapshot);
+        return d ? d->mNames.count() : 0;
+    }
+
+    /**
+     * @brief       Find a reference by its full name
+     *
+     * @param[in]   name    The full name of the reference, i.e. `refs/heads/master`.
+     *
+     * @return      The index of the reference or -1 if it is not in this snapshot.
+     */
+    int RefSnapshot::indexOf(const QString& name) const
+    {
+        GW_CD(RefSnapshot);
+        if (!d) {
+            return -1;
+        }
+
+        QByteArray utf8 = name.toUtf8();
+        int lo = 0;
+        int hi = d->mNames.count();
+
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            int cmp = strcmp(d->nameAt(mid), utf8.constData());
+
+            if (!cmp) {
+                return mid;
+            }
+
+            if (cmp < 0) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+
+        return -1;
+    }
+
+    QString RefSnapshot::name(int index) const
+    {
+        GW_CD(RefSnapshot);
+        return d ? GW_StringToQt(d->nameAt(index)) : QString();
+    }
+
+    bool RefSnapshot::isSymbolic(int index) const
+    {
+        GW_CD(RefSnapshot);
+        return d && (d->mFlags.at(index) & Private::IsSymbolic);
+    }
+
+    /**
+     * @brief       Get the name of the reference that a symbolic reference points to
+     *
+     * @return      The name or an empty string if the reference is not symbolic.
+     */
+    QString RefSnapshot::symbolicTarget(int index) const
+    {
+        GW_CD(RefSnapshot);
+        if (!d || d->mSymbolic.at(index) == -1) {
+            return QString();
+        }
+
+        return GW_StringToQt(d->mArena.constData() + d->mSymbolic.at(index));
+    }
+
+    /**
+     * @brief       Get the object id that a reference finally resolves to
+     *
+     * @return      The id or a null id if the reference cannot be resolved, i.e. a symbolic
+     *              reference to an unborn branch or to a reference that doesn't exist anymore.
+     */
+    ObjectId RefSnapshot::target(int index) const
+    {
+        GW_CD(RefSnapshot);
+        return d ? d->mTargets.at(index) : ObjectId();
+    }
+
+    /**
+     * @brief       Get the peeled target of a reference
+     *
+     * @return      If the reference points to an annotated tag, the id of the object that the tag
+     *              finally points to. Otherwise the same as target().
+     *
+     *              A null id if target() is null or if the target object is missing from the
+     *              repository. This is not an error: such references are listed by `git` as
+     *              well, they just cannot be peeled.
+     */
+    ObjectId RefSnapshot::peeledTarget(int index) const
+    {
+        GW_CD(RefSnapshot);
+        return d ? d->mPeeled.at(index) : ObjectId();
+    }
+
+    bool RefSnapshot::isAnnotatedTag(int index) const
+    {
+        GW_CD(RefSnapshot);
+        return d && (d->mFlags.at(index) & Private::IsAnnotatedTag);
+    }
+
+    /**
+     * @brief       Convert this snapshot into a hash of reference names and their targets
+     *
+     * References that cannot be resolved are left out.
+     */
+    QHash<QString, ObjectId> RefSnapshot::toResolvedRefs() const
+    {
+        GW_CD(RefSnapshot);
+        QHash<QString, ObjectId> refs;
+
+        if (d) {
+            refs.reserve(d->mNames.count());
+
+            for (int i = 0; i < d->mNames.count(); ++i) {
+                if (!d->mTargets.at(i).isNull()) {
+                    refs.insert(GW_StringToQt(d->nameAt(i)), d->mTargets.at(i));
+                }
+            }
+        }
+
+        return refs;
+    }
+
+}
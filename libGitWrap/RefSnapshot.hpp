@@ -0,0 +1,79 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/RepoObject.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+        class RefSnapshotPrivate;
+    }
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       A read only snapshot of all references of a repository
+     *
+     * The snapshot is built in a single pass over all references. For each reference it
+     * carries:
+     * - the name,
+     * - the target, i.e. the object id that the reference finally resolves to,
+     * - the symbolic target, if the reference is symbolic, and
+     * - the peeled target: If the target is an annotated tag, this is the object that the tag
+     *   (chain) finally points to; otherwise it is the same as the target.
+     *
+     * A reference that cannot be resolved is part of the snapshot all the same. This is a
+     * symbolic reference to an unborn branch or to a reference that was deleted, or a reference
+     * to an object that is missing. Its target() (for a symbolic one) and its peeledTarget() are
+     * null ids then; refresh() and create() don't report this as an error.
+     *
+     * References are sorted by their name. All data is kept in a few flat arrays; the names are
+     * stored in one UTF-8 arena.
+     *
+     * Use refresh() to bring the snapshot up to date. It only re-reads the references if any
+     * of the reference directories or the `packed-refs` file has changed since the snapshot was
+     * taken.
+     */
+    class GITWRAP_API RefSnapshot : public RepoObject
+    {
+        GW_PRIVATE_DECL(RefSnapshot, RepoObject, public)
+
+    public:
+        static RefSnapshot create(Result& result, const Repository& repo);
+
+    public:
+        bool refresh(Result& result);
+
+        int count() const;
+        int indexOf(const QString& name) const;
+
+        QString name(int index) const;
+        bool isSymbolic(int index) const;
+        QString symbolicTarget(int index) const;
+        ObjectId target(int index) const;
+        ObjectId peeledTarget(int index) const;
+        bool isAnnotatedTag(int index) const;
+
+        QHash<QString, ObjectId> toResolvedRefs() const;
+    };
+
+}
+
+Q_DECLARE_METATYPE(Git::RefSnapshot)
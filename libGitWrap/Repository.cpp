@@ -14,6 +14,9 @@
  *
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include <QStringBuilder>
 
 #include "libGitWrap/Result.hpp"
@@ -29,6 +32,8 @@
 #include "libGitWrap/Blob.hpp"
 #include "libGitWrap/Commit.hpp"
 #include "libGitWrap/RevisionWalker.hpp"
+#include "libGitWrap/StatusConsumer.hpp"
+#include "libGitWrap/StatusOptions.hpp"
 #include "libGitWrap/Submodule.hpp"
 #include "libGitWrap/BranchRef.hpp"
 #include "libGitWrap/TagRef.hpp"
@@ -36,7 +41,10 @@
 
 #include "libGitWrap/Operations/CommitOperation.hpp"
 
+#include "libGitWrap/Private/CommitInfoLoader.hpp"
+#include "libGitWrap/Private/DivergenceWalker.hpp"
 #include "libGitWrap/Private/IndexPrivate.hpp"
+#include "libGitWrap/Private/ObjectIdIndex.hpp"
 #include "libGitWrap/Private/RemotePrivate.hpp"
 #include "libGitWrap/Private/RepositoryPrivate.hpp"
 #include "libGitWrap/Private/ReferencePrivate.hpp"
@@ -44,6 +52,7 @@
 #include "libGitWrap/Private/ObjectPrivate.hpp"
 #include "libGitWrap/Private/SubmodulePrivate.hpp"
 #include "libGitWrap/Private/RevisionWalkerPrivate.hpp"
+#include "libGitWrap/Private/WorkerPool.hpp"
 
 #include <QDir>
 
@@ -70,6 +79,7 @@ namespace Git
         RepositoryPrivate::RepositoryPrivate( git_repository* repo )
             : mRepo(repo)
             , mIndex(nullptr)
+            , mPrefetcher(this)
         {
         }
 
@@ -95,6 +105,13 @@ namespace Git
             // because outer constraints - like the above - prohibited the race to happen.
             Q_ASSERT( !mIndex );
 
+            // The prefetch workers use mObjects for their budget.
+            mPrefetcher.cancel();
+            mPrefetcher.waitForDone();
+
+            // The cache retains git_objects which must go before the repository does.
+            mObjects.clear();
+
             git_repository_free( mRepo );
         }
 
@@ -119,16 +136,156 @@ namespace Git
             return new Reference::Private(me, refHead);
         }
 
-        static int statusHashCB( const char* fn, unsigned int status, void* rawSH )
+        /**
+         * @internal
+         * @brief           Open another libgit2 handle to this repository
+         *
+         * Worker threads use this to get a handle that they don't have to share. The handle has
+         * its own object cache.
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @return          The new handle, which must be freed with git_repository_free(); or
+         *                  `nullptr` on failure.
+         */
+        git_repository* RepositoryPrivate::openHandle(Result& result) const
         {
-            #if 0
-            qDebug( "%s - %s", qPrintable( QString::number( status, 2 ) ), fn );
-            #endif
+            GW_CHECK_RESULT( result, nullptr );
 
-            Git::StatusHash* sh = (Git::StatusHash*) rawSH;
-            sh->insert( GW_StringToQt( fn ), convertFileStatus( status ) );
+            git_repository* repo = nullptr;
+            result = git_repository_open(&repo, git_repository_path(mRepo));
+            GW_CHECK_RESULT( result, nullptr );
 
-            return GIT_OK;
+            return repo;
+        }
+
+        /**
+         * @internal
+         * @brief       StatusConsumer that collects everything into a StatusHash
+         */
+        class StatusHashConsumer : public StatusConsumer
+        {
+        public:
+            bool fileStatus(const QString& path, StatusFlags status)
+            {
+                mHash.insert( path, status );
+                return true;
+            }
+
+            const StatusHash& hash() const
+            {
+                return mHash;
+            }
+
+        private:
+            StatusHash mHash;
+        };
+
+        static void fillStatusOptions( git_status_options& opt, const StatusOptions& opts )
+        {
+            switch (opts.show()) {
+            case StatusOptions::ShowIndexOnly:
+                opt.show = GIT_STATUS_SHOW_INDEX_ONLY;
+                break;
+
+            case StatusOptions::ShowWorkingTreeOnly:
+                opt.show = GIT_STATUS_SHOW_WORKDIR_ONLY;
+                break;
+
+            default:
+                opt.show = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+                break;
+            }
+
+            opt.flags = 0;
+
+            switch (opts.untrackedMode()) {
+            case StatusOptions::UntrackedAll:
+                opt.flags |= GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+                // fall through
+            case StatusOptions::UntrackedNormal:
+                opt.flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED;
+                break;
+
+            default:
+                break;
+            }
+
+            if (opts.includeIgnored()) {
+                opt.flags |= GIT_STATUS_OPT_INCLUDE_IGNORED;
+                if (opts.recurseIgnoredDirs()) {
+                    opt.flags |= GIT_STATUS_OPT_RECURSE_IGNORED_DIRS;
+                }
+            }
+
+            if (opts.includeUnmodified()) {
+                opt.flags |= GIT_STATUS_OPT_INCLUDE_UNMODIFIED;
+            }
+
+            if (opts.excludeSubmodules()) {
+                opt.flags |= GIT_STATUS_OPT_EXCLUDE_SUBMODULES;
+            }
+
+            if (opts.pathSpecIsLiteral()) {
+                opt.flags |= GIT_STATUS_OPT_DISABLE_PATHSPEC_MATCH;
+            }
+
+            if (opts.renameDetection() & StatusOptions::RenamesHeadToIndex) {
+                opt.flags |= GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX;
+            }
+
+            if (opts.renameDetection() & StatusOptions::RenamesIndexToWorkingTree) {
+                opt.flags |= GIT_STATUS_OPT_RENAMES_INDEX_TO_WORKDIR;
+            }
+        }
+
+        static int statusConsumerCB( const char* fn, unsigned int status, void* rawSC )
+        {
+            StatusConsumer* sc = static_cast< StatusConsumer* >( rawSC );
+
+            if (sc->fileStatus( GW_StringToQt( fn ), convertFileStatus( status ) )) {
+                return GIT_OK;
+            }
+
+            return GIT_EUSER;
+        }
+
+        /**
+         * @internal
+         * @brief       Feed a git_status_list into a StatusConsumer
+         *
+         * Only used when renames shall be detected; git_status_foreach_ext() cannot report them.
+         *
+         * @return      `true` if the consumer wants more entries
+         */
+        static bool feedStatusList( git_status_list* list, StatusConsumer* sc )
+        {
+            size_t count = git_status_list_entrycount( list );
+
+            for (size_t i = 0; i < count; ++i) {
+                const git_status_entry* e = git_status_byindex( list, i );
+                const git_diff_delta* h2i = e->head_to_index;
+                const git_diff_delta* i2w = e->index_to_workdir;
+                StatusFlags flags = convertFileStatus( e->status );
+
+                if (e->status & (GIT_STATUS_INDEX_RENAMED | GIT_STATUS_WT_RENAMED)) {
+                    const char* oldPath = h2i ? h2i->old_file.path : i2w->old_file.path;
+                    const char* newPath = i2w ? i2w->new_file.path : h2i->new_file.path;
+
+                    if (!sc->fileRenamed( GW_StringToQt( oldPath ), GW_StringToQt( newPath ),
+                                          flags )) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                const char* path = h2i ? h2i->old_file.path : i2w->old_file.path;
+                if (!sc->fileStatus( GW_StringToQt( path ), flags )) {
+                    return false;
+                }
+            }
+
+            return true;
         }
 
         struct cb_append_reference_data
@@ -159,10 +316,383 @@ namespace Git
             return 0;
         }
 
+        static bool peelToId(Result& result, git_reference* ref, ObjectId& id)
+        {
+            git_reference* resolved = nullptr;
+
+            result = git_reference_resolve(&resolved, ref);
+            GW_CHECK_RESULT(result, false);
+
+            id = ObjectId::fromRaw(git_reference_target(resolved)->id);
+            git_reference_free(resolved);
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       List all local branches, along with their upstreams if wanted
+         */
+        static bool localBranches(Result& result, git_repository* repo, bool withUpstream,
+                                  BranchDivergenceList& branches)
+        {
+            git_branch_iterator* it = nullptr;
+            result = git_branch_iterator_new(&it, repo, GIT_BRANCH_LOCAL);
+            GW_CHECK_RESULT(result, false);
+
+            git_reference* ref = nullptr;
+            git_branch_t type;
+            int rc;
+
+            while ((rc = git_branch_next(&ref, &type, it)) == GIT_OK) {
+                BranchDivergence bd;
+                bd.branch = GW_StringToQt(git_reference_name(ref));
+
+                if (!peelToId(result, ref, bd.local)) {
+                    git_reference_free(ref);
+                    break;
+                }
+
+                if (withUpstream) {
+                    git_reference* upstream = nullptr;
+                    if (git_branch_upstream(&upstream, ref) == GIT_OK) {
+                        bd.upstream = GW_StringToQt(git_reference_name(upstream));
+                        if (!peelToId(result, upstream, bd.other)) {
+                            git_reference_free(upstream);
+                            git_reference_free(ref);
+                            break;
+                        }
+                        git_reference_free(upstream);
+                    }
+                    else {
+                        // No upstream configured or the upstream branch does not exist.
+                        giterr_clear();
+                    }
+                }
+
+                git_reference_free(ref);
+                branches.append(bd);
+            }
+
+            git_branch_iterator_free(it);
+
+            if (result && rc != GIT_ITEROVER) {
+                result = rc;
+            }
+
+            return result;
+        }
+
+        /**
+         * @internal
+         * @brief       Depth first search for an ancestor, using the commit-graph
+         *
+         * The graph is closed under ancestry. So, if @a ancestor is not in the graph, no commit
+         * in the graph can reach it. If it is, only commits with a higher generation number can
+         * reach it.
+         */
+        static bool isAncestorInGraph(Result& result, git_repository* repo,
+                                      const CommitGraph& graph,
+                                      const ObjectId& ancestor, const ObjectId& descendant)
+        {
+            const int target = graph.find(ancestor);
+            if (target == -1 && graph.find(descendant) != -1) {
+                return false;
+            }
+
+            const quint32 minGeneration = target == -1 ? quint32(CommitGraph::GenerationZero)
+                                                       : graph.generation(target);
+            std::vector<bool> seen;
+            QVector<int> positions;
+
+            // Commits newer than the graph
+            ObjectIdSet seenIds;
+            ObjectIdList ids;
+            ids.append(descendant);
+
+            while (!ids.isEmpty() || !positions.isEmpty()) {
+                if (!ids.isEmpty()) {
+                    ObjectId id = ids.takeLast();
+                    int pos = graph.find(id);
+
+                    if (pos == -1) {
+                        git_commit* commit = nullptr;
+                        result = git_commit_lookup(&commit, repo, ObjectId2git(id));
+                        GW_CHECK_RESULT(result, false);
+
+                        unsigned int n = git_commit_parentcount(commit);
+                        for (unsigned int i = 0; i < n; ++i) {
+                            ObjectId parent = BasePrivate::oid2sha(git_commit_parent_id(commit, i));
+                            if (parent == ancestor) {
+                                git_commit_free(commit);
+                                return true;
+                            }
+                            if (seenIds.insert(parent)) {
+                                ids.append(parent);
+                            }
+                        }
+
+                        git_commit_free(commit);
+                        continue;
+                    }
+
+                    if (target == -1) {
+                        continue;
+                    }
+
+                    if (seen.empty()) {
+                        seen.resize(size_t(graph.count()), false);
+                    }
+                    if (!seen[pos]) {
+                        seen[pos] = true;
+                        positions.append(pos);
+                    }
+                    continue;
+                }
+
+                int pos = positions.takeLast();
+                CommitGraph::Parents parents;
+                if (!graph.parents(pos, parents)) {
+                    result.setError("The commit-graph file is corrupt.", GIT_ERROR);
+                    return false;
+                }
+
+                for (int i = 0; i < parents.count(); ++i) {
+                    int parent = parents[i];
+                    if (parent == target) {
+                        return true;
+                    }
+
+                    quint32 generation = graph.generation(parent);
+                    if (minGeneration != CommitGraph::GenerationZero &&
+                            generation != CommitGraph::GenerationZero &&
+                            generation <= minGeneration) {
+                        continue;
+                    }
+
+                    if (!seen[parent]) {
+                        seen[parent] = true;
+                        positions.append(parent);
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        static void computeDivergence(Result& result, RepositoryPrivate* d,
+                                      BranchDivergenceList& branches)
+        {
+            CommitGraph::Ptr graph = d->mCommitGraph.graph(d->mRepo);
+
+            DivergenceWalker walker(d->mRepo, graph.data());
+            QVector<int> pairs(branches.count(), -1);
+
+            for (int i = 0; i < branches.count(); ++i) {
+                if (!branches.at(i).other.isNull()) {
+                    pairs[i] = walker.addPair(branches.at(i).local, branches.at(i).other);
+                }
+            }
+
+            if (!walker.run(result)) {
+                return;
+            }
+
+            for (int i = 0; i < branches.count(); ++i) {
+                if (pairs.at(i) != -1) {
+                    branches[i].ahead = walker.ahead(pairs.at(i));
+                    branches[i].behind = walker.behind(pairs.at(i));
+                }
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Add the commit that a reference leads to, unless it was added already
+         */
+        static bool addTip(Result& result, git_reference* ref, ObjectIdSet& seen,
+                           ObjectIdList& tips)
+        {
+            git_object* o = nullptr;
+            int rc = git_reference_peel(&o, ref, GIT_OBJ_COMMIT);
+            if (rc == GIT_ENOTFOUND || rc == GIT_EPEEL || rc == GIT_EINVALIDSPEC) {
+                // Like git_revwalk_push_glob(), skip references that don't lead to a commit
+                giterr_clear();
+                return true;
+            }
+
+            result = rc;
+            GW_CHECK_RESULT(result, false);
+
+            const ObjectId id = ObjectId::fromRaw(git_object_id(o)->id);
+            if (seen.insert(id)) {
+                tips.append(id);
+            }
+
+            git_object_free(o);
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Collect the commits that HEAD and all references point to
+         */
+        static bool refTips(Result& result, git_repository* repo, ObjectIdList& tips)
+        {
+            ObjectIdSet seen;
+            git_reference_iterator* it = nullptr;
+            git_reference* ref = nullptr;
+            int rc = 0;
+
+            result = git_reference_iterator_glob_new(&it, repo, "refs/*");
+            GW_CHECK_RESULT(result, false);
+
+            while (result && (rc = git_reference_next(&ref, it)) == GIT_OK) {
+                addTip(result, ref, seen, tips);
+                git_reference_free(ref);
+            }
+
+            git_reference_iterator_free(it);
+
+            if (result && rc != GIT_ITEROVER) {
+                result = rc;
+            }
+            GW_CHECK_RESULT(result, false);
+
+            rc = git_repository_head(&ref, repo);
+            if (rc == GIT_EUNBORNBRANCH || rc == GIT_ENOTFOUND) {
+                giterr_clear();
+                return true;
+            }
+
+            result = rc;
+            GW_CHECK_RESULT(result, false);
+
+            addTip(result, ref, seen, tips);
+            git_reference_free(ref);
+            return result;
+        }
+
+        // Below this number of ids per chunk, starting a thread costs more than it gains.
+        static const int sMinIdsPerChunk = 4096;
+
+        // Computing a commit's changed paths means diffing two trees; this is worth a thread early.
+        static const int sMinCommitsPerChunk = 64;
+
+        /**
+         * @internal
+         * @brief           Run an ODB query for many ids in parallel
+         *
+         * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+         *
+         * @param[in]       d       The repository to query.
+         *
+         * @param[in]       ids     The ids to query.
+         *
+         * @param[in]       query   Called as `int query(git_odb* odb, int index)` for every index
+         *                          into @a ids; returns a libgit2 error code. It is called from
+         *                          several threads at once, but never twice for the same index.
+         *
+         * The ids are handed out in sorted order, so each thread works on one contiguous range of
+         * every pack index instead of jumping across all of them. The first chunk uses the
+         * repository's own handle; all others open a private one.
+         */
+        template<class Query>
+        static void queryOdb(Result& result, RepositoryPrivate* d, const ObjectIdList& ids,
+                             const Query& query)
+        {
+            const ObjectId* idData = ids.constData();
+
+            QVector<int> order(ids.count());
+            for (int i = 0; i < order.count(); ++i) {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [idData](int a, int b) {
+                return std::memcmp(idData[a].raw(), idData[b].raw(), ObjectId::SHA1_Length) < 0;
+            });
+
+            int chunks = WorkerPool::chunksFor(ids.count(), sMinIdsPerChunk);
+            QVector<Result> results(chunks);
+
+            // Don't let the threads touch the containers; non-const access might detach them.
+            Result* chunkResults = results.data();
+            const int* orderData = order.constData();
+
+            WorkerPool::run(chunks, ids.count(), [&](int chunk, int begin, int end) {
+                Result& r = chunkResults[chunk];
+
+                git_repository* repo = d->mRepo;
+                if (chunk) {
+                    repo = d->openHandle(r);
+                    if (!r) {
+                        return;
+                    }
+                }
+
+                git_odb* odb = nullptr;
+                r = git_repository_odb(&odb, repo);
+
+                for (int i = begin; r && i < end; ++i) {
+                    r = query(odb, orderData[i]);
+                }
+
+                git_odb_free(odb);
+
+                if (chunk) {
+                    git_repository_free(repo);
+                }
+            });
+
+            for (int i = 0; i < chunks; ++i) {
+                if (!results.at(i)) {
+                    result = results.at(i);
+                    return;
+                }
+            }
+        }
+
     }
 
     GW_PRIVATE_IMPL(Repository, Base)
 
+    ObjectHeader::ObjectHeader()
+        : found(false)
+        , type(otAny)
+        , size(0)
+    {
+    }
+
+    ObjectCacheLimits::ObjectCacheLimits()
+        : maxMemory(32 * 1024 * 1024)
+        , maxPrefetchMemory(8 * 1024 * 1024)
+        , maxCommits(16384)
+        , maxTrees(8192)
+        , maxBlobs(256)
+        , maxTags(1024)
+    {
+    }
+
+    BranchDivergence::BranchDivergence()
+        : ahead(0)
+        , behind(0)
+    {
+    }
+
+    ObjectCacheStats::ObjectCacheStats()
+        : hits(0)
+        , revived(0)
+        , misses(0)
+        , evictions(0)
+        , prefetched(0)
+        , prefetchHits(0)
+        , memoryUsed(0)
+        , wrappers(0)
+        , commits(0)
+        , trees(0)
+        , blobs(0)
+        , tags(0)
+    {
+    }
+
     /**
      * @ingroup     GitWrap
      *
@@ -403,22 +933,89 @@ namespace Git
         return Internal::convertFileStatus( status );
     }
 
+    /**
+     * @brief           Get the status of every file in the working tree
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          A hash with an entry for every file, including unmodified and ignored
+     *                  ones.
+     *
+     * This is status(Result&, const StatusOptions&) with StatusOptions::allFiles(). To find out
+     * which files are dirty, use the default StatusOptions instead.
+     */
     StatusHash Repository::status(Result &result) const
     {
-        GW_CD_CHECKED(Repository, StatusHash(), result);
+        return status( result, StatusOptions::allFiles() );
+    }
+
+    /**
+     * @brief           Get the status of the files that match a set of options
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       opts    Options that define which files are reported
+     *
+     * @return          A hash with the path of each reported file and its status. If renames
+     *                  are detected, renamed files are listed with their new path.
+     */
+    StatusHash Repository::status(Result& result, const StatusOptions& opts) const
+    {
+        Internal::StatusHashConsumer sh;
+
+        status( result, opts, &sh );
+        GW_CHECK_RESULT( result, StatusHash() );
+
+        return sh.hash();
+    }
+
+    /**
+     * @brief           Stream the status of the files that match a set of options
+     *
+     * @param[in,out]   result      A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       opts        Options that define which files are reported
+     *
+     * @param[in]       consumer    Receives the files one by one. If it returns `false`, no
+     *                              further files are reported; this is not an error.
+     *
+     * Without rename detection, files are handed to the consumer while libgit2 walks the
+     * working tree and nothing is collected in between. Rename detection needs the complete list
+     * of changes, so libgit2 builds it first; it still only contains the reported files.
+     */
+    void Repository::status(Result& result, const StatusOptions& opts,
+                            StatusConsumer* consumer) const
+    {
+        GW_CD_CHECKED_VOID(Repository, result);
+
+        if (!consumer) {
+            result.setError("No StatusConsumer was given.", GIT_ERROR);
+            return;
+        }
 
         git_status_options opt = GIT_STATUS_OPTIONS_INIT;
+        Internal::fillStatusOptions( opt, opts );
 
-        opt.flags = GIT_STATUS_OPT_INCLUDE_UNTRACKED
-                  | GIT_STATUS_OPT_INCLUDE_IGNORED
-                  | GIT_STATUS_OPT_INCLUDE_UNMODIFIED
-                  | GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+        Internal::StrArray pathSpec( opts.pathSpec() );
+        git_strarray* pathSpecArr = pathSpec;
+        opt.pathspec = *pathSpecArr;
 
-        StatusHash sh;
-        result = git_status_foreach_ext( d->mRepo, &opt, &Internal::statusHashCB, (void*) &sh );
-        GW_CHECK_RESULT( result, StatusHash() );
+        if (opts.renameDetection() == StatusOptions::RenamesNone) {
+            Result tmp( git_status_foreach_ext( d->mRepo, &opt, &Internal::statusConsumerCB,
+                                                consumer ) );
+
+            if (!tmp && tmp.errorCode() != GIT_EUSER) {
+                result = tmp;
+            }
+            return;
+        }
+
+        git_status_list* list = nullptr;
+        result = git_status_list_new( &list, d->mRepo, &opt );
+        GW_CHECK_RESULT( result, void() );
 
-        return sh;
+        Internal::feedStatusList( list, consumer );
+        git_status_list_free( list );
     }
 
     /**
@@ -466,10 +1063,19 @@ namespace Git
         {
             cb_enum_resolvedrefs_data* d = (cb_enum_resolvedrefs_data*) payload;
 
-            git_oid oid;
-
             const char *refName = git_reference_name(ref);
-            int rc = git_reference_name_to_id( &oid, d->repo, refName );
+
+            // Only symbolic references need another lookup
+            if (git_reference_type(ref) == GIT_REF_OID) {
+                d->refs.insert( GW_StringToQt( refName ),
+                                ObjectId::fromRaw( git_reference_target(ref)->id ) );
+                git_reference_free(ref);
+                return 0;
+            }
+
+            git_reference* resolved = nullptr;
+            int rc = git_reference_resolve( &resolved, ref );
+            git_reference_free(ref);
 
             d->result->setError( rc );
             if( rc < 0 )
@@ -477,13 +1083,25 @@ namespace Git
                 return -1;
             }
 
-            d->refs.insert( GW_StringToQt( refName ), ObjectId::fromRaw( oid.id ) );
+            d->refs.insert( GW_StringToQt( refName ),
+                            ObjectId::fromRaw( git_reference_target(resolved)->id ) );
+            git_reference_free(resolved);
 
             return 0;
         }
 
     }
 
+    /**
+     * @brief           Get all references along with the object ids they resolve to
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          A hash of all reference names and their targets.
+     *
+     * For repeated queries on repositories with a large number of references, a RefSnapshot is
+     * the better choice.
+     */
     ResolvedRefs Repository::allResolvedRefs( Result& result )
     {
         GW_CD_CHECKED(Repository, ResolvedRefs(), result);
@@ -731,17 +1349,27 @@ namespace Git
         return refHead.target();
     }
 
+    /**
+     * @brief           Lookup an object in the repository
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       id      The id of the object to lookup
+     *
+     * @param[in]       ot      The expected type of the object. Use `otAny` to accept any type.
+     *
+     * @return          The object or an invalid Object, if it cannot be found or its type does not
+     *                  match @a ot.
+     *
+     * Lookups go through the repository's object cache: If a wrapper for @a id is still alive, it
+     * is shared. If the object has been looked up recently, it will still be parsed in memory.
+     *
+     * @see             objectCacheStats(), setObjectCacheLimits()
+     */
     Object Repository::lookup( Result& result, const ObjectId& id, ObjectType ot )
     {
         GW_D_CHECKED(Repository, Object(), result);
-
-        git_object* obj = nullptr;
-        git_otype gitObjType = Internal::objectType2git(ot);
-
-        result = git_object_lookup(&obj, d->mRepo, Private::sha(id), gitObjType);
-        GW_CHECK_RESULT( result, Object() );
-
-        return Object::Private::create(d, obj);
+        return d->mObjects.lookup(result, d, id, ot);
     }
 
     Commit Repository::lookupCommit(Result& result, const ObjectId& id)
@@ -789,6 +1417,347 @@ namespace Git
         return lookupTag(result, reference(result, refName).resolveToObjectId(result));
     }
 
+    /**
+     * @brief           Load the meta data of many commits at once
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       ids     The ids of the commits to load.
+     *
+     * @return          One CommitInfo record per id, in the same order as @a ids. If any of the ids
+     *                  cannot be found or is not a commit, an empty list is returned.
+     *
+     * This is meant for views that need author, committer, time, summary and parents of a large
+     * number of commits. No Commit or Signature objects are created and equal names and email
+     * addresses are stored only once.
+     *
+     * Large lists are decoded in parallel; each worker thread uses its own libgit2 repository
+     * handle. The object cache of this repository is not touched.
+     */
+    CommitInfoList Repository::commitInfos(Result& result, const ObjectIdList& ids) const
+    {
+        GW_CD_CHECKED(Repository, CommitInfoList(), result);
+
+        Internal::CommitInfoLoader loader(const_cast<Repository::Private*>(d));
+        return loader.load(result, ids);
+    }
+
+    /**
+     * @brief           Find out which objects are in the object database
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       ids     The ids to look for.
+     *
+     * @return          One bit per id, in the order of @a ids; set if the object exists. On
+     *                  failure, an empty array is returned.
+     *
+     * Neither are the objects read nor are they inflated. Large lists are split up among
+     * GitWrap's worker threads.
+     *
+     * @see             readHeaders()
+     */
+    QBitArray Repository::exists(Result& result, const ObjectIdList& ids) const
+    {
+        GW_CD_CHECKED(Repository, QBitArray(), result);
+
+        // QBitArray packs 8 ids into one byte; the threads can't set bits in it concurrently.
+        QVector<char> found(ids.count(), 0);
+        char* foundData = found.data();
+        const ObjectId* idData = ids.constData();
+
+        Internal::queryOdb(result, const_cast<Repository::Private*>(d), ids,
+                           [foundData, idData](git_odb* odb, int i) {
+            foundData[i] = git_odb_exists(odb, Internal::ObjectId2git(idData[i])) ? 1 : 0;
+            return 0;
+        });
+        GW_CHECK_RESULT(result, QBitArray());
+
+        QBitArray bits(ids.count());
+        for (int i = 0; i < found.count(); ++i) {
+            if (found.at(i)) {
+                bits.setBit(i);
+            }
+        }
+
+        return bits;
+    }
+
+    /**
+     * @brief           Read the type and size of many objects
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       ids     The ids of the objects.
+     *
+     * @return          One header per id, in the order of @a ids. Objects that do not exist are
+     *                  reported as not found; that is no error. On failure, an empty list is
+     *                  returned.
+     *
+     * Only the object headers are read: A loose object is inflated only as far as its header
+     * goes; for a deltified object in a pack file only the delta headers are read. Large lists are
+     * split up among GitWrap's worker threads.
+     *
+     * @see             exists()
+     */
+    ObjectHeaderList Repository::readHeaders(Result& result, const ObjectIdList& ids) const
+    {
+        GW_CD_CHECKED(Repository, ObjectHeaderList(), result);
+
+        ObjectHeaderList headers(ids.count());
+        ObjectHeader* out = headers.data();
+        const ObjectId* idData = ids.constData();
+
+        Internal::queryOdb(result, const_cast<Repository::Private*>(d), ids,
+                           [out, idData](git_odb* odb, int i) {
+            size_t size = 0;
+            git_otype type = GIT_OBJ_BAD;
+
+            int rc = git_odb_read_header(&size, &type, odb, Internal::ObjectId2git(idData[i]));
+            if (rc == GIT_ENOTFOUND) {
+                giterr_clear();
+                return 0;
+            }
+            if (rc < 0) {
+                return rc;
+            }
+
+            out[i].found = true;
+            out[i].type = Internal::gitotype2ObjectType(type);
+            out[i].size = qint64(size);
+            return 0;
+        });
+        GW_CHECK_RESULT(result, ObjectHeaderList());
+
+        return headers;
+    }
+
+    /**
+     * @brief           Resolve an abbreviated object id
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       prefix  At least 4 hex digits of an object id.
+     *
+     * @return          The full id of the only object whose id starts with @a prefix. If no
+     *                  or more than one object matches, an error is set (`GIT_ENOTFOUND` or
+     *                  `GIT_EAMBIGUOUS`) and a null id is returned.
+     *
+     * The lookup uses an in memory index of all object ids in this repository. See
+     * shortestUniqueAbbrev() for details.
+     */
+    ObjectId Repository::resolvePrefix(Result& result, const QString& prefix) const
+    {
+        GW_CD_CHECKED(Repository, ObjectId(), result);
+
+        QByteArray hex = prefix.trimmed().toLatin1();
+        if (hex.length() < GIT_OID_MINPREFIXLEN) {
+            // Like libgit2, treat a prefix that is too short as ambiguous
+            result.setError("An abbreviated id needs at least 4 hex digits.", GIT_EAMBIGUOUS);
+            return ObjectId();
+        }
+
+        if (hex.length() > ObjectId::SHA1_LengthHex) {
+            result.setError("An object id has no more than 40 hex digits.", GIT_EINVALIDSPEC);
+            return ObjectId();
+        }
+
+        bool ok = false;
+        ObjectId id = ObjectId::fromAscii(hex, hex.length(), &ok);
+        if (!ok) {
+            result.setError("Not a hex encoded object id.", GIT_ERROR);
+            return ObjectId();
+        }
+
+        Internal::RepositoryPrivate* p = const_cast<Internal::RepositoryPrivate*>(d);
+        QMutexLocker lock(&p->mIdIndex.mutex());
+
+        p->mIdIndex.refresh(result, d->mRepo);
+        GW_CHECK_RESULT(result, ObjectId());
+
+        ObjectId match;
+        int found = p->mIdIndex.findPrefix(id, hex.length(), match);
+        lock.unlock();
+
+        if (found == 1) {
+            return match;
+        }
+
+        if (found > 1) {
+            result.setError("The abbreviated id is ambiguous.", GIT_EAMBIGUOUS);
+            return ObjectId();
+        }
+
+        // The index only knows about the file based object directories. Let libgit2 have a
+        // look, too; there might be other backends.
+        git_object* obj = nullptr;
+        result = git_object_lookup_prefix(&obj, d->mRepo, Internal::ObjectId2git(id),
+                                          hex.length(), GIT_OBJ_ANY);
+        GW_CHECK_RESULT(result, ObjectId());
+
+        match = Private::oid2sha(git_object_id(obj));
+        git_object_free(obj);
+        return match;
+    }
+
+    /**
+     * @brief           Find the shortest unique abbreviations of object ids
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       ids     The ids to abbreviate.
+     *
+     * @param[in]       minLen  The minimum number of hex digits to use. Values below 4 are
+     *                          treated as 4.
+     *
+     * @return          One abbreviation per id, in the order of @a ids. Each is the shortest
+     *                  prefix of at least @a minLen digits that matches no other object in this
+     *                  repository.
+     *
+     * This does not probe the object database per id. Instead, an in memory index of all object
+     * ids is built from the pack indices and loose objects (including alternates) on the first
+     * call. Later calls refresh the index incrementally: Only new pack indices are read and
+     * only loose object directories that have changed are rescanned.
+     */
+    QStringList Repository::shortestUniqueAbbrev(Result& result, const ObjectIdList& ids,
+                                                 int minLen) const
+    {
+        GW_CD_CHECKED(Repository, QStringList(), result);
+
+        minLen = qBound(int(GIT_OID_MINPREFIXLEN), minLen, int(ObjectId::SHA1_LengthHex));
+
+        Internal::RepositoryPrivate* p = const_cast<Internal::RepositoryPrivate*>(d);
+        QMutexLocker lock(&p->mIdIndex.mutex());
+
+        p->mIdIndex.refresh(result, d->mRepo);
+        GW_CHECK_RESULT(result, QStringList());
+
+        QVector<int> lengths(ids.count());
+        for (int i = 0; i < ids.count(); ++i) {
+            lengths[i] = qMax(minLen, p->mIdIndex.uniqueLength(ids.at(i)));
+        }
+
+        lock.unlock();
+
+        QStringList abbrevs;
+        abbrevs.reserve(ids.count());
+        for (int i = 0; i < ids.count(); ++i) {
+            abbrevs.append(ids.at(i).toString(lengths.at(i)));
+        }
+
+        return abbrevs;
+    }
+
+    /**
+     * @brief       Get the current limits of this repository's object cache
+     *
+     * @return      The limits. If this repository is invalid, the default limits are returned.
+     */
+    ObjectCacheLimits Repository::objectCacheLimits() const
+    {
+        GW_CD(Repository);
+        return d ? d->mObjects.limits() : ObjectCacheLimits();
+    }
+
+    /**
+     * @brief       Set the limits of this repository's object cache
+     *
+     * @param[in]   limits  The new limits. If the cache currently exceeds them, objects are evicted
+     *                      immediately. A per type limit of zero disables retaining objects of that
+     *                      type; wrappers that are still alive will be shared nevertheless.
+     */
+    void Repository::setObjectCacheLimits(const ObjectCacheLimits& limits)
+    {
+        GW_D(Repository);
+        if (d) {
+            d->mObjects.setLimits(limits);
+        }
+    }
+
+    /**
+     * @brief       Read the counters of this repository's object cache
+     *
+     * @return      A snapshot of the counters.
+     */
+    ObjectCacheStats Repository::objectCacheStats() const
+    {
+        GW_CD(Repository);
+        if (!d) {
+            return ObjectCacheStats();
+        }
+
+        ObjectCacheStats stats = d->mObjects.stats();
+        stats.prefetched = d->mPrefetcher.prefetched();
+        stats.prefetchHits = d->mPrefetcher.served();
+        return stats;
+    }
+
+    /**
+     * @brief       Drop all objects retained by this repository's object cache
+     *
+     * This includes the objects that prefetch() has read ahead, but which were not looked up yet.
+     */
+    void Repository::clearObjectCache()
+    {
+        GW_D(Repository);
+        if (d) {
+            d->mObjects.clear();
+            d->mPrefetcher.clear();
+        }
+    }
+
+    /**
+     * @brief       Read objects ahead of their use
+     *
+     * @param[in]   ids         The objects to read. Ids that cannot be found are ignored.
+     *
+     * @param[in]   depthHint   How far to follow the objects: With `0` only @a ids are read. With
+     *                          `1` the trees of commits and the targets of tags are read, too.
+     *                          Every further level adds the subtrees of the trees read so far.
+     *
+     * The objects are read and inflated on background threads, each of which uses a repository
+     * handle of its own. A later lookup() of them only has to parse them; it neither waits for the
+     * disk nor for zlib. This method returns
+     * immediately; the ids are queued behind those that are still pending. Call cancelPrefetch()
+     * first, if the pending ones are no longer of interest.
+     *
+     * The memory that the read ahead objects use is bounded by
+     * ObjectCacheLimits::maxPrefetchMemory. Blobs are only read if they are in @a ids.
+     *
+     * @see         objectCacheStats()
+     */
+    void Repository::prefetch(const ObjectIdList& ids, int depthHint)
+    {
+        GW_D(Repository);
+        if (d && !ids.isEmpty()) {
+            d->mPrefetcher.prefetch(ids, depthHint);
+        }
+    }
+
+    /**
+     * @brief       Drop all objects that are still queued by prefetch()
+     *
+     * This does not wait for objects that are being read right now.
+     */
+    void Repository::cancelPrefetch()
+    {
+        GW_D(Repository);
+        if (d) {
+            d->mPrefetcher.cancel();
+        }
+    }
+
+    /**
+     * @brief       Block until all objects queued by prefetch() are read
+     */
+    void Repository::waitForPrefetch()
+    {
+        GW_D(Repository);
+        if (d) {
+            d->mPrefetcher.waitForDone();
+        }
+    }
+
     bool Repository::shouldIgnore(Result& result, const QString& filePath) const
     {
         GW_CD_CHECKED(Repository, false, result);
@@ -1144,9 +2113,253 @@ namespace Git
     {
         GW_CD_CHECKED_VOID(Repository, result);
 
+        Internal::RepositoryPrivate* p = const_cast<Internal::RepositoryPrivate*>(d);
+        Internal::CommitGraph::Ptr graph = p->mCommitGraph.graph(d->mRepo);
+
+        if (graph) {
+            // Without parsing a single commit that the commit-graph knows of
+            Internal::DivergenceWalker walker(d->mRepo, graph.data());
+            int pair = walker.addPair(idLocal, idRemote);
+
+            if (walker.run(result)) {
+                ahead = walker.ahead(pair);
+                behind = walker.behind(pair);
+            }
+            return;
+        }
+
         result = git_graph_ahead_behind(&ahead, &behind, d->mRepo,
                                         Internal::ObjectId2git(idLocal),
                                         Internal::ObjectId2git(idRemote));
     }
 
+    /**
+     * @brief           Check whether a commit is an ancestor of another one
+     *
+     * @param[in,out]   result      A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       ancestor    The id of the possible ancestor
+     *
+     * @param[in]       descendant  The id of the possible descendant
+     *
+     * @return          `true` if @a ancestor can be reached from @a descendant. A commit counts
+     *                  as its own ancestor.
+     *
+     * If the repository has a commit-graph file, commits in there are not parsed and the walk
+     * skips every commit whose generation number shows that it cannot reach @a ancestor.
+     * Otherwise, this is a merge base computation.
+     */
+    bool Repository::isAncestor(Result& result, const ObjectId& ancestor,
+                                const ObjectId& descendant) const
+    {
+        GW_CD_CHECKED(Repository, false, result);
+
+        if (ancestor == descendant) {
+            return true;
+        }
+
+        Internal::RepositoryPrivate* p = const_cast<Internal::RepositoryPrivate*>(d);
+        Internal::CommitGraph::Ptr graph = p->mCommitGraph.graph(d->mRepo);
+
+        if (graph) {
+            return Internal::isAncestorInGraph(result, d->mRepo, *graph, ancestor, descendant);
+        }
+
+        git_oid base;
+        int rc = git_merge_base(&base, d->mRepo, Internal::ObjectId2git(ancestor),
+                                Internal::ObjectId2git(descendant));
+        if (rc == GIT_ENOTFOUND) {
+            // No common ancestor at all
+            giterr_clear();
+            return false;
+        }
+
+        result = rc;
+        GW_CHECK_RESULT(result, false);
+
+        return Internal::BasePrivate::oid2sha(&base) == ancestor;
+    }
+
+    /**
+     * @brief           Compute ahead/behind counts of all local branches against their upstreams
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          One entry for every local branch. Branches without an upstream (or
+     *                  whose upstream does not exist) have an empty BranchDivergence::upstream
+     *                  and no counts.
+     *
+     * All branches are handled in a single walk over the history, which visits every commit
+     * only once. This is much cheaper than calling calculateDivergence() for each branch, since
+     * those walks would mostly cover the same commits.
+     */
+    BranchDivergenceList Repository::divergenceForBranches(Result& result) const
+    {
+        GW_CD_CHECKED(Repository, BranchDivergenceList(), result);
+
+        BranchDivergenceList branches;
+        if (!Internal::localBranches(result, d->mRepo, true, branches)) {
+            return BranchDivergenceList();
+        }
+
+        Internal::computeDivergence(result, const_cast<Internal::RepositoryPrivate*>(d),
+                                    branches);
+        GW_CHECK_RESULT(result, BranchDivergenceList());
+
+        return branches;
+    }
+
+    /**
+     * @brief           Compute ahead/behind counts of all local branches against one commit
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       base    The commit to compare all branches to, i.e. the tip of the main
+     *                          development branch
+     *
+     * @return          One entry for every local branch.
+     *
+     * Like divergenceForBranches(Result&) const, this is done in a single walk.
+     */
+    BranchDivergenceList Repository::divergenceForBranches(Result& result,
+                                                           const ObjectId& base) const
+    {
+        GW_CD_CHECKED(Repository, BranchDivergenceList(), result);
+
+        BranchDivergenceList branches;
+        if (!Internal::localBranches(result, d->mRepo, false, branches)) {
+            return BranchDivergenceList();
+        }
+
+        for (int i = 0; i < branches.count(); ++i) {
+            branches[i].other = base;
+        }
+
+        Internal::computeDivergence(result, const_cast<Internal::RepositoryPrivate*>(d),
+                                    branches);
+        GW_CHECK_RESULT(result, BranchDivergenceList());
+
+        return branches;
+    }
+
+    /**
+     * @brief           Add the commits reachable from any reference to the changed path index
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          The number of commits that were added to the index.
+     *
+     * The index holds a Bloom filter of the changed paths for each commit. A RevisionWalker with
+     * a path filter uses it to skip the tree comparison for commits that left the paths alone.
+     *
+     * References whose commits are in the index already are hidden from the walk, so after a
+     * fetch only the new history is walked and only the new commits are diffed against their
+     * first parents. This is done on GitWrap's worker threads. The index
+     * is stored as `objects/info/gitwrap-changed-paths` in the repository.
+     */
+    int Repository::updateChangedPathIndex(Result& result) const
+    {
+        GW_CD_CHECKED(Repository, 0, result);
+
+        Internal::RepositoryPrivate* p = const_cast<Internal::RepositoryPrivate*>(d);
+        Internal::ChangedPathIndex& index = p->mChangedPaths;
+
+        ObjectIdList tips;
+        if (!Internal::refTips(result, d->mRepo, tips)) {
+            return 0;
+        }
+
+        git_revwalk* walk = nullptr;
+        result = git_revwalk_new(&walk, d->mRepo);
+        GW_CHECK_RESULT(result, 0);
+
+        QMutexLocker lock(&index.mutex());
+        index.refresh(d->mRepo);
+
+        // A tip is indexed only along with all of its history, so walk only what is new.
+        foreach (const ObjectId& tip, tips) {
+            if (index.contains(tip)) {
+                result = git_revwalk_hide(walk, Internal::ObjectId2git(tip));
+            }
+            else {
+                result = git_revwalk_push(walk, Internal::ObjectId2git(tip));
+            }
+
+            if (!result) {
+                break;
+            }
+        }
+
+        lock.unlock();
+
+        ObjectIdList ids;
+        git_oid oid;
+        int rc = 0;
+
+        while (result && (rc = git_revwalk_next(&oid, walk)) == 0) {
+            ids.append(ObjectId::fromRaw(oid.id));
+        }
+
+        if (result && rc != GIT_ITEROVER) {
+            result = rc;
+        }
+
+        git_revwalk_free(walk);
+        GW_CHECK_RESULT(result, 0);
+
+        lock.relock();
+        index.refresh(d->mRepo);
+        ObjectIdList missing = index.missingOf(ids);
+        lock.unlock();
+
+        if (missing.isEmpty()) {
+            return 0;
+        }
+
+        int chunks = Internal::WorkerPool::chunksFor(missing.count(),
+                                                     Internal::sMinCommitsPerChunk);
+        QVector<Result> results(chunks);
+        QVector<QByteArray> records(chunks);
+
+        // Don't let the threads touch the containers; non-const access might detach them.
+        Result* chunkResults = results.data();
+        QByteArray* chunkRecords = records.data();
+        const ObjectId* idData = missing.constData();
+
+        Internal::WorkerPool::run(chunks, missing.count(), [&](int chunk, int begin, int end) {
+            Result& r = chunkResults[chunk];
+
+            git_repository* repo = d->mRepo;
+            if (chunk) {
+                repo = d->openHandle(r);
+                if (!r) {
+                    return;
+                }
+            }
+
+            for (int i = begin; r && i < end; ++i) {
+                Internal::ChangedPathIndex::buildRecord(r, repo, idData[i], chunkRecords[chunk]);
+            }
+
+            if (chunk) {
+                git_repository_free(repo);
+            }
+        });
+
+        QByteArray all;
+        for (int i = 0; i < chunks; ++i) {
+            if (!results.at(i)) {
+                result = results.at(i);
+                return 0;
+            }
+            all.append(records.at(i));
+        }
+
+        lock.relock();
+        index.append(result, d->mRepo, all);
+        GW_CHECK_RESULT(result, 0);
+
+        return missing.count();
+    }
+
 }
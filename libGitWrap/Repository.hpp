@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <QBitArray>
+
 #include "libGitWrap/Base.hpp"
 #include "libGitWrap/Commit.hpp"
+#include "libGitWrap/CommitInfo.hpp"
 #include "libGitWrap/Diff.hpp"
 #include "libGitWrap/DiffList.hpp"
 #include "libGitWrap/Object.hpp"
@@ -38,6 +41,121 @@ namespace Git
 
     typedef QHash< QString, ObjectId > ResolvedRefs;
 
+    /**
+     * @ingroup     GitWrap
+     * @brief       Limits for the object cache of a Repository
+     *
+     * @see         Repository::setObjectCacheLimits()
+     */
+    struct GITWRAP_API ObjectCacheLimits
+    {
+        ObjectCacheLimits();
+
+        /** Budget in bytes for all objects retained by the cache */
+        quint64     maxMemory;
+
+        /** Budget in bytes for the objects that Repository::prefetch() reads ahead, until its
+         *  queue runs empty */
+        quint64     maxPrefetchMemory;
+
+        /** Maximum number of retained objects per type */
+        int         maxCommits;
+        int         maxTrees;
+        int         maxBlobs;
+        int         maxTags;
+    };
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Counters of the object cache of a Repository
+     *
+     * @see         Repository::objectCacheStats()
+     */
+    struct GITWRAP_API ObjectCacheStats
+    {
+        ObjectCacheStats();
+
+        /** Lookups that returned an existing wrapper */
+        quint64     hits;
+
+        /** Lookups that created a new wrapper from an object retained in the cache */
+        quint64     revived;
+
+        /** Lookups that had to ask libgit2 */
+        quint64     misses;
+
+        /** Objects that were dropped to stay within the limits */
+        quint64     evictions;
+
+        /** Objects that Repository::prefetch() read ahead */
+        quint64     prefetched;
+
+        /** Misses that libgit2 served from the objects read ahead by Repository::prefetch() */
+        quint64     prefetchHits;
+
+        /** Estimated memory used by the retained objects */
+        quint64     memoryUsed;
+
+        /** Number of wrappers that are currently alive */
+        int         wrappers;
+
+        /** Number of retained objects per type */
+        int         commits;
+        int         trees;
+        int         blobs;
+        int         tags;
+    };
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       How far a local branch and the commit it is compared to have diverged
+     *
+     * @see         Repository::divergenceForBranches()
+     */
+    struct GITWRAP_API BranchDivergence
+    {
+        BranchDivergence();
+
+        /** Full name of the local branch */
+        QString     branch;
+
+        /** Full name of the upstream branch; empty if compared to a base commit or if the
+         *  branch has no upstream */
+        QString     upstream;
+
+        ObjectId    local;
+        ObjectId    other;
+
+        /** Commits reachable from @ref local but not from @ref other */
+        size_t      ahead;
+
+        /** Commits reachable from @ref other but not from @ref local */
+        size_t      behind;
+    };
+
+    typedef QVector< BranchDivergence > BranchDivergenceList;
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Type and size of an object, as stored in the object database
+     *
+     * @see         Repository::readHeaders()
+     */
+    struct GITWRAP_API ObjectHeader
+    {
+        ObjectHeader();
+
+        /** Whether the object exists; if not, the other fields are meaningless */
+        bool        found;
+
+        ObjectType  type;
+
+        /** Size of the object's content in bytes */
+        qint64      size;
+    };
+
+    typedef QVector< ObjectHeader > ObjectHeaderList;
+
     class GITWRAP_API Repository : public Base
     {
         GW_PRIVATE_DECL(Repository, Base, public)
@@ -92,6 +210,8 @@ namespace Git
 
         Git::StatusFlags status(Result &result, const QString &fileName) const;
         Git::StatusHash status(Result &result) const;
+        Git::StatusHash status(Result& result, const StatusOptions& opts) const;
+        void status(Result& result, const StatusOptions& opts, StatusConsumer* consumer) const;
 
         Reference HEAD( Result& result ) const;
         BranchRef headBranch( Result& result ) const;
@@ -128,6 +248,24 @@ namespace Git
         template< class T >
         T lookup(Result& result, const QString& refName);
 
+        CommitInfoList commitInfos(Result& result, const ObjectIdList& ids) const;
+
+        QBitArray exists(Result& result, const ObjectIdList& ids) const;
+        ObjectHeaderList readHeaders(Result& result, const ObjectIdList& ids) const;
+
+        ObjectId resolvePrefix(Result& result, const QString& prefix) const;
+        QStringList shortestUniqueAbbrev(Result& result, const ObjectIdList& ids,
+                                         int minLen = 7) const;
+
+        ObjectCacheLimits objectCacheLimits() const;
+        void setObjectCacheLimits(const ObjectCacheLimits& limits);
+        ObjectCacheStats objectCacheStats() const;
+        void clearObjectCache();
+
+        void prefetch(const ObjectIdList& ids, int depthHint = 1);
+        void cancelPrefetch();
+        void waitForPrefetch();
+
         bool shouldIgnore( Result& result, const QString& filePath ) const;
 
         QStringList allRemoteNames( Result& result ) const;
@@ -142,6 +280,14 @@ namespace Git
                                  const ObjectId& idLocal, const ObjectId& idRemote,
                                  size_t& ahead, size_t& behind) const;
 
+        bool isAncestor(Result& result, const ObjectId& ancestor,
+                        const ObjectId& descendant) const;
+
+        BranchDivergenceList divergenceForBranches(Result& result) const;
+        BranchDivergenceList divergenceForBranches(Result& result, const ObjectId& base) const;
+
+        int updateChangedPathIndex(Result& result) const;
+
     public:
         CommitOperation* commitOperation(Result& result, const QString& msg);
 
@@ -14,10 +14,14 @@
  *
  */
 
+#include <limits>
+
 #include "libGitWrap/RevisionWalker.hpp"
 #include "libGitWrap/ObjectId.hpp"
 #include "libGitWrap/Reference.hpp"
 
+#include "libGitWrap/Private/PathLimiter.hpp"
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
 #include "libGitWrap/Private/RevisionWalkerPrivate.hpp"
 
 namespace Git
@@ -26,18 +30,134 @@ namespace Git
     namespace Internal
     {
 
+        // Initial size of the list that all() fills, if there is no (or a smaller) hint
+        static const int sMinAllCapacity = 1024;
+
+        // Number of commits in a row that must be older than the date window, before the walk
+        // ends. Like git's, this allows for a little clock skew.
+        static const int sSinceSlop = 5;
+
+        static const qint64 sNoSince = std::numeric_limits<qint64>::min();
+        static const qint64 sNoUntil = std::numeric_limits<qint64>::max();
+
         RevisionWalkerPrivate::RevisionWalkerPrivate(RepositoryPrivate* repo, git_revwalk* walker )
             : RepoObjectPrivate(repo)
             , mWalker(walker)
+            , mSorting(GIT_SORT_NONE)
+            , mLimiter(nullptr)
+            , mFirstParent(false)
+            , mSkip(0)
+            , mMaxCount(-1)
+            , mSince(sNoSince)
+            , mUntil(sNoUntil)
+            , mSkipped(0)
+            , mReturned(0)
+            , mOlder(0)
         {
             Q_ASSERT(walker);
         }
 
         RevisionWalkerPrivate::~RevisionWalkerPrivate()
         {
+            delete mLimiter;
             git_revwalk_free(mWalker);
         }
 
+        /**
+         * @internal
+         * @brief       Get the next commit that passes the path filter and the limits
+         *
+         * @return      `false` if the walk is over or an error occurred.
+         */
+        bool RevisionWalkerPrivate::next(Result& result, git_oid* oid)
+        {
+            forever {
+                if ((mMaxCount >= 0 && mReturned >= mMaxCount) || mOlder >= sSinceSlop) {
+                    return false;
+                }
+
+                int rc = git_revwalk_next(oid, mWalker);
+                if (rc < 0) {
+                    if (rc != GIT_ITEROVER) {
+                        result = rc;
+                    }
+                    return false;
+                }
+
+                bool keep = true;
+
+                if (mLimiter || hasDateWindow()) {
+                    git_commit* commit = nullptr;
+                    result = git_commit_lookup(&commit, repo()->mRepo, oid);
+                    GW_CHECK_RESULT(result, false);
+
+                    // Every commit of the walk counts towards the end of the date window, and the
+                    // path filter has to see every one of them to simplify the history.
+                    keep = inDateWindow(git_commit_time(commit));
+                    if (mLimiter && !mLimiter->check(result, repo()->mRepo, commit)) {
+                        keep = false;
+                    }
+
+                    git_commit_free(commit);
+                    GW_CHECK_RESULT(result, false);
+                }
+
+                if (!keep) {
+                    continue;
+                }
+
+                if (mSkipped < mSkip) {
+                    mSkipped++;
+                    continue;
+                }
+
+                mReturned++;
+                return true;
+            }
+        }
+
+        bool RevisionWalkerPrivate::hasDateWindow() const
+        {
+            return mSince != sNoSince || mUntil != sNoUntil;
+        }
+
+        /**
+         * @internal
+         * @brief       Check a commit's time against the date window
+         *
+         * Commits older than the window are counted; next() ends the walk after a few of them in
+         * a row. The walk is sorted by time then, so the remaining commits are older still.
+         *
+         * @return      `true` if the commit is inside the window.
+         */
+        bool RevisionWalkerPrivate::inDateWindow(qint64 time)
+        {
+            if (time < mSince) {
+                mOlder++;
+                return false;
+            }
+
+            mOlder = 0;
+            return time <= mUntil;
+        }
+
+        void RevisionWalkerPrivate::applySorting()
+        {
+            unsigned int sorting = mSorting;
+
+            // The history simplification needs to see all children of a commit before the commit
+            if (mLimiter) {
+                sorting |= GIT_SORT_TOPOLOGICAL;
+            }
+
+            // Cutting the walk short at the window's start needs the newest commits first
+            if (mSince != sNoSince) {
+                sorting |= GIT_SORT_TIME;
+            }
+
+            git_revwalk_sorting(mWalker, sorting);
+        }
+
     }
 
     GW_PRIVATE_IMPL(RevisionWalker, RepoObject)
@@ -64,6 +184,14 @@ namespace Git
     {
         GW_D_CHECKED(RevisionWalker, void(), result);
         git_revwalk_reset( d->mWalker );
+
+        if (d->mLimiter) {
+            d->mLimiter->reset();
+        }
+
+        d->mSkipped = 0;
+        d->mReturned = 0;
+        d->mOlder = 0;
     }
 
     void RevisionWalker::push(Result& result, const ObjectId& id)
@@ -117,15 +245,7 @@ namespace Git
         GW_D_CHECKED(RevisionWalker, false, result);
 
         git_oid oid;
-        Result tmp( git_revwalk_next( &oid, d->mWalker ) );
-        if( tmp.errorCode() == GIT_ITEROVER )
-        {
-            return false;
-        }
-
-        if( !tmp )
-        {
-            result = tmp;
+        if (!d->next(result, &oid)) {
             return false;
         }
 
@@ -133,29 +253,212 @@ namespace Git
         return true;
     }
 
-    ObjectIdList RevisionWalker::all( Result& result )
+    /**
+     * @brief           Get the next commits of the walk
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[out]      out     Array to receive the ids. libgit2 writes them to it directly.
+     *
+     * @param[in]       max     Number of ids that fit into @a out.
+     *
+     * @return          The number of ids written to @a out. If it is less than @a max, the walk
+     *                  is over or an error occurred; the ids up to the error are valid.
+     */
+    int RevisionWalker::nextBatch(Result& result, ObjectId* out, int max)
+    {
+        GW_D_CHECKED(RevisionWalker, 0, result);
+
+        int count = 0;
+        while (count < max && d->next(result, Internal::ObjectId2git(out[count]))) {
+            count++;
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief           Get all remaining commits of the walk
+     *
+     * @param[in,out]   result          A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       capacityHint    The number of commits that the walk is expected to yield.
+     *                                  The list is allocated for this many ids up front. If the
+     *                                  hint is too small, the list grows as usual.
+     *
+     * @return          The ids or an empty list on failure.
+     */
+    ObjectIdList RevisionWalker::all(Result& result, int capacityHint)
     {
         GW_D_CHECKED(RevisionWalker, ObjectIdList(), result);
-        ObjectIdList ids;
-        ObjectId id;
 
-        while (next(result, id)) {
+        ObjectIdList ids(qMax(capacityHint, Internal::sMinAllCapacity));
+        int count = 0;
+
+        forever {
+            count += nextBatch(result, ids.data() + count, ids.count() - count);
             if (!result) {
                 return ObjectIdList();
             }
-            ids.append( id );
+
+            if (count < ids.count()) {
+                break;
+            }
+
+            ids.resize(ids.count() * 2);
         }
 
+        ids.resize(count);
         return ids;
     }
 
     void RevisionWalker::setSorting(Result& result, bool topological, bool timed)
     {
         GW_D_CHECKED(RevisionWalker, void(), result);
-        git_revwalk_sorting( d->mWalker,
-                             ( topological ? GIT_SORT_TOPOLOGICAL : 0 ) |
-                             ( timed ? GIT_SORT_TIME : 0 ) );
+        d->mSorting = ( topological ? GIT_SORT_TOPOLOGICAL : 0 ) |
+                      ( timed ? GIT_SORT_TIME : 0 );
+        d->applySorting();
     }
 
-}
+    /**
+     * @brief           Limit the walk to the commits that change some paths
+     *
+     * Like `git log -- <paths>`, the walk then only returns the commits whose content at the
+     * paths differs from each of their parents. A merge whose content at the paths is the same
+     * as that of one of its parents is skipped, and only this parent's history is followed.
+     *
+     * Only the subtrees on the way to the paths are read. Two commits' trees are compared by the
+     * ids of these subtrees; below an unchanged subtree, nothing is read at all. Commits that are
+     * in the repository's changed path index and did not change any of the paths according to it
+     * are not compared at all; see Repository::updateChangedPathIndex().
+     *
+     * While a filter is set, the walk is sorted topologically in addition to the order chosen
+     * with setSorting(). Thus the whole history has to be read before the first commit is
+     * returned.
+     *
+     * Set the filter before the walk starts.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       paths   The paths, relative to the repository's root. A directory matches
+     *                          everything below it. Wildcards are not supported. An empty list
+     *                          removes the filter.
+     */
+    void RevisionWalker::setPathFilter(Result& result, const QStringList& paths)
+    {
+        GW_D_CHECKED(RevisionWalker, void(), result);
+
+        delete d->mLimiter;
+        d->mLimiter = new Internal::PathLimiter(paths, &d->repo()->mChangedPaths);
+
+        if (d->mLimiter->isEmpty()) {
+            delete d->mLimiter;
+            d->mLimiter = nullptr;
+        }
+        else {
+            d->mLimiter->setFirstParentOnly(d->mFirstParent);
+        }
+
+        d->applySorting();
+    }
+
+    /**
+     * @brief           The paths that the walk is limited to
+     *
+     * @return          The paths given to setPathFilter(), without the empty ones.
+     */
+    QStringList RevisionWalker::pathFilter() const
+    {
+        GW_CD(RevisionWalker);
+        if (!d || !d->mLimiter) {
+            return QStringList();
+        }
+
+        return d->mLimiter->paths();
+    }
+
+    /**
+     * @brief           Follow only the first parent of merge commits
+     *
+     * The side parents of a merge are not even queued, so the history that is only reachable
+     * through them is never read. With a path filter, merges are compared to their first parent
+     * only.
+     *
+     * libgit2 cannot turn this off again; neither does reset().
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     */
+    void RevisionWalker::simplifyFirstParent(Result& result)
+    {
+        GW_D_CHECKED(RevisionWalker, void(), result);
+
+        git_revwalk_simplify_first_parent(d->mWalker);
+        d->mFirstParent = true;
+
+        if (d->mLimiter) {
+            d->mLimiter->setFirstParentOnly(true);
+        }
+    }
 
+    /**
+     * @brief           Leave out the first commits of the walk
+     *
+     * Like `git log --skip`, this counts only commits that pass the path filter and the date
+     * window.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       count   Number of commits to leave out.
+     */
+    void RevisionWalker::setSkip(Result& result, int count)
+    {
+        GW_D_CHECKED(RevisionWalker, void(), result);
+        d->mSkip = qMax(count, 0);
+    }
+
+    /**
+     * @brief           End the walk after a number of commits
+     *
+     * Like `git log --max-count`, this counts only the commits that are returned. Once the
+     * limit is reached, the walk does not read any further commits.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       count   Number of commits to return or `-1` for no limit.
+     */
+    void RevisionWalker::setMaxCount(Result& result, int count)
+    {
+        GW_D_CHECKED(RevisionWalker, void(), result);
+        d->mMaxCount = count < 0 ? -1 : count;
+    }
+
+    /**
+     * @brief           Return only commits that were committed within a time span
+     *
+     * Like `git log --since --until`, the committer time is compared.
+     *
+     * With a start time, the walk is sorted by time in addition to the order chosen with
+     * setSorting(). Once a few commits in a row are older than the start, the walk ends. With
+     * time sorting only, commits are read as the walk goes, so hardly any of the history behind
+     * that point is read. Topological sorting, which a path filter turns on, reads the whole
+     * history before the first commit is returned; ending early then saves only the checks of
+     * the remaining commits. Commits that are newer than the end are skipped, but their ancestors
+     * still have to be walked.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       since   The start of the window or an invalid QDateTime for none.
+     *
+     * @param[in]       until   The end of the window or an invalid QDateTime for none.
+     */
+    void RevisionWalker::setDateWindow(Result& result, const QDateTime& since,
+                                       const QDateTime& until)
+    {
+        GW_D_CHECKED(RevisionWalker, void(), result);
+
+        d->mSince = since.isValid() ? since.toMSecsSinceEpoch() / 1000 : Internal::sNoSince;
+        d->mUntil = until.isValid() ? until.toMSecsSinceEpoch() / 1000 : Internal::sNoUntil;
+        d->applySorting();
+    }
+
+}
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <QDateTime>
+
 #include "libGitWrap/RepoObject.hpp"
 
 namespace Git
@@ -52,9 +54,19 @@ namespace Git
         void hideHead( Result& result );
 
         bool next( Result& result, ObjectId& oidNext );
-        ObjectIdList all( Result& result );
+        int nextBatch( Result& result, ObjectId* out, int max );
+        ObjectIdList all( Result& result, int capacityHint = 0 );
 
         void setSorting( Result& result, bool topological, bool timed );
+
+        void setPathFilter( Result& result, const QStringList& paths );
+        QStringList pathFilter() const;
+
+        void simplifyFirstParent( Result& result );
+        void setSkip( Result& result, int count );
+        void setMaxCount( Result& result, int count );
+        void setDateWindow( Result& result, const QDateTime& since,
+                            const QDateTime& until = QDateTime() );
     };
 
 }
@@ -25,17 +25,36 @@ namespace Git
     namespace Internal
     {
 
-        Signature git2Signature( const git_signature* gitsig )
+        /**
+         * @internal
+         * @brief       Convert a libgit2 signature
+         *
+         * @param[in]   gitsig  The signature to convert.
+         *
+         * @param[in]   repo    The repository the signature was read from (may be `nullptr`).
+         *                      If given, name and email are shared with all other signatures of
+         *                      this repository that carry the same strings; unless this is turned
+         *                      off with GitWrap::Tuning::internSignatures.
+         *
+         * @return      The signature. No QDateTime is created here.
+         */
+        Signature git2Signature( const git_signature* gitsig, RepositoryPrivate* repo )
         {
             Q_ASSERT( gitsig );
 
-            QDateTime dt = QDateTime::fromTime_t( gitsig->when.time );
-            dt.setUtcOffset( gitsig->when.offset * 60 );
+            if (repo && internSignatures()) {
+                return Signature(
+                    repo->mSignatureStrings.intern( gitsig->name ),
+                    repo->mSignatureStrings.intern( gitsig->email ),
+                    qint64( gitsig->when.time ),
+                    gitsig->when.offset );
+            }
 
             return Signature(
                 GW_StringToQt( gitsig->name ),
                 GW_StringToQt( gitsig->email ),
-                dt );
+                qint64( gitsig->when.time ),
+                gitsig->when.offset );
         }
 
         git_signature* signature2git(Result& result, const Signature& sig)
@@ -50,8 +69,8 @@ namespace Git
             result = git_signature_new( &gitsig,
                                         GW_StringFromQt(sig.name()),
                                         GW_StringFromQt(sig.email()),
-                                        sig.when().toTime_t(),
-                                        sig.when().utcOffset() / 60 );
+                                        git_time_t( sig.time() ),
+                                        sig.timeOffset() );
 
             return gitsig;
         }
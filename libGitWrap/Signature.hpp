@@ -46,6 +46,10 @@ namespace Git
      * cross merge from one repository to another will leave the committer intact; while
      * cherry-picking a commit, will not.
      *
+     * The time is kept as seconds since the epoch plus an offset from UTC; when() creates the
+     * QDateTime only when asked. Signatures that are read from a repository share the QStrings
+     * of their names and email addresses with all other signatures of the same person.
+     *
      */
     class GITWRAP_API Signature
     {
@@ -53,18 +57,35 @@ namespace Git
         Signature( const QString& name, const QString& email, const QDateTime& when )
             : mName( name )
             , mEMail( email )
-            , mWhen( when )
+            , mTime( when.isValid() ? when.toMSecsSinceEpoch() / 1000 : 0 )
+            , mOffset( when.isValid() ? when.offsetFromUtc() / 60 : 0 )
+            , mHasTime( when.isValid() )
+        {
+        }
+
+        Signature( const QString& name, const QString& email, qint64 time, int offset )
+            : mName( name )
+            , mEMail( email )
+            , mTime( time )
+            , mOffset( offset )
+            , mHasTime( true )
         {
         }
 
         Signature( const QString& name, const QString& email )
             : mName( name )
             , mEMail( email )
-            , mWhen( QDateTime::currentDateTime() )
         {
+            QDateTime now = QDateTime::currentDateTime();
+            mTime = now.toMSecsSinceEpoch() / 1000;
+            mOffset = now.offsetFromUtc() / 60;
+            mHasTime = true;
         }
 
         Signature()
+            : mTime( 0 )
+            , mOffset( 0 )
+            , mHasTime( false )
         {
         }
 
@@ -86,9 +107,30 @@ namespace Git
             return mEMail;
         }
 
+        /**
+         * @brief   The time as a QDateTime in the signature's time zone
+         *
+         * The QDateTime is created on each call; use time() and timeOffset() where that matters.
+         */
         QDateTime when() const
         {
-            return mWhen;
+            if ( !mHasTime ) {
+                return QDateTime();
+            }
+
+            return QDateTime::fromMSecsSinceEpoch( mTime * 1000, Qt::OffsetFromUTC, mOffset * 60 );
+        }
+
+        /** Seconds since the epoch */
+        qint64 time() const
+        {
+            return mTime;
+        }
+
+        /** Offset from UTC in minutes */
+        int timeOffset() const
+        {
+            return mOffset;
         }
 
         QString fullName() const
@@ -103,18 +145,20 @@ namespace Git
             return QString( QStringLiteral( "%1 <%2> %3" ) )
                     .arg( mName )
                     .arg( mEMail )
-                    .arg( mWhen.toString( Qt::ISODate ) );
+                    .arg( when().toString( Qt::ISODate ) );
         }
 
         bool isEmpty() const
         {
-            return mName.isEmpty() && mEMail.isEmpty() && mWhen.isNull();
+            return mName.isEmpty() && mEMail.isEmpty() && !mHasTime;
         }
 
     private:
         QString     mName;
         QString     mEMail;
-        QDateTime   mWhen;
+        qint64      mTime;
+        int         mOffset;
+        bool        mHasTime;
     };
 
 }
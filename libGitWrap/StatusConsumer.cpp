@@ -0,0 +1,68 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "libGitWrap/StatusConsumer.hpp"
+
+namespace Git
+{
+
+    StatusConsumer::StatusConsumer()
+    {
+    }
+
+    StatusConsumer::~StatusConsumer()
+    {
+    }
+
+    /**
+     * @brief       Called once for every file that matches the StatusOptions
+     *
+     * @param[in]   path    The path of the file, relative to the working tree
+     *
+     * @param[in]   status  The status of the file
+     *
+     * @return      `true` to continue, `false` to stop reporting further files.
+     */
+    bool StatusConsumer::fileStatus(const QString& path, StatusFlags status)
+    {
+        Q_UNUSED( path );
+        Q_UNUSED( status );
+
+        return false;
+    }
+
+    /**
+     * @brief       Called instead of fileStatus() for a file that was detected as renamed
+     *
+     * Renames are only detected, if the StatusOptions ask for it. The default implementation
+     * reports the file with its new path to fileStatus().
+     *
+     * @param[in]   oldPath The path of the file before the rename
+     *
+     * @param[in]   newPath The path of the file after the rename
+     *
+     * @param[in]   status  The status of the file
+     *
+     * @return      `true` to continue, `false` to stop reporting further files.
+     */
+    bool StatusConsumer::fileRenamed(const QString& oldPath, const QString& newPath,
+                                     StatusFlags status)
+    {
+        Q_UNUSED( oldPath );
+
+        return fileStatus( newPath, status );
+    }
+
+}
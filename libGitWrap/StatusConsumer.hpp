@@ -0,0 +1,41 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "libGitWrap/GitWrap.hpp"
+
+namespace Git
+{
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Callback interface to consume the status of a working tree file by file
+     *
+     * @see         Repository::status(Result&, const StatusOptions&, StatusConsumer*) const
+     */
+    class GITWRAP_API StatusConsumer
+    {
+    public:
+        StatusConsumer();
+        virtual ~StatusConsumer();
+
+    public:
+        virtual bool fileStatus(const QString& path, StatusFlags status);
+        virtual bool fileRenamed(const QString& oldPath, const QString& newPath,
+                                 StatusFlags status);
+    };
+
+}
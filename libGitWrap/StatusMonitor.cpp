@@ -0,0 +1,1021 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#define GW_STATUS_INOTIFY
+#include <errno.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include "libGitWrap/StatusMonitor.hpp"
+
+#include "libGitWrap/Private/FileStamp.hpp"
+#include "libGitWrap/Private/RepositoryPrivate.hpp"
+#include "libGitWrap/Private/StatusMonitorPrivate.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+
+        struct StatusChange
+        {
+            QString     path;
+            StatusFlags oldStatus;
+            StatusFlags newStatus;
+        };
+
+        StatusMonitorPrivate::StatusMonitorPrivate(StatusMonitor* owner, const Repository& repo,
+                                                   const StatusOptions& opts)
+            : mOwner(owner)
+            , mRepo(repo)
+            , mOpts(opts)
+            , mRunning(false)
+            , mNeedsRescan(false)
+            , mIgnoreChanged(false)
+            , mFlushTimer(new QTimer(owner))
+            , mFd(-1)
+            , mNotifier(nullptr)
+            , mWatcher(nullptr)
+        {
+            mOpts.setPathSpec(QStringList());
+
+            mFlushTimer->setSingleShot(true);
+            mFlushTimer->setInterval(FlushDelay);
+            QObject::connect(mFlushTimer, SIGNAL(timeout()), owner, SLOT(flushPending()));
+        }
+
+        StatusMonitorPrivate::~StatusMonitorPrivate()
+        {
+            stopWatching();
+        }
+
+        QString StatusMonitorPrivate::absolutePath(const QString& relPath) const
+        {
+            return relPath.isEmpty() ? mWorkDir : mWorkDir + relPath;
+        }
+
+        QString StatusMonitorPrivate::relativePath(const QString& absPath) const
+        {
+            QString path = QDir::cleanPath(absPath);
+            if (path.length() < mWorkDir.length()) {
+                return QString();
+            }
+            return path.mid(mWorkDir.length());
+        }
+
+        bool StatusMonitorPrivate::isInGitDir(const QString& relPath) const
+        {
+            if (mRelGitDir.isEmpty()) {
+                return false;
+            }
+
+            return relPath == mRelGitDir || relPath.startsWith(mRelGitDir + QLatin1Char('/'));
+        }
+
+        bool StatusMonitorPrivate::startWatching(Result& result)
+        {
+            #ifdef GW_STATUS_INOTIFY
+            mFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (mFd < 0) {
+                result.setError("Could not initialize inotify.", GIT_ERROR);
+                return false;
+            }
+
+            mNotifier = new QSocketNotifier(mFd, QSocketNotifier::Read, mOwner);
+            QObject::connect(mNotifier, SIGNAL(activated(int)), mOwner, SLOT(readEvents()));
+            #else
+            mWatcher = new QFileSystemWatcher(mOwner);
+            QObject::connect(mWatcher, SIGNAL(directoryChanged(QString)),
+                             mOwner, SLOT(directoryChanged(QString)));
+            #endif
+
+            readHeadRef();
+
+            if (!watchGitDir(result, QString())) {
+                return false;
+            }
+
+            watchGitDirs();
+
+            #ifndef GW_STATUS_INOTIFY
+            foreach (const QString& file, gitFiles()) {
+                mGitStamps.insert(file, FileStamp::modificationTime(mGitDir + file));
+            }
+            #endif
+
+            return watchTree(result, QString());
+        }
+
+        /**
+         * @internal
+         * @brief       Watch a directory inside the git directory
+         *
+         * @param[in]   relDir  The directory, relative to the git directory.
+         *
+         * @return      `false` if the directory exists but cannot be watched.
+         */
+        bool StatusMonitorPrivate::watchGitDir(Result& result, const QString& relDir)
+        {
+            if (mGitWatchOf.contains(relDir)) {
+                return true;
+            }
+
+            QString path = QDir::cleanPath(mGitDir + relDir);
+            if (!QFileInfo(path).isDir()) {
+                return true;
+            }
+
+            #ifdef GW_STATUS_INOTIFY
+            // Git replaces its files by renaming a ".lock" file
+            int wd = inotify_add_watch(mFd, QFile::encodeName(path).constData(),
+                                       IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE |
+                                       IN_ONLYDIR);
+            if (wd < 0) {
+                result.setError("Could not watch the git directory.", GIT_ERROR);
+                return false;
+            }
+
+            mGitWatches.insert(wd, relDir);
+            mGitWatchOf.insert(relDir, wd);
+            #else
+            if (!mWatcher->addPath(path)) {
+                result.setError("Could not watch the git directory.", GIT_ERROR);
+                return false;
+            }
+
+            mGitWatchOf.insert(relDir, 0);
+            #endif
+
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Watch the directories that hold the files of gitFiles()
+         *
+         * Failures are not fatal; the files might not exist yet.
+         */
+        void StatusMonitorPrivate::watchGitDirs()
+        {
+            Result r;
+            watchGitDir(r, QStringLiteral("info"));
+
+            if (!mHeadRef.isEmpty()) {
+                watchGitDir(r, mHeadRef.left(mHeadRef.lastIndexOf(QLatin1Char('/'))));
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       Find out which branch HEAD points to
+         */
+        void StatusMonitorPrivate::readHeadRef()
+        {
+            QFile f(mGitDir + QStringLiteral("HEAD"));
+            mHeadRef.clear();
+
+            if (f.open(QIODevice::ReadOnly)) {
+                QByteArray head = f.readAll().trimmed();
+                if (head.startsWith("ref: ")) {
+                    mHeadRef = QString::fromUtf8(head.mid(5).trimmed());
+                }
+            }
+        }
+
+        /**
+         * @internal
+         * @brief       The files in the git directory whose change requires a rescan
+         *
+         * These are the index, HEAD, the ref of the current branch (loose or packed) and the
+         * repository's exclude file. The ".gitignore" files are in the working tree and seen
+         * there.
+         */
+        QStringList StatusMonitorPrivate::gitFiles() const
+        {
+            QStringList files;
+            files << QStringLiteral("index")
+                  << QStringLiteral("HEAD")
+                  << QStringLiteral("packed-refs")
+                  << QStringLiteral("info/exclude");
+
+            if (!mHeadRef.isEmpty()) {
+                files << mHeadRef;
+            }
+
+            return files;
+        }
+
+        /**
+         * @internal
+         * @brief       Handle a change of a file in the git directory
+         *
+         * @param[in]   relPath     The path of the file, relative to the git directory.
+         */
+        void StatusMonitorPrivate::gitFileChanged(const QString& relPath)
+        {
+            if (relPath == QStringLiteral("info")) {
+                watchGitDirs();
+                return;
+            }
+
+            if (!gitFiles().contains(relPath)) {
+                return;
+            }
+
+            if (relPath == QStringLiteral("HEAD")) {
+                // Another branch was checked out; watch its ref from now on.
+                readHeadRef();
+                watchGitDirs();
+            }
+
+            if (relPath == QStringLiteral("info/exclude")) {
+                mIgnoreChanged = true;
+            }
+
+            mNeedsRescan = true;
+            scheduleFlush();
+        }
+
+        /**
+         * @internal
+         * @brief       Look for changed files in the git directory by their time stamps
+         *
+         * QFileSystemWatcher only tells us which directory changed.
+         */
+        void StatusMonitorPrivate::gitDirChanged()
+        {
+            watchGitDirs();
+
+            QStringList changed;
+            foreach (const QString& file, gitFiles()) {
+                qint64 stamp = FileStamp::modificationTime(mGitDir + file);
+                if (!mGitStamps.contains(file) || mGitStamps.value(file) != stamp) {
+                    mGitStamps.insert(file, stamp);
+                    changed << file;
+                }
+            }
+
+            // Handle HEAD first; it decides which ref is watched.
+            if (changed.removeAll(QStringLiteral("HEAD"))) {
+                gitFileChanged(QStringLiteral("HEAD"));
+                if (!mHeadRef.isEmpty() && !mGitStamps.contains(mHeadRef)) {
+                    mGitStamps.insert(mHeadRef, FileStamp::modificationTime(mGitDir + mHeadRef));
+                }
+            }
+
+            foreach (const QString& file, changed) {
+                gitFileChanged(file);
+            }
+        }
+
+        void StatusMonitorPrivate::stopWatching()
+        {
+            mFlushTimer->stop();
+            mPending.clear();
+            mNeedsRescan = false;
+
+            delete mNotifier;
+            mNotifier = nullptr;
+
+            delete mWatcher;
+            mWatcher = nullptr;
+
+            #ifdef GW_STATUS_INOTIFY
+            if (mFd >= 0) {
+                ::close(mFd);
+            }
+            #endif
+
+            mFd = -1;
+            mWatches.clear();
+            mWatchOf.clear();
+            mGitWatches.clear();
+            mGitWatchOf.clear();
+            mGitStamps.clear();
+            mIgnoreChanged = false;
+        }
+
+        bool StatusMonitorPrivate::addWatch(Result& result, const QString& relDir)
+        {
+            QString path = absolutePath(relDir);
+
+            #ifdef GW_STATUS_INOTIFY
+            int wd = inotify_add_watch(mFd, QFile::encodeName(path).constData(),
+                                       IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE |
+                                       IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO |
+                                       IN_DELETE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW);
+            if (wd < 0) {
+                if (errno == ENOENT || errno == ENOTDIR) {
+                    // Gone again already; the event of its parent tells us.
+                    return true;
+                }
+
+                result.setError(errno == ENOSPC
+                                ? "The limit of inotify watches was reached."
+                                : "Could not watch a directory of the working tree.", GIT_ERROR);
+                return false;
+            }
+
+            mWatches.insert(wd, relDir);
+            mWatchOf.insert(relDir, wd);
+            #else
+            if (!mWatcher->addPath(path)) {
+                if (!QFileInfo(path).isDir()) {
+                    return true;
+                }
+
+                result.setError("Could not watch a directory of the working tree.", GIT_ERROR);
+                return false;
+            }
+
+            mWatchOf.insert(relDir, 0);
+            #endif
+
+            return true;
+        }
+
+        /**
+         * @internal
+         * @brief       Watch a directory and all of its sub directories
+         *
+         * Directories that are already watched, the git directory and (unless ignored files are
+         * wanted) ignored directories are skipped. The watch for a directory is installed before
+         * it is listed, so a sub directory that is created in between is seen either way.
+         *
+         * With @a revisit, directories that are watched already are descended into, too. This
+         * finds the directories that were ignored before the ignore rules changed. Directories
+         * that are ignored now are unwatched.
+         */
+        bool StatusMonitorPrivate::watchTree(Result& result, const QString& relDir, bool revisit)
+        {
+            QStringList todo(relDir);
+
+            while (!todo.isEmpty()) {
+                QString dir = todo.takeLast();
+
+                if (isInGitDir(dir) || (!revisit && mWatchOf.contains(dir))) {
+                    continue;
+                }
+
+                if (!dir.isEmpty() && !mOpts.includeIgnored()) {
+                    Result r;
+                    if (mRepo.shouldIgnore(r, dir + QLatin1Char('/'))) {
+                        unwatchTree(dir);
+                        continue;
+                    }
+                }
+
+                if (!mWatchOf.contains(dir) && !addWatch(result, dir)) {
+                    return false;
+                }
+
+                QDir qdir(absolutePath(dir));
+                foreach (const QString& sub, qdir.entryList(QDir::Dirs | QDir::NoDotAndDotDot |
+                                                            QDir::Hidden | QDir::NoSymLinks)) {
+                    todo.append(dir.isEmpty() ? sub : dir + QLatin1Char('/') + sub);
+                }
+            }
+
+            return true;
+        }
+
+        void StatusMonitorPrivate::unwatchTree(const QString& relDir)
+        {
+            QString prefix = relDir + QLatin1Char('/');
+            QHash<QString, int>::iterator it = mWatchOf.begin();
+
+            while (it != mWatchOf.end()) {
+                if (it.key() != relDir && !it.key().startsWith(prefix)) {
+                    ++it;
+                    continue;
+                }
+
+                #ifdef GW_STATUS_INOTIFY
+                mWatches.remove(it.value());
+                inotify_rm_watch(mFd, it.value());
+                #else
+                mWatcher->removePath(absolutePath(it.key()));
+                #endif
+
+                it = mWatchOf.erase(it);
+            }
+        }
+
+        void StatusMonitorPrivate::scheduleFlush()
+        {
+            if (!mFlushTimer->isActive()) {
+                mFlushTimer->start();
+            }
+        }
+
+        void StatusMonitorPrivate::touch(const QString& relPath)
+        {
+            if (isInGitDir(relPath)) {
+                return;
+            }
+
+            if (relPath.isEmpty()) {
+                mNeedsRescan = true;
+            }
+            else if (relPath == QStringLiteral(".gitignore") ||
+                     relPath.endsWith(QStringLiteral("/.gitignore"))) {
+                // Changes what is ignored or untracked anywhere below
+                mIgnoreChanged = true;
+                mNeedsRescan = true;
+            }
+            else {
+                mPending.insert(relPath);
+                if (mPending.count() > MaxPendingPaths) {
+                    mNeedsRescan = true;
+                }
+            }
+
+            scheduleFlush();
+        }
+
+        void StatusMonitorPrivate::readEvents()
+        {
+            #ifdef GW_STATUS_INOTIFY
+            alignas(struct inotify_event) char buffer[16 * 1024];
+
+            forever {
+                ssize_t len = ::read(mFd, buffer, sizeof(buffer));
+                if (len <= 0) {
+                    // EAGAIN: There are no more events.
+                    break;
+                }
+
+                const char* p = buffer;
+                while (p < buffer + len) {
+                    const struct inotify_event* ev =
+                            reinterpret_cast<const struct inotify_event*>(p);
+                    p += sizeof(struct inotify_event) + ev->len;
+
+                    handleEvent(ev->wd, ev->mask, ev->len ? ev->name : nullptr);
+                }
+            }
+            #endif
+        }
+
+        void StatusMonitorPrivate::handleEvent(int wd, quint32 mask, const char* name)
+        {
+            #ifdef GW_STATUS_INOTIFY
+            if (mask & IN_Q_OVERFLOW) {
+                // Events were dropped by the kernel; we cannot know what changed.
+                mNeedsRescan = true;
+                scheduleFlush();
+                return;
+            }
+
+            QHash<int, QString>::const_iterator git = mGitWatches.constFind(wd);
+            if (git != mGitWatches.constEnd()) {
+                if (mask & IN_IGNORED) {
+                    mGitWatchOf.remove(git.value());
+                    mGitWatches.remove(wd);
+                }
+                else if (name) {
+                    QString file = QFile::decodeName(name);
+                    gitFileChanged(git.value().isEmpty() ? file
+                                                         : git.value() + QLatin1Char('/') + file);
+                }
+                return;
+            }
+
+            QHash<int, QString>::iterator it = mWatches.find(wd);
+            if (it == mWatches.end()) {
+                return;
+            }
+
+            QString dir = it.value();
+
+            if (mask & IN_IGNORED) {
+                mWatches.erase(it);
+                if (mWatchOf.value(dir, -1) == wd) {
+                    mWatchOf.remove(dir);
+                }
+                return;
+            }
+
+            if (mask & IN_DELETE_SELF) {
+                // The parent directory reports this; unless it is the working tree itself.
+                if (dir.isEmpty()) {
+                    touch(QString());
+                }
+                return;
+            }
+
+            if (!name) {
+                return;
+            }
+
+            QString path = QFile::decodeName(name);
+            if (!dir.isEmpty()) {
+                path = dir + QLatin1Char('/') + path;
+            }
+
+            if (mask & IN_ISDIR) {
+                if (mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    unwatchTree(path);
+                }
+
+                if (mask & (IN_CREATE | IN_MOVED_TO)) {
+                    Result r;
+                    if (!watchTree(r, path)) {
+                        mResult = r;
+                    }
+                }
+            }
+
+            touch(path);
+            #else
+            Q_UNUSED(wd);
+            Q_UNUSED(mask);
+            Q_UNUSED(name);
+            #endif
+        }
+
+        /**
+         * @internal
+         * @brief       The paths of all tracked files directly inside a directory
+         *
+         * The index is sorted by path, so this is a binary search for the first entry below the
+         * directory.
+         */
+        QStringList StatusMonitorPrivate::trackedFilesIn(const QString& relDir) const
+        {
+            QStringList files;
+            Repository::Private* rp = BasePrivate::dataOf<Repository>(mRepo);
+
+            git_index* index = nullptr;
+            if (git_repository_index(&index, rp->mRepo) < 0) {
+                return files;
+            }
+            git_index_read(index, false);
+
+            QByteArray prefix = relDir.isEmpty() ? QByteArray()
+                                                 : GW_EncodeQString(relDir + QLatin1Char('/'));
+            size_t lo = 0, hi = git_index_entrycount(index);
+
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (qstrcmp(git_index_get_byindex(index, mid)->path, prefix.constData()) < 0) {
+                    lo = mid + 1;
+                }
+                else {
+                    hi = mid;
+                }
+            }
+
+            for (size_t i = lo, n = git_index_entrycount(index); i < n; ++i) {
+                const char* path = git_index_get_byindex(index, i)->path;
+                if (qstrncmp(path, prefix.constData(), uint(prefix.length())) != 0) {
+                    break;
+                }
+                if (!strchr(path + prefix.length(), '/')) {
+                    files.append(GW_StringToQt(path));
+                }
+            }
+
+            git_index_free(index);
+            return files;
+        }
+
+        /**
+         * @internal
+         * @brief       Handle a change reported by QFileSystemWatcher
+         *
+         * We only know the directory; so every file that is in there now or was in there
+         * according to the index or our snapshot is touched. New sub directories are watched
+         * and touched as a whole.
+         */
+        void StatusMonitorPrivate::directoryChanged(const QString& absPath)
+        {
+            QString path = QDir::cleanPath(absPath);
+
+            if ((path + QLatin1Char('/')).startsWith(mGitDir)) {
+                gitDirChanged();
+                return;
+            }
+
+            QString relDir = relativePath(path);
+            QString prefix = relDir.isEmpty() ? QString() : relDir + QLatin1Char('/');
+
+            if (!QFileInfo(path).isDir()) {
+                unwatchTree(relDir);
+                touch(relDir);
+                return;
+            }
+
+            QDir dir(path);
+            foreach (const QString& name, dir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot |
+                                                        QDir::Hidden | QDir::System)) {
+                QString relPath = prefix + name;
+                QFileInfo fi(dir.filePath(name));
+
+                if (fi.isDir() && !fi.isSymLink()) {
+                    if (!mWatchOf.contains(relPath)) {
+                        Result r;
+                        if (!watchTree(r, relPath)) {
+                            mResult = r;
+                        }
+                        touch(relPath);
+                    }
+                    continue;
+                }
+
+                touch(relPath);
+            }
+
+            foreach (const QString& relPath, trackedFilesIn(relDir)) {
+                touch(relPath);
+            }
+
+            QMap<QString, StatusFlags>::const_iterator it = mSnapshot.lowerBound(prefix);
+            while (it != mSnapshot.constEnd() && it.key().startsWith(prefix)) {
+                if (it.key().indexOf(QLatin1Char('/'), prefix.length()) == -1) {
+                    touch(it.key());
+                }
+                ++it;
+            }
+        }
+
+        void StatusMonitorPrivate::flush()
+        {
+            if (!mRunning) {
+                return;
+            }
+
+            if (mIgnoreChanged) {
+                // Directories might have become ignored or not ignored anymore
+                mIgnoreChanged = false;
+
+                Result r;
+                if (!watchTree(r, QString(), true)) {
+                    mResult = r;
+                }
+            }
+
+            if (mNeedsRescan) {
+                rescan();
+                return;
+            }
+
+            if (!mPending.isEmpty()) {
+                QStringList paths = mPending.toList();
+                mPending.clear();
+                update(paths);
+            }
+        }
+
+        static void emitChanges(StatusMonitor* owner, const QVector<StatusChange>& changes)
+        {
+            foreach (const StatusChange& change, changes) {
+                emit owner->fileStatusChanged(change.path, change.oldStatus, change.newStatus);
+            }
+        }
+
+        void StatusMonitorPrivate::rescan()
+        {
+            mPending.clear();
+            mNeedsRescan = false;
+
+            Result r;
+            StatusHash fresh = mRepo.status(r, mOpts);
+            if (!r) {
+                mResult = r;
+                return;
+            }
+
+            QVector<StatusChange> changes;
+
+            for (QMap<QString, StatusFlags>::const_iterator it = mSnapshot.constBegin();
+                 it != mSnapshot.constEnd(); ++it) {
+                if (!fresh.contains(it.key())) {
+                    StatusChange change = { it.key(), it.value(), FileInvalidStatus };
+                    changes.append(change);
+                }
+            }
+
+            QMap<QString, StatusFlags> snapshot;
+
+            for (StatusHash::const_iterator it = fresh.constBegin(); it != fresh.constEnd(); ++it) {
+                StatusFlags old = mSnapshot.value(it.key(), FileInvalidStatus);
+                if (old != it.value()) {
+                    StatusChange change = { it.key(), old, it.value() };
+                    changes.append(change);
+                }
+                snapshot.insert(it.key(), it.value());
+            }
+
+            mSnapshot = snapshot;
+
+            emitChanges(mOwner, changes);
+            emit mOwner->rescanned();
+        }
+
+        /**
+         * @internal
+         * @brief       Can a partial update of @a relPaths miss a rename?
+         *
+         * libgit2 only finds a rename if both of its sides are part of the pathspec. But we
+         * don't know the other side: It might have changed before the last flush and a renamed
+         * entry in the snapshot doesn't tell its old path.
+         *
+         * @return      `true` if any of the paths is or was new, deleted or renamed.
+         */
+        bool StatusMonitorPrivate::touchesRename(const QStringList& relPaths,
+                                                 const StatusHash& fresh) const
+        {
+            const StatusFlags sides = FileIndexNew | FileIndexDeleted | FileIndexRenamed |
+                                      FileWorkingTreeNew | FileWorkingTreeDeleted |
+                                      FileWorkingTreeRenamed;
+
+            for (StatusHash::const_iterator it = fresh.constBegin(); it != fresh.constEnd(); ++it) {
+                if (it.value() & sides) {
+                    return true;
+                }
+            }
+
+            foreach (const QString& path, relPaths) {
+                if (mSnapshot.value(path) & sides) {
+                    return true;
+                }
+
+                QString prefix = path + QLatin1Char('/');
+                QMap<QString, StatusFlags>::const_iterator it = mSnapshot.lowerBound(prefix);
+
+                while (it != mSnapshot.constEnd() && it.key().startsWith(prefix)) {
+                    if (it.value() & sides) {
+                        return true;
+                    }
+                    ++it;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * @internal
+         * @brief       Ask for the status of some paths and update the snapshot
+         *
+         * The paths are used as literal pathspec; a directory covers everything below it. So a
+         * snapshot entry that is equal to or below one of the paths but is not reported anymore
+         * has gone back to an unreported state.
+         *
+         * With rename detection turned on, a change that might be part of a rename makes this a
+         * full rescan; see touchesRename().
+         */
+        void StatusMonitorPrivate::update(const QStringList& relPaths)
+        {
+            StatusOptions opts = mOpts;
+            opts.setPathSpec(relPaths);
+            opts.setPathSpecIsLiteral(true);
+
+            Result r;
+            StatusHash fresh = mRepo.status(r, opts);
+            if (!r) {
+                mResult = r;
+                return;
+            }
+
+            if (mOpts.renameDetection() != StatusOptions::RenamesNone &&
+                    touchesRename(relPaths, fresh)) {
+                rescan();
+                return;
+            }
+
+            QVector<StatusChange> changes;
+
+            foreach (const QString& path, relPaths) {
+                QMap<QString, StatusFlags>::iterator it = mSnapshot.find(path);
+                if (it != mSnapshot.end() && !fresh.contains(path)) {
+                    StatusChange change = { path, it.value(), FileInvalidStatus };
+                    changes.append(change);
+                    mSnapshot.erase(it);
+                }
+
+                QString prefix = path + QLatin1Char('/');
+                it = mSnapshot.lowerBound(prefix);
+
+                while (it != mSnapshot.end() && it.key().startsWith(prefix)) {
+                    if (fresh.contains(it.key())) {
+                        ++it;
+                        continue;
+                    }
+
+                    StatusChange change = { it.key(), it.value(), FileInvalidStatus };
+                    changes.append(change);
+                    it = mSnapshot.erase(it);
+                }
+            }
+
+            for (StatusHash::const_iterator it = fresh.constBegin(); it != fresh.constEnd(); ++it) {
+                StatusFlags& current = mSnapshot[it.key()];
+                if (current != it.value()) {
+                    StatusChange change = { it.key(), current, it.value() };
+                    changes.append(change);
+                    current = it.value();
+                }
+            }
+
+            emitChanges(mOwner, changes);
+        }
+
+    }
+
+    /**
+     * @brief       Constructor
+     *
+     * @param[in]   repo    The repository whose working tree shall be monitored
+     *
+     * @param[in]   opts    Options that define which files are part of the status. The pathspec
+     *                      is not used.
+     *
+     * @param[in]   parent  The parent QObject
+     *
+     * The monitor does nothing until start() is called.
+     */
+    StatusMonitor::StatusMonitor(const Repository& repo, const StatusOptions& opts,
+                                 QObject* parent)
+        : QObject(parent)
+        , d(new Internal::StatusMonitorPrivate(this, repo, opts))
+    {
+    }
+
+    StatusMonitor::~StatusMonitor()
+    {
+        delete d;
+    }
+
+    /**
+     * @brief           Take the status snapshot and start watching the working tree
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @return          `true` if the monitor is running.
+     *
+     * No signals are emitted for the initial snapshot; use status() to get it.
+     */
+    bool StatusMonitor::start(Result& result)
+    {
+        GW_CHECK_RESULT(result, false);
+
+        if (d->mRunning) {
+            return true;
+        }
+
+        if (!d->mRepo.isValid()) {
+            result.setInvalidObject();
+            return false;
+        }
+
+        if (d->mRepo.isBare()) {
+            result.setError("A bare repository has no working tree to monitor.", GIT_ERROR);
+            return false;
+        }
+
+        d->mWorkDir = QDir::cleanPath(d->mRepo.workTreePath()) + QLatin1Char('/');
+        d->mGitDir = QDir::cleanPath(d->mRepo.path()) + QLatin1Char('/');
+        d->mRelGitDir = d->mGitDir.startsWith(d->mWorkDir)
+                ? d->relativePath(d->mGitDir) : QString();
+
+        // Watch first, so nothing that changes while the snapshot is taken gets lost.
+        if (!d->startWatching(result)) {
+            d->stopWatching();
+            return false;
+        }
+
+        StatusHash sh = d->mRepo.status(result, d->mOpts);
+        if (!result) {
+            d->stopWatching();
+            return false;
+        }
+
+        d->mSnapshot.clear();
+        for (StatusHash::const_iterator it = sh.constBegin(); it != sh.constEnd(); ++it) {
+            d->mSnapshot.insert(it.key(), it.value());
+        }
+
+        d->mResult = Result();
+        d->mRunning = true;
+        return true;
+    }
+
+    /**
+     * @brief       Stop watching the working tree
+     *
+     * The last known status is kept.
+     */
+    void StatusMonitor::stop()
+    {
+        d->stopWatching();
+        d->mRunning = false;
+    }
+
+    bool StatusMonitor::isRunning() const
+    {
+        return d->mRunning;
+    }
+
+    /**
+     * @brief       The last known status of all reported files
+     */
+    StatusHash StatusMonitor::status() const
+    {
+        StatusHash sh;
+        sh.reserve(d->mSnapshot.count());
+
+        for (QMap<QString, StatusFlags>::const_iterator it = d->mSnapshot.constBegin();
+             it != d->mSnapshot.constEnd(); ++it) {
+            sh.insert(it.key(), it.value());
+        }
+
+        return sh;
+    }
+
+    /**
+     * @brief       The last known status of a single file
+     *
+     * @param[in]   path    The path of the file, relative to the working tree
+     *
+     * @return      The status or `FileInvalidStatus` if the file is not reported.
+     */
+    StatusFlags StatusMonitor::status(const QString& path) const
+    {
+        return d->mSnapshot.value(path, FileInvalidStatus);
+    }
+
+    /**
+     * @brief       The last error that happened while the monitor was running
+     *
+     * Errors while updating the status do not stop the monitor.
+     */
+    Result StatusMonitor::result() const
+    {
+        return d->mResult;
+    }
+
+    /**
+     * @brief       Take a new snapshot of the whole working tree
+     *
+     * fileStatusChanged() is emitted for every difference to the previous snapshot.
+     */
+    void StatusMonitor::rescan()
+    {
+        if (d->mRunning) {
+            d->rescan();
+        }
+    }
+
+    void StatusMonitor::readEvents()
+    {
+        d->readEvents();
+    }
+
+    void StatusMonitor::directoryChanged(const QString& path)
+    {
+        d->directoryChanged(path);
+    }
+
+    void StatusMonitor::flushPending()
+    {
+        d->flush();
+    }
+
+    /**
+     * @fn          StatusMonitor::fileStatusChanged
+     * @brief       The status of a file has changed
+     *
+     * @param[in]   path        The path of the file, relative to the working tree
+     *
+     * @param[in]   oldStatus   The status before the change; `FileInvalidStatus` if the file was
+     *                          not reported before
+     *
+     * @param[in]   newStatus   The new status; `FileInvalidStatus` if the file is not reported
+     *                          anymore (i.e. it is unmodified now or was removed)
+     */
+
+}
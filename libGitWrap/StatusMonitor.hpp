@@ -0,0 +1,91 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+
+#include "libGitWrap/Repository.hpp"
+#include "libGitWrap/Result.hpp"
+#include "libGitWrap/StatusOptions.hpp"
+
+namespace Git
+{
+
+    namespace Internal
+    {
+        class StatusMonitorPrivate;
+    }
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Keeps the status of a working tree up to date by watching the file system
+     *
+     * start() takes a status snapshot once and then watches the working tree and the index.
+     * When files change, only the changed paths are asked for their status again. For each path
+     * whose status differs from the snapshot, fileStatusChanged() is emitted.
+     *
+     * A full rescan is only done when the index, HEAD, the ref of the current branch or an ignore
+     * file (a `.gitignore` or `info/exclude`) changes, or when the monitor could not keep up with
+     * the file system events. With rename detection turned on, a file that is or was new, deleted
+     * or renamed causes a rescan, too. Every rescan ends with rescanned().
+     *
+     * The pathspec of the StatusOptions is not used; the monitor always covers the whole working
+     * tree. Unless ignored files are included, ignored directories are not watched at all; when
+     * the ignore rules change, directories that are no longer ignored get watched.
+     *
+     * On Linux, the monitor uses inotify directly and thus knows the name of every changed file.
+     * Elsewhere it falls back to QFileSystemWatcher, which only tells which directory changed;
+     * the status of that directory is then looked at as a whole.
+     *
+     * The monitor works in the thread it lives in and needs a running event loop there.
+     */
+    class GITWRAP_API StatusMonitor : public QObject
+    {
+        Q_OBJECT
+    public:
+        StatusMonitor(const Repository& repo, const StatusOptions& opts = StatusOptions(),
+                      QObject* parent = 0);
+        ~StatusMonitor();
+
+    public:
+        bool start(Result& result);
+        void stop();
+        bool isRunning() const;
+
+        StatusHash status() const;
+        StatusFlags status(const QString& path) const;
+
+        Result result() const;
+
+    public slots:
+        void rescan();
+
+    signals:
+        void fileStatusChanged(const QString& path, Git::StatusFlags oldStatus,
+                               Git::StatusFlags newStatus);
+        void rescanned();
+
+    private slots:
+        void readEvents();
+        void directoryChanged(const QString& path);
+        void flushPending();
+
+    private:
+        Internal::StatusMonitorPrivate* d;
+    };
+
+}
@@ -0,0 +1,50 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "libGitWrap/StatusOptions.hpp"
+
+namespace Git
+{
+
+    StatusOptions::StatusOptions()
+        : mShow(ShowIndexAndWorkingTree)
+        , mUntrackedMode(UntrackedNormal)
+        , mRenames(RenamesNone)
+        , mPathSpecIsLiteral(false)
+        , mIncludeUnmodified(false)
+        , mIncludeIgnored(false)
+        , mRecurseIgnoredDirs(false)
+        , mExcludeSubmodules(false)
+    {
+    }
+
+    /**
+     * @brief       Options that report every file of the working tree
+     *
+     * This includes unmodified and ignored files and recurses into untracked directories. These
+     * are the options that Repository::status(Result&) uses.
+     *
+     * @return      The options
+     */
+    StatusOptions StatusOptions::allFiles()
+    {
+        StatusOptions opts;
+        opts.setIncludeUnmodified(true);
+        opts.setIncludeIgnored(true);
+        opts.setUntrackedMode(UntrackedAll);
+        return opts;
+    }
+
+}
@@ -0,0 +1,110 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "libGitWrap/GitWrap.hpp"
+
+namespace Git
+{
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Options that control which files Repository::status() reports
+     *
+     * A default constructed StatusOptions object answers the question "what is dirty?": It
+     * reports changes between HEAD, the index and the working tree plus untracked files, but
+     * neither unmodified nor ignored files. The work (and memory) needed for such a query is
+     * proportional to the number of changes and not to the size of the working tree.
+     *
+     * Use allFiles() to get a status entry for every single file.
+     */
+    class GITWRAP_API StatusOptions
+    {
+    public:
+        enum Show
+        {
+            ShowIndexAndWorkingTree,
+            ShowIndexOnly,
+            ShowWorkingTreeOnly
+        };
+
+        enum UntrackedMode
+        {
+            /** Don't report untracked files */
+            UntrackedNone,
+
+            /** Report untracked files; an untracked directory is reported as a single entry */
+            UntrackedNormal,
+
+            /** Report every single untracked file, even in untracked directories */
+            UntrackedAll
+        };
+
+        enum RenameDetection
+        {
+            RenamesNone                 = 0,
+            RenamesHeadToIndex          = (1 << 0),
+            RenamesIndexToWorkingTree   = (1 << 1),
+            RenamesBoth                 = RenamesHeadToIndex | RenamesIndexToWorkingTree
+        };
+
+    public:
+        StatusOptions();
+
+    public:
+        static StatusOptions allFiles();
+
+    public:
+        QStringList pathSpec() const                    { return mPathSpec; }
+        void setPathSpec(const QStringList& pathSpec)   { mPathSpec = pathSpec; }
+
+        bool pathSpecIsLiteral() const                  { return mPathSpecIsLiteral; }
+        void setPathSpecIsLiteral(bool literal)         { mPathSpecIsLiteral = literal; }
+
+        Show show() const                               { return mShow; }
+        void setShow(Show show)                         { mShow = show; }
+
+        bool includeUnmodified() const                  { return mIncludeUnmodified; }
+        void setIncludeUnmodified(bool include)         { mIncludeUnmodified = include; }
+
+        bool includeIgnored() const                     { return mIncludeIgnored; }
+        void setIncludeIgnored(bool include)            { mIncludeIgnored = include; }
+
+        bool recurseIgnoredDirs() const                 { return mRecurseIgnoredDirs; }
+        void setRecurseIgnoredDirs(bool recurse)        { mRecurseIgnoredDirs = recurse; }
+
+        bool excludeSubmodules() const                  { return mExcludeSubmodules; }
+        void setExcludeSubmodules(bool exclude)         { mExcludeSubmodules = exclude; }
+
+        UntrackedMode untrackedMode() const             { return mUntrackedMode; }
+        void setUntrackedMode(UntrackedMode mode)       { mUntrackedMode = mode; }
+
+        RenameDetection renameDetection() const         { return mRenames; }
+        void setRenameDetection(RenameDetection r)      { mRenames = r; }
+
+    private:
+        QStringList     mPathSpec;
+        Show            mShow;
+        UntrackedMode   mUntrackedMode;
+        RenameDetection mRenames;
+        bool            mPathSpecIsLiteral  : 1;
+        bool            mIncludeUnmodified  : 1;
+        bool            mIncludeIgnored     : 1;
+        bool            mRecurseIgnoredDirs : 1;
+        bool            mExcludeSubmodules  : 1;
+    };
+
+}
@@ -16,14 +16,23 @@
  *
  */
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <QVarLengthArray>
+
 #include "libGitWrap/Tree.hpp"
 #include "libGitWrap/TreeEntry.hpp"
+#include "libGitWrap/TreeEntryView.hpp"
+#include "libGitWrap/TreeVisitor.hpp"
 #include "libGitWrap/Repository.hpp"
 
 #include "libGitWrap/Private/ObjectPrivate.hpp"
 #include "libGitWrap/Private/RepositoryPrivate.hpp"
 #include "libGitWrap/Private/TreeEntryPrivate.hpp"
 #include "libGitWrap/Private/TreePrivate.hpp"
+#include "libGitWrap/Private/TreeWalker.hpp"
 
 namespace Git
 {
@@ -53,10 +62,127 @@ namespace Git
             return otTree;
         }
 
+        /**
+         * @internal
+         * @brief       Implementation of Tree::lookupPaths()
+         *
+         * The paths are resolved in sorted order, so all paths below a directory come one after
+         * the other. The trees of the current directory and its parents are kept on a stack;
+         * each directory is thus looked up only once, no matter how many paths are in it.
+         */
+        class TreePathResolver
+        {
+        private:
+            struct Level
+            {
+                QByteArray      name;
+                git_tree*       tree;
+            };
+
+        public:
+            TreePathResolver(git_repository* repo, const git_tree* root)
+                : mRepo(repo)
+                , mRoot(root)
+            {
+            }
+
+            ~TreePathResolver()
+            {
+                popTo(0);
+            }
+
+        public:
+            bool resolve(Result& result, const QByteArray& path, TreePathInfo& info);
+
+        private:
+            const git_tree* top() const
+            {
+                return mLevels.empty() ? mRoot : mLevels.back().tree;
+            }
+
+            void popTo(size_t depth)
+            {
+                while (mLevels.size() > depth) {
+                    git_tree_free(mLevels.back().tree);
+                    mLevels.pop_back();
+                }
+            }
+
+            const git_tree_entry* entryOf(const git_tree* tree, const char* name, int length)
+            {
+                mName.resize(length + 1);
+                std::memcpy(mName.data(), name, size_t(length));
+                mName[length] = '\0';
+                return git_tree_entry_byname(tree, mName.constData());
+            }
+
+        private:
+            git_repository*             mRepo;
+            const git_tree*             mRoot;
+            std::vector<Level>          mLevels;
+            QVarLengthArray<char, 256>  mName;
+        };
+
+        bool TreePathResolver::resolve(Result& result, const QByteArray& path, TreePathInfo& info)
+        {
+            const char* p = path.constData();
+            int length = path.length();
+            int start = 0;
+            size_t depth = 0;
+
+            for (int slash = path.indexOf('/'); slash != -1; slash = path.indexOf('/', start)) {
+                int compLength = slash - start;
+
+                if (depth < mLevels.size()) {
+                    const QByteArray& open = mLevels[depth].name;
+                    if (open.length() == compLength && !std::memcmp(open.constData(), p + start,
+                                                                     size_t(compLength))) {
+                        ++depth;
+                        start = slash + 1;
+                        continue;
+                    }
+                    popTo(depth);
+                }
+
+                const git_tree_entry* entry = entryOf(top(), p + start, compLength);
+                if (!entry || git_tree_entry_type(entry) != GIT_OBJ_TREE) {
+                    return true;
+                }
+
+                Level level;
+                level.name = QByteArray(p + start, compLength);
+                result = git_tree_lookup(&level.tree, mRepo, git_tree_entry_id(entry));
+                GW_CHECK_RESULT(result, false);
+
+                mLevels.push_back(level);
+                ++depth;
+                start = slash + 1;
+            }
+
+            popTo(depth);
+
+            const git_tree_entry* entry = entryOf(top(), p + start, length - start);
+            if (entry) {
+                info.found = true;
+                info.id = ObjectId::fromRaw(git_tree_entry_id(entry)->id);
+                info.mode = FileModes(git_tree_entry_filemode(entry));
+                info.type = gitotype2ObjectType(git_tree_entry_type(entry));
+            }
+
+            return true;
+        }
+
     }
 
     GW_PRIVATE_IMPL(Tree, Object)
 
+    TreePathInfo::TreePathInfo()
+        : found(false)
+        , mode(UnkownAttr)
+        , type(otAny)
+    {
+    }
+
     Tree Tree::subPath(Result& result , const QString& pathName) const
     {
         GW_CD_CHECKED(Tree, Tree(), result);
@@ -80,12 +206,196 @@ namespace Git
         return new Tree::Private(d->repo(), subObject);
     }
 
+    /**
+     * @brief           Walk this tree recursively
+     *
+     * The walk reads every subtree exactly once and reuses one path buffer for all entries. No
+     * wrapper object and no QString is created for an entry.
+     *
+     * @param[in,out]   result      A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       visitor     Gets every entry of the walk.
+     *
+     * @param[in]       order       Whether a tree is reported before (pre-order) or after
+     *                              (post-order) its entries.
+     *
+     * @param[in]       flags       Kinds of entries not to report. Trees are walked into, even
+     *                              if they are not reported.
+     *
+     * @param[in]       pathPrefix  If not empty, only the entry at this path and, if it is a tree,
+     *                              everything below it is walked. The trees on the way to it are
+     *                              neither read entirely nor reported.
+     *
+     * @return          `true` if the walk went through, `false` if it failed or was stopped by the
+     *                  visitor. A path prefix that doesn't exist is not an error.
+     */
+    bool Tree::walk(Result& result, TreeVisitor* visitor, TreeWalkOrder order,
+                    TreeWalkFlags flags, const QString& pathPrefix) const
+    {
+        GW_CD_CHECKED(Tree, false, result);
+
+        if (!visitor) {
+            result.setError("No visitor given to walk the tree.", GIT_ERROR);
+            return false;
+        }
+
+        Internal::TreeWalker walker(d->repo()->mRepo, visitor, order, flags);
+
+        QByteArray prefix = GW_EncodeQString(pathPrefix);
+        while (prefix.endsWith('/')) {
+            prefix.chop(1);
+        }
+        while (prefix.startsWith('/')) {
+            prefix.remove(0, 1);
+        }
+
+        if (prefix.isEmpty()) {
+            return walker.walkTree(result, d->o(), 0);
+        }
+
+        git_tree_entry* entry = nullptr;
+        int rc = git_tree_entry_bypath(&entry, d->o(), prefix.constData());
+        if (rc == GIT_ENOTFOUND) {
+            return true;
+        }
+
+        result = rc;
+        GW_CHECK_RESULT(result, false);
+
+        int slash = prefix.lastIndexOf('/');
+        walker.setBase(prefix.left(slash + 1));
+
+        bool completed = walker.visitEntry(result, entry, prefix.count('/'));
+        git_tree_entry_free(entry);
+
+        return completed;
+    }
+
+    /**
+     * @brief           Walk this tree recursively, with subtrees being read in parallel
+     *
+     * The trees at @a splitDepth are handed out to GitWrap's worker threads one by one. Each
+     * thread uses its own repository handle. For a tree with many big subtrees, this is much
+     * faster than walk() as long as the objects are not in memory yet; for a small tree, it is
+     * slower.
+     *
+     * By default, the visitor gets the entries on the calling thread in the very same order as
+     * with walk(). To do that, the entries of each subtree at @a splitDepth are buffered until
+     * the subtrees before it were handed to the visitor. The threads don't read further ahead
+     * than a few subtrees each, so the buffers stay small.
+     *
+     * With TreeWalkUnordered in @a flags, the worker threads call the visitor as soon as they find
+     * an entry. The visitor must then be thread safe; the order is only kept within each subtree
+     * at @a splitDepth. Either way, if the visitor returns TreeVisitor::Stop, no further entries
+     * are reported.
+     *
+     * @param[in,out]   result      A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       visitor     Gets every entry of the walk.
+     *
+     * @param[in]       order       Whether a tree is reported before or after its entries.
+     *
+     * @param[in]       flags       Kinds of entries not to report and whether to report them
+     *                              unordered.
+     *
+     * @param[in]       splitDepth  The depth of the trees that become the units of work. `1`
+     *                              means the trees in this tree. Use a higher value, if there are
+     *                              only a few top level directories.
+     *
+     * @return          `true` if the walk went through, `false` if it failed or was stopped by the
+     *                  visitor.
+     */
+    bool Tree::parallelWalk(Result& result, TreeVisitor* visitor, TreeWalkOrder order,
+                            TreeWalkFlags flags, int splitDepth) const
+    {
+        GW_CD_CHECKED(Tree, false, result);
+
+        if (!visitor) {
+            result.setError("No visitor given to walk the tree.", GIT_ERROR);
+            return false;
+        }
+
+        Internal::ParallelTreeWalker walker(d->repo(), visitor, order, flags, splitDepth);
+        return walker.walk(result, d->o());
+    }
+
+    /**
+     * @brief           Look up many paths at once
+     *
+     * This is much cheaper than calling subPath() for each directory of each path: No wrapper
+     * objects are created and every directory is read only once, even if many of the paths are
+     * in it.
+     *
+     * @param[in,out]   result  A Result object; see @ref GitWrapErrorHandling
+     *
+     * @param[in]       paths   The paths to look up, relative to this tree, with `/` as the
+     *                          separator.
+     *
+     * @return          One TreePathInfo for each of @a paths, in the same order. Paths that
+     *                  don't exist are not an error; TreePathInfo::found is `false` for them. On
+     *                  failure, an empty list is returned.
+     */
+    TreePathInfoList Tree::lookupPaths(Result& result, const QStringList& paths) const
+    {
+        GW_CD_CHECKED(Tree, TreePathInfoList(), result);
+
+        QVector<QByteArray> encoded;
+        encoded.reserve(paths.count());
+
+        foreach (const QString& path, paths) {
+            QByteArray utf8 = GW_EncodeQString(path);
+            while (utf8.startsWith('/')) {
+                utf8.remove(0, 1);
+            }
+            while (utf8.endsWith('/')) {
+                utf8.chop(1);
+            }
+            encoded.append(utf8);
+        }
+
+        std::vector<int> order(size_t(encoded.count()));
+        for (int i = 0; i < encoded.count(); ++i) {
+            order[size_t(i)] = i;
+        }
+
+        std::sort(order.begin(), order.end(), [&encoded](int a, int b) {
+            return encoded.at(a) < encoded.at(b);
+        });
+
+        TreePathInfoList infos(paths.count());
+        Internal::TreePathResolver resolver(d->repo()->mRepo, d->o());
+
+        for (size_t i = 0; i < order.size(); ++i) {
+            int index = order[i];
+            const QByteArray& path = encoded.at(index);
+
+            if (!path.isEmpty() && !resolver.resolve(result, path, infos[index])) {
+                return TreePathInfoList();
+            }
+        }
+
+        return infos;
+    }
+
     size_t Tree::entryCount() const
     {
         GW_CD(Tree);
         return d ? git_tree_entrycount(d->o()) : 0;
     }
 
+    /**
+     * @brief       Get the entries of this tree as a range of non-owning views
+     *
+     * This is the cheap way to look at the entries: Neither the range nor the views allocate.
+     *
+     * @return      The entries; the range is empty if this tree is invalid.
+     */
+    TreeEntries Tree::entries() const
+    {
+        GW_CD(Tree);
+        return d ? TreeEntries(*this) : TreeEntries();
+    }
+
     TreeEntry Tree::entryAt( size_t index ) const
     {
         GW_CD(Tree);
@@ -93,8 +403,7 @@ namespace Git
         if(!d) {
             return TreeEntry();
         }
-        const git_tree_entry* entry = git_tree_entry_byindex(d->o(), index);
-        return new TreeEntry::Private(entry);
+        return entries().at(index).toTreeEntry();
     }
 
     TreeEntry Tree::entry(const QString& fileName) const
@@ -105,8 +414,7 @@ namespace Git
             return TreeEntry();
         }
 
-        const git_tree_entry* entry = git_tree_entry_byname(d->o(), GW_StringFromQt(fileName));
-        return new TreeEntry::Private(entry);
+        return entries().find(fileName).toTreeEntry();
     }
 
     TreeEntry Tree::operator[](const QString& fileName) const
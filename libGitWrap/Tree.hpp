@@ -19,6 +19,7 @@
 #pragma once
 
 #include "libGitWrap/Object.hpp"
+#include "libGitWrap/ObjectId.hpp"
 #include "libGitWrap/Diff.hpp"
 #include "libGitWrap/DiffList.hpp"
 
@@ -33,6 +34,24 @@ namespace Git
         class TreePrivate;
     }
 
+    /**
+     * @ingroup     GitWrap
+     * @brief       What Tree::lookupPaths() found for one path
+     */
+    struct GITWRAP_API TreePathInfo
+    {
+        TreePathInfo();
+
+        /** `false` if there is no entry at the path */
+        bool        found;
+
+        ObjectId    id;
+        FileModes   mode;
+        ObjectType  type;
+    };
+
+    typedef QVector< TreePathInfo > TreePathInfoList;
+
     /**
      * @ingroup     GitWrap
      * @brief       Represents a git tree object
@@ -44,6 +63,15 @@ namespace Git
 
     public:
         Tree subPath(Result& result, const QString& pathName) const;
+        TreePathInfoList lookupPaths(Result& result, const QStringList& paths) const;
+
+        bool walk(Result& result, TreeVisitor* visitor, TreeWalkOrder order = TreeWalkPreOrder,
+                  TreeWalkFlags flags = TreeWalkNone, const QString& pathPrefix = QString()) const;
+        bool parallelWalk(Result& result, TreeVisitor* visitor,
+                          TreeWalkOrder order = TreeWalkPreOrder,
+                          TreeWalkFlags flags = TreeWalkNone, int splitDepth = 1) const;
+
+        TreeEntries entries() const;
 
         size_t entryCount() const;
         TreeEntry entryAt( size_t index ) const;
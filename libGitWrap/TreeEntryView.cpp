@@ -0,0 +1,181 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libGitWrap/TreeEntryView.hpp"
+
+#include "libGitWrap/Private/TreeEntryPrivate.hpp"
+#include "libGitWrap/Private/TreePrivate.hpp"
+
+namespace Git
+{
+
+    static inline const git_tree_entry* treeEntryOf(const void* entry)
+    {
+        return static_cast<const git_tree_entry*>(entry);
+    }
+
+    /**
+     * @brief       Create an invalid view
+     */
+    TreeEntryView::TreeEntryView()
+        : mTree(nullptr)
+        , mEntry(nullptr)
+    {
+    }
+
+    TreeEntryView::TreeEntryView(const Tree* tree, const void* entry)
+        : mTree(entry ? tree : nullptr)
+        , mEntry(entry)
+    {
+    }
+
+    bool TreeEntryView::isValid() const
+    {
+        return mEntry != nullptr;
+    }
+
+    /**
+     * @brief       The entry's name as UTF-8, without copying it
+     *
+     * @return      The name, which is owned by the tree; or `nullptr` for an invalid view.
+     */
+    const char* TreeEntryView::rawName() const
+    {
+        return mEntry ? git_tree_entry_name(treeEntryOf(mEntry)) : nullptr;
+    }
+
+    /**
+     * @brief       The entry's name
+     *
+     * This creates a QString; prefer rawName() when looking at many entries.
+     */
+    QString TreeEntryView::name() const
+    {
+        return mEntry ? GW_StringToQt(git_tree_entry_name(treeEntryOf(mEntry))) : QString();
+    }
+
+    ObjectId TreeEntryView::id() const
+    {
+        return mEntry ? ObjectId::fromRaw(git_tree_entry_id(treeEntryOf(mEntry))->id) : ObjectId();
+    }
+
+    /**
+     * @brief       The entry's id as raw SHA-1 bytes, without copying it
+     *
+     * @return      ObjectId::SHA1_Length bytes, owned by the tree; or `nullptr` for an invalid
+     *              view.
+     */
+    const unsigned char* TreeEntryView::rawId() const
+    {
+        return mEntry ? git_tree_entry_id(treeEntryOf(mEntry))->id : nullptr;
+    }
+
+    FileModes TreeEntryView::mode() const
+    {
+        return mEntry ? FileModes(git_tree_entry_filemode(treeEntryOf(mEntry))) : UnkownAttr;
+    }
+
+    ObjectType TreeEntryView::type() const
+    {
+        if (!mEntry) {
+            return otAny;
+        }
+
+        return Internal::gitotype2ObjectType(git_tree_entry_type(treeEntryOf(mEntry)));
+    }
+
+    /**
+     * @brief       The tree this entry belongs to
+     *
+     * Must not be called on an invalid view.
+     */
+    const Tree& TreeEntryView::tree() const
+    {
+        Q_ASSERT(mTree);
+        return *mTree;
+    }
+
+    /**
+     * @brief       Copy the entry into a TreeEntry, which does not depend on the tree
+     */
+    TreeEntry TreeEntryView::toTreeEntry() const
+    {
+        if (!mEntry) {
+            return TreeEntry();
+        }
+
+        git_tree_entry* entry = nullptr;
+        Result result;
+        result = git_tree_entry_dup(&entry, treeEntryOf(mEntry));
+        if (!result) {
+            return TreeEntry();
+        }
+
+        return new TreeEntry::Private(entry);
+    }
+
+    /**
+     * @brief       Create an empty range
+     */
+    TreeEntries::TreeEntries()
+        : mCount(0)
+    {
+    }
+
+    TreeEntries::TreeEntries(const Tree& tree)
+        : mTree(tree)
+        , mCount(tree.entryCount())
+    {
+    }
+
+    /**
+     * @brief       Get a view of the entry at @a index
+     *
+     * @return      The view or an invalid view if @a index is out of range.
+     */
+    TreeEntryView TreeEntries::at(size_t index) const
+    {
+        if (index >= mCount) {
+            return TreeEntryView();
+        }
+
+        const Tree::Private* d = Internal::BasePrivate::dataOf<Tree>(mTree);
+        return TreeEntryView(&mTree, git_tree_entry_byindex(d->o(), index));
+    }
+
+    /**
+     * @brief       Get a view of the entry with the name @a name
+     *
+     * @param[in]   name    The name of the entry as UTF-8
+     *
+     * @return      The view or an invalid view if there is no such entry.
+     */
+    TreeEntryView TreeEntries::find(const char* name) const
+    {
+        if (!mCount || !name) {
+            return TreeEntryView();
+        }
+
+        const Tree::Private* d = Internal::BasePrivate::dataOf<Tree>(mTree);
+        return TreeEntryView(&mTree, git_tree_entry_byname(d->o(), name));
+    }
+
+    TreeEntryView TreeEntries::find(const QString& name) const
+    {
+        return find(GW_StringFromQt(name));
+    }
+
+}
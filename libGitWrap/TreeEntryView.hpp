@@ -0,0 +1,137 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/Tree.hpp"
+#include "libGitWrap/TreeEntry.hpp"
+
+namespace Git
+{
+
+    class TreeEntries;
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       A borrowed, non-owning view of an entry in a tree
+     *
+     * Unlike TreeEntry, a view does not allocate anything. It simply points to the entry inside
+     * of the tree and is thus only valid as long as the tree it came from is alive. Use
+     * toTreeEntry() to get an entry that can be kept.
+     *
+     * @see         Tree::entries()
+     */
+    class GITWRAP_API TreeEntryView
+    {
+        friend class TreeEntries;
+
+    public:
+        TreeEntryView();
+
+    private:
+        TreeEntryView(const Tree* tree, const void* entry);
+
+    public:
+        bool isValid() const;
+
+        const char* rawName() const;
+        QString name() const;
+
+        ObjectId id() const;
+        const unsigned char* rawId() const;
+
+        FileModes mode() const;
+        ObjectType type() const;
+
+        const Tree& tree() const;
+        TreeEntry toTreeEntry() const;
+
+    private:
+        const Tree*     mTree;
+        const void*     mEntry;
+    };
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       The entries of a tree, to be iterated with a range based for
+     *
+     * The range keeps its tree alive; the views it hands out are valid as long as the range is.
+     *
+     * @code
+     * for (Git::TreeEntryView entry : tree.entries()) {
+     *     if (entry.type() == Git::otTree) { ... }
+     * }
+     * @endcode
+     */
+    class GITWRAP_API TreeEntries
+    {
+        friend class Tree;
+
+    public:
+        class const_iterator
+        {
+            friend class TreeEntries;
+
+        private:
+            const_iterator(const TreeEntries* entries, size_t index)
+                : mEntries(entries)
+                , mIndex(index)
+            {
+            }
+
+        public:
+            TreeEntryView operator*() const             { return mEntries->at(mIndex); }
+            const_iterator& operator++()                { ++mIndex; return *this; }
+
+            bool operator==(const const_iterator& other) const
+            {
+                return mIndex == other.mIndex;
+            }
+
+            bool operator!=(const const_iterator& other) const
+            {
+                return mIndex != other.mIndex;
+            }
+
+        private:
+            const TreeEntries*  mEntries;
+            size_t              mIndex;
+        };
+
+    public:
+        TreeEntries();
+
+    private:
+        TreeEntries(const Tree& tree);
+
+    public:
+        size_t count() const                            { return mCount; }
+        bool isEmpty() const                            { return mCount == 0; }
+
+        TreeEntryView at(size_t index) const;
+        TreeEntryView find(const char* name) const;
+        TreeEntryView find(const QString& name) const;
+
+        const_iterator begin() const                    { return const_iterator(this, 0); }
+        const_iterator end() const                      { return const_iterator(this, mCount); }
+
+    private:
+        Tree            mTree;
+        size_t          mCount;
+    };
+
+}
@@ -0,0 +1,42 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "libGitWrap/TreeVisitor.hpp"
+
+namespace Git
+{
+
+    TreeVisitor::TreeVisitor()
+    {
+    }
+
+    TreeVisitor::~TreeVisitor()
+    {
+    }
+
+    /**
+     * @fn          TreeVisitor::Action TreeVisitor::visit(const Entry& entry)
+     * @brief       Called for every entry of the walk
+     *
+     * In pre-order, a tree is reported before its entries and returning SkipSubtree keeps the
+     * walk from descending into it. In post-order, a tree is reported after its entries.
+     *
+     * @param[in]   entry   The entry; its path is only valid during the call.
+     *
+     * @return      What the walk shall do next.
+     */
+
+}
@@ -0,0 +1,73 @@
+/*
+ * libGitWrap - A Qt wrapper library for libgit2
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "libGitWrap/GitWrap.hpp"
+#include "libGitWrap/ObjectId.hpp"
+
+namespace Git
+{
+
+    /**
+     * @ingroup     GitWrap
+     * @brief       Callback interface for Tree::walk()
+     *
+     * The walk hands every entry to visit(). The entry's path is a UTF-8 buffer that the walk
+     * reuses for all entries; it is only valid during the call. Use Entry::filePath() to get a
+     * QString, but only where one is really needed.
+     *
+     * @see         Tree::walk()
+     */
+    class GITWRAP_API TreeVisitor
+    {
+    public:
+        enum Action
+        {
+            Continue,       ///< Go on with the next entry
+            SkipSubtree,    ///< Don't descend into this tree; only meaningful in pre-order
+            Stop            ///< End the walk
+        };
+
+        struct Entry
+        {
+            /** Path relative to the walked tree, UTF-8, NUL terminated */
+            const char*     path;
+            int             pathLength;
+
+            /** The last component of path; points into path */
+            const char*     name;
+
+            /** `0` for the entries of the walked tree itself */
+            int             depth;
+
+            ObjectType      type;
+            FileModes       mode;
+            ObjectId        id;
+
+            QString filePath() const    { return QString::fromUtf8(path, pathLength); }
+            QString fileName() const    { return QString::fromUtf8(name); }
+        };
+
+    public:
+        TreeVisitor();
+        virtual ~TreeVisitor();
+
+    public:
+        virtual Action visit(const Entry& entry) = 0;
+    };
+
+}
@@ -17,3 +17,210 @@ git add File1
 git commit File1 -m"First file" --author "$A"
 
 
+
+cd $base_dir
+mkdir NestedTreeRepo
+cd NestedTreeRepo
+git init
+mkdir -p dir/sub
+echo "a" >dir/a
+echo "b" >dir/sub/b
+echo "c" >c
+git add c dir
+git commit -m"Nested tree" --author "$A"
+
+
+
+cd $base_dir
+mkdir HistoryRepo
+cd HistoryRepo
+git init
+
+# commit <date> <message>
+commit() {
+    GIT_AUTHOR_DATE="$1" GIT_COMMITTER_DATE="$1" git commit -q -m"$2" --author "$A" "${@:3}"
+}
+
+echo "1" >a
+git add a
+commit "2015-01-01T12:00:00 +0000" "Add a"
+echo "1" >b
+git add b
+commit "2015-01-02T12:00:00 +0000" "Add b"
+echo "2" >a
+git add a
+commit "2015-01-03T12:00:00 +0000" "Change a"
+git checkout -q -b side
+echo "2" >b
+git add b
+commit "2015-01-04T12:00:00 +0000" "Change b on side"
+git checkout -q -
+echo "3" >a
+git add a
+commit "2015-01-05T12:00:00 +0000" "Change a again"
+GIT_AUTHOR_DATE="2015-01-06T12:00:00 +0000" GIT_COMMITTER_DATE="2015-01-06T12:00:00 +0000" \
+    git merge -q --no-ff side -m"Merge side"
+mkdir dir
+echo "1" >dir/c
+git add dir
+commit "2015-01-07T12:00:00 +0000" "Add dir/c"
+
+
+
+# A linear history whose committer dates are out of order, as if some clocks were wrong. Walking
+# from the tip, "Skewed late" comes after 4 commits older than 2015-02-01 and "Skewed early"
+# after 6 of them. The commits that are newer than 2015-02-01 change "f", the others "g".
+cd $base_dir
+mkdir SkewRepo
+cd SkewRepo
+git init
+git symbolic-ref HEAD refs/heads/master
+
+# edit <file> <date> <message>
+edit() {
+    echo "$3" >>"$1"
+    git add "$1"
+    commit "$2" "$3"
+}
+
+commit "2015-01-01T12:00:00 +0000" "Base" --allow-empty
+edit f "2015-02-10T12:00:00 +0000" "Skewed early"
+for i in 2 3 4 5 6 7; do
+    edit g "2015-01-0${i}T12:00:00 +0000" "Old $i"
+done
+edit f "2015-02-11T12:00:00 +0000" "Skewed late"
+for i in 10 11 12 13; do
+    edit g "2015-01-${i}T12:00:00 +0000" "Stale $i"
+done
+edit f "2015-02-20T12:00:00 +0000" "New 1"
+edit f "2015-02-21T12:00:00 +0000" "New 2"
+
+
+
+# A commit whose author and committer have neither name nor email. git itself refuses to create
+# one, so the object is written by hand.
+cd $base_dir
+mkdir EmptyIdentRepo
+cd EmptyIdentRepo
+git init
+tree=$(git mktree </dev/null)
+ident=" <> 1420070400 +0000"
+commit=$(printf 'tree %s\nauthor %s\ncommitter %s\n\nNo name\n' $tree "$ident" "$ident" |
+    git hash-object -t commit -w --stdin)
+git update-ref refs/heads/master $commit
+git symbolic-ref HEAD refs/heads/master
+
+
+
+cd $base_dir
+mkdir GraphRepo
+cd GraphRepo
+git init
+git symbolic-ref HEAD refs/heads/master
+
+# change <file> <message>
+change() {
+    echo "$2" >>"$1"
+    git add "$1"
+    git commit -q -m"$2" --author "$A"
+}
+
+change m "Main 1"
+git branch old
+change m "Main 2"
+git checkout -q -b topic
+change t "Topic 1"
+change t "Topic 2"
+git checkout -q -b fix old
+change f "Fix 1"
+git checkout -q -b extra old
+change e "Extra 1"
+change e "Extra 2"
+git checkout -q master
+change m "Main 3"
+git merge -q --no-ff topic fix extra -m"Octopus" >/dev/null
+change m "Main 4"
+git checkout -q topic
+change t "Topic 3"
+git checkout -q master
+git branch -q --set-upstream-to=master topic
+git branch -q --set-upstream-to=topic fix
+git branch -q --set-upstream-to=master extra
+
+cd $base_dir
+cp -r GraphRepo GraphRepoFull
+cd GraphRepoFull
+git commit-graph write --reachable
+
+# Two layers, written before "Main 4" and "Topic 3"; those two are not in the graph
+cd $base_dir
+cp -r GraphRepo GraphRepoSplit
+cd GraphRepoSplit
+git rev-parse topic~1 | git commit-graph write --split=no-merge --stdin-commits
+git rev-parse master~1 | git commit-graph write --split=no-merge --stdin-commits
+
+
+
+cd $base_dir
+mkdir BlobRepo
+cd BlobRepo
+git init
+seq 1 5000 >big.txt
+seq 1 4999 >delta.txt
+printf 'a\nb\n' >crlf.txt
+printf 'a\0b\n' >binary.bin
+printf '$Id$\nline\n' >ident.txt
+# Added before the attributes, so the CRLF is kept in the blob
+printf 'a\r\nb\n' >mixed.txt
+git add mixed.txt
+echo "crlf.txt eol=crlf" >.gitattributes
+echo "mixed.txt eol=crlf" >>.gitattributes
+echo "binary.bin eol=crlf" >>.gitattributes
+echo "ident.txt ident eol=crlf" >>.gitattributes
+git add big.txt delta.txt crlf.txt binary.bin ident.txt .gitattributes
+git commit -m"Blobs" --author "$A"
+
+# Packed, delta.txt is stored as a delta against big.txt
+cd $base_dir
+cp -r BlobRepo BlobRepoPacked
+cd BlobRepoPacked
+git gc -q
+
+
+
+# 16 * 16 * 32 files
+cd $base_dir
+mkdir BigTreeRepo
+cd BigTreeRepo
+git init
+for d in $(seq -w 1 16); do
+    for s in $(seq -w 1 16); do
+        mkdir -p dir$d/sub$s
+        for f in $(seq -w 1 32); do
+            echo "$d $s $f" >dir$d/sub$s/file$f
+        done
+    done
+done
+git add .
+git commit -q -m"Big tree" --author "$A"
+
+
+
+# 5000 commits, each changing one of 100 files in 10 directories; only used by the benchmarks
+cd $base_dir
+mkdir PathHistoryRepo
+cd PathHistoryRepo
+git init
+git symbolic-ref HEAD refs/heads/master
+for i in $(seq 1 5000); do
+    echo "commit refs/heads/master"
+    echo "committer $A $((1420070400 + i)) +0000"
+    echo "data <<EOM"
+    echo "Commit $i"
+    echo "EOM"
+    echo "M 100644 inline dir$((i % 10))/file$((i % 100))"
+    echo "data <<EOM"
+    echo "$i"
+    echo "EOM"
+    echo
+done | git fast-import --quiet
@@ -0,0 +1,36 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Infra/ObjectIds.hpp"
+
+Git::ObjectIdList makeIds(int count, quint32 seed)
+{
+    Git::ObjectIdList ids(count);
+
+    for (int i = 0; i < count; ++i) {
+        unsigned char* raw = ids[i].rawWritable();
+
+        for (int j = 0; j < Git::ObjectId::SHA1_Length; ++j) {
+            // xorshift
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            raw[j] = uchar(seed);
+        }
+    }
+
+    return ids;
+}
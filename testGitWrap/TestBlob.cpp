@@ -0,0 +1,298 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include "libGitWrap/Blob.hpp"
+#include "libGitWrap/BlobReader.hpp"
+#include "libGitWrap/Commit.hpp"
+#include "libGitWrap/Reference.hpp"
+#include "libGitWrap/Repository.hpp"
+#include "libGitWrap/Result.hpp"
+#include "libGitWrap/Tree.hpp"
+#include "libGitWrap/TreeEntry.hpp"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include "Infra/Fixture.hpp"
+#include "Infra/TempRepo.hpp"
+
+typedef Fixture BlobFixture;
+
+TEST_F(BlobFixture, ExposesContentWithoutCopying)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+
+    Git::Tree tree = head.tree(r);
+    CHECK_GIT_RESULT(r);
+
+    Git::Blob blob = repo.lookupBlob(r, tree.entry(QStringLiteral("File1")).sha1());
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(blob.isValid());
+
+    EXPECT_EQ(6, blob.rawSize(r));
+    EXPECT_FALSE(blob.isBinary(r));
+
+    Git::BlobContent content = blob.content(r);
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QByteArray("File1\n"), content.data());
+    EXPECT_EQ(blob.id(), content.blob().id());
+
+    // Both calls must refer to the very same buffer
+    EXPECT_EQ(content.constData(), blob.content(r).constData());
+
+    // The content keeps a temporary blob alive
+    Git::BlobContent fromTemporary = repo.lookupBlob(r, blob.id()).content(r);
+    CHECK_GIT_RESULT(r);
+    blob = Git::Blob();
+    content = Git::BlobContent();
+    EXPECT_EQ(QByteArray("File1\n"), fromTemporary.data());
+
+    QByteArray copy = fromTemporary.toByteArray();
+    EXPECT_NE(fromTemporary.constData(), copy.constData());
+    fromTemporary = Git::BlobContent();
+    EXPECT_EQ(QByteArray("File1\n"), copy);
+
+    Git::Blob invalid;
+    EXPECT_TRUE(invalid.content(r).isEmpty());
+    EXPECT_FALSE(r);
+}
+
+TEST_F(BlobFixture, ReaderStreamsContent)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+
+    Git::ObjectId id = head.tree(r).entry(QStringLiteral("File1")).sha1();
+    CHECK_GIT_RESULT(r);
+
+    Git::BlobReader reader(repo, id);
+    reader.setChunkSize(1);
+    ASSERT_TRUE(reader.open(QIODevice::ReadOnly));
+    EXPECT_TRUE(reader.result());
+    EXPECT_EQ(6, reader.size());
+    EXPECT_EQ(6, reader.bytesAvailable());
+
+    EXPECT_EQ(QByteArray("Fil"), reader.read(3));
+    EXPECT_EQ(QByteArray("e1\n"), reader.readAll());
+    EXPECT_TRUE(reader.atEnd());
+    reader.close();
+
+    Git::BlobReader filtered(repo, id, QStringLiteral("File1"));
+    EXPECT_TRUE(filtered.isFiltered());
+    ASSERT_TRUE(filtered.open(QIODevice::ReadOnly));
+    EXPECT_EQ(QByteArray("File1\n"), filtered.readAll());
+
+    Git::BlobReader missing(repo, Git::ObjectId());
+    EXPECT_FALSE(missing.open(QIODevice::ReadOnly));
+    EXPECT_FALSE(missing.result());
+
+    Git::BlobReader writable(repo, id);
+    EXPECT_FALSE(writable.open(QIODevice::ReadWrite));
+}
+
+static QByteArray readInPieces(Git::BlobReader& reader, int pieceSize)
+{
+    QByteArray data;
+    while (!reader.atEnd()) {
+        QByteArray piece = reader.read(pieceSize);
+        if (piece.isEmpty()) {
+            break;
+        }
+        data += piece;
+    }
+    return data;
+}
+
+TEST_F(BlobFixture, ReaderStreamsLargeBlobs)
+{
+    QByteArray expected;
+    for (int i = 1; i <= 5000; ++i) {
+        expected += QByteArray::number(i) + '\n';
+    }
+
+    const char* repoNames[] = { "BlobRepo", "BlobRepoPacked" };
+
+    for (int i = 0; i < 2; ++i) {
+        Git::Result r;
+        Git::Repository repo( TempRepoOpener(this, repoNames[i], r) );
+        CHECK_GIT_RESULT(r);
+        ASSERT_TRUE(repo.isValid());
+
+        Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo,
+                                                                          QStringLiteral("HEAD")));
+        CHECK_GIT_RESULT(r);
+
+        Git::ObjectId id = head.tree(r).entry(QStringLiteral("big.txt")).sha1();
+        CHECK_GIT_RESULT(r);
+
+        // The first repository has the blob as loose object, the second in a pack only
+        QString hex = id.toString();
+        QString looseFile = QStringLiteral("objects/%1/%2").arg(hex.left(2), hex.mid(2));
+        EXPECT_EQ(i == 0, QFileInfo(QDir(repo.path()).filePath(looseFile)).exists());
+
+        // Both much smaller and larger than the pieces that are read
+        int chunkSizes[] = { Git::BlobReader::DefaultChunkSize, 1000, 32 };
+
+        for (int j = 0; j < 3; ++j) {
+            int chunkSize = chunkSizes[j];
+            Git::BlobReader reader(repo, id);
+            reader.setChunkSize(chunkSize);
+            EXPECT_EQ(chunkSize, reader.chunkSize());
+            ASSERT_TRUE(reader.open(QIODevice::ReadOnly));
+            EXPECT_EQ(expected.size(), reader.size());
+            EXPECT_FALSE(reader.isBuffered()) << repoNames[i];
+
+            EXPECT_EQ(expected, readInPieces(reader, 77)) << repoNames[i] << " " << chunkSize;
+            EXPECT_TRUE(reader.atEnd());
+            EXPECT_TRUE(reader.result());
+        }
+    }
+}
+
+TEST_F(BlobFixture, ReaderAppliesFilters)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "BlobRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+
+    Git::ObjectId id = head.tree(r).entry(QStringLiteral("crlf.txt")).sha1();
+    CHECK_GIT_RESULT(r);
+
+    Git::BlobReader raw(repo, id);
+    ASSERT_TRUE(raw.open(QIODevice::ReadOnly));
+    EXPECT_EQ(QByteArray("a\nb\n"), raw.readAll());
+
+    // .gitattributes says "crlf.txt eol=crlf"
+    Git::BlobReader filtered(repo, id, QStringLiteral("crlf.txt"));
+    filtered.setChunkSize(32);
+    ASSERT_TRUE(filtered.open(QIODevice::ReadOnly));
+    EXPECT_EQ(6, filtered.size());
+    EXPECT_EQ(QByteArray("a\r\nb\r\n"), readInPieces(filtered, 1));
+    EXPECT_TRUE(filtered.result());
+
+    // The same blob at a path without the attribute is not converted
+    Git::BlobReader elsewhere(repo, id, QStringLiteral("other.txt"));
+    ASSERT_TRUE(elsewhere.open(QIODevice::ReadOnly));
+    EXPECT_EQ(QByteArray("a\nb\n"), elsewhere.readAll());
+}
+
+TEST_F(BlobFixture, ReaderBuffersDeltas)
+{
+    QByteArray expected;
+    for (int i = 1; i <= 4999; ++i) {
+        expected += QByteArray::number(i) + '\n';
+    }
+
+    const char* repoNames[] = { "BlobRepo", "BlobRepoPacked" };
+
+    for (int i = 0; i < 2; ++i) {
+        Git::Result r;
+        Git::Repository repo( TempRepoOpener(this, repoNames[i], r) );
+        CHECK_GIT_RESULT(r);
+        ASSERT_TRUE(repo.isValid());
+
+        Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo,
+                                                                          QStringLiteral("HEAD")));
+        CHECK_GIT_RESULT(r);
+
+        // In the pack, delta.txt is stored as a delta against big.txt
+        Git::ObjectId id = head.tree(r).entry(QStringLiteral("delta.txt")).sha1();
+        CHECK_GIT_RESULT(r);
+
+        Git::BlobReader reader(repo, id);
+        EXPECT_EQ(-1, reader.bufferLimit());
+        reader.setChunkSize(32);
+        ASSERT_TRUE(reader.open(QIODevice::ReadOnly));
+        EXPECT_EQ(i == 1, reader.isBuffered()) << repoNames[i];
+        EXPECT_EQ(expected.size(), reader.size());
+        EXPECT_EQ(expected, readInPieces(reader, 77)) << repoNames[i];
+        reader.close();
+
+        // A reader that may not buffer that much refuses the delta, but still streams the rest
+        Git::BlobReader limited(repo, id);
+        limited.setBufferLimit(1000);
+        EXPECT_EQ(1000, limited.bufferLimit());
+        EXPECT_EQ(i == 0, limited.open(QIODevice::ReadOnly)) << repoNames[i];
+        EXPECT_EQ(i == 0, bool(limited.result())) << repoNames[i];
+        if (i == 0) {
+            EXPECT_EQ(expected, readInPieces(limited, 77));
+        }
+    }
+}
+
+TEST_F(BlobFixture, ReaderFiltersWhileStreaming)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "BlobRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+
+    Git::Tree tree = head.tree(r);
+    CHECK_GIT_RESULT(r);
+
+    Git::ObjectId identId = tree.entry(QStringLiteral("ident.txt")).sha1();
+
+    struct {
+        const char* path;
+        QByteArray  expected;
+    } cases[] = {
+        // "ident.txt ident eol=crlf"
+        { "ident.txt",  "$Id: " + identId.toString().toLatin1() + " $\r\nline\r\n" },
+        // "mixed.txt eol=crlf": Only the lone LF is converted
+        { "mixed.txt",  QByteArray("a\r\nb\r\n") },
+        // "binary.bin eol=crlf": Binary content is never converted
+        { "binary.bin", QByteArray("a\0b\n", 4) }
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const QString path = QString::fromLatin1(cases[i].path);
+        Git::ObjectId id = tree.entry(path).sha1();
+        ASSERT_FALSE(id.isNull()) << cases[i].path;
+
+        int chunkSizes[] = { Git::BlobReader::DefaultChunkSize, 3, 1 };
+
+        for (int j = 0; j < 3; ++j) {
+            Git::BlobReader reader(repo, id, path);
+            reader.setChunkSize(chunkSizes[j]);
+            ASSERT_TRUE(reader.open(QIODevice::ReadOnly)) << cases[i].path;
+            EXPECT_FALSE(reader.isBuffered()) << cases[i].path;
+            EXPECT_EQ(cases[i].expected.size(), reader.size()) << cases[i].path;
+            EXPECT_EQ(cases[i].expected, readInPieces(reader, 2))
+                    << cases[i].path << " " << chunkSizes[j];
+            EXPECT_TRUE(reader.result());
+        }
+    }
+}
@@ -17,10 +17,15 @@
  *
  */
 
+#include <QElapsedTimer>
+
 #include "gtest/gtest.h"
 
 #include "libGitWrap/Commit.hpp"
+#include "libGitWrap/CommitInfo.hpp"
 #include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/RefLog.hpp"
+#include "libGitWrap/Reference.hpp"
 #include "libGitWrap/Repository.hpp"
 #include "libGitWrap/Result.hpp"
 #include "libGitWrap/Tree.hpp"
@@ -50,3 +55,245 @@ TEST_F(CommitFixture, CanCreateFirstCommitFromTree)
     ASSERT_EQ( commit, lookedUp );
     ASSERT_EQ( commit.id(), lookedUp.id() );
 }
+
+TEST_F(CommitFixture, CommitInfosMatchCommits)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId id = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+
+    Git::Commit commit = repo.lookupCommit(r, id);
+    CHECK_GIT_RESULT(r);
+
+    // Enough ids to have the list decoded by more than one thread
+    Git::ObjectIdList ids(10000, id);
+
+    Git::CommitInfoList infos = repo.commitInfos(r, ids);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(ids.count(), infos.count());
+
+    for (int i = 0; i < infos.count(); i += 997) {
+        const Git::CommitInfo& ci = infos.at(i);
+        EXPECT_EQ(id, ci.id);
+        EXPECT_EQ(commit.treeId(r), ci.tree);
+        EXPECT_EQ(commit.author().name(), infos.authorName(i));
+        EXPECT_EQ(commit.author().email(), infos.authorEmail(i));
+        EXPECT_EQ(commit.committer().name(), infos.committerName(i));
+        EXPECT_EQ(commit.author().when(), infos.author(i).when());
+        EXPECT_EQ(commit.shortMessage(), infos.summary(i));
+        EXPECT_EQ(commit.parentCommitIds(r), infos.parentIds(i));
+    }
+
+    // Names and emails are interned; only the summaries are stored per commit
+    EXPECT_GE(infos.stringCount(), ids.count());
+    EXPECT_EQ(infos.at(0).authorName, infos.at(ids.count() - 1).authorName);
+
+    Git::ObjectIdList bad;
+    bad << id << commit.treeId(r);
+    infos = repo.commitInfos(r, bad);
+    EXPECT_FALSE(r);
+    EXPECT_TRUE(infos.isEmpty());
+}
+
+TEST_F(CommitFixture, SignaturesAreInterned)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId id = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+
+    Git::Commit commit = repo.lookupCommit(r, id);
+    CHECK_GIT_RESULT(r);
+
+    Git::Commit again = repo.lookupCommit(r, id);
+    CHECK_GIT_RESULT(r);
+
+    Git::Signature author = commit.author();
+    ASSERT_FALSE(author.isEmpty());
+    EXPECT_EQ(QStringLiteral("Frida Fridoline"), author.name());
+
+    // Both signatures were read from the same repository; equal strings share their data
+    EXPECT_EQ(author.name().constData(), again.author().name().constData());
+    EXPECT_EQ(author.email().constData(), again.author().email().constData());
+
+    EXPECT_EQ(author.time(), author.when().toMSecsSinceEpoch() / 1000);
+    EXPECT_EQ(author.timeOffset() * 60, author.when().offsetFromUtc());
+
+    Git::Signature copy(author.name(), author.email(), author.when());
+    EXPECT_EQ(author.time(), copy.time());
+    EXPECT_EQ(author.timeOffset(), copy.timeOffset());
+}
+
+TEST_F(CommitFixture, EmptySignaturesAreNotNull)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "EmptyIdentRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit commit = repo.lookupCommit(r, Git::Reference::nameToId(r, repo,
+                                                                        QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(commit.isValid());
+
+    // Whether interned or not, an empty name is the same as the one that libgit2 gives us
+    for (int intern = 1; intern >= 0; --intern) {
+        Git::GitWrap::Tuning saved = Git::GitWrap::tuning();
+        Git::GitWrap::Tuning t = saved;
+        t.internSignatures = intern != 0;
+        Git::GitWrap::setTuning(r, t);
+        CHECK_GIT_RESULT(r);
+
+        Git::Signature author = commit.author();
+        EXPECT_TRUE(author.name().isEmpty());
+        EXPECT_FALSE(author.name().isNull()) << intern;
+        EXPECT_TRUE(author.email().isEmpty());
+        EXPECT_FALSE(author.email().isNull()) << intern;
+        EXPECT_EQ(Q_INT64_C(1420070400), author.time());
+
+        Git::GitWrap::setTuning(r, saved);
+        CHECK_GIT_RESULT(r);
+    }
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(CommitFixture, DISABLED_BenchmarkCommitLoading)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+    Git::Tree tree = head.tree(r);
+    CHECK_GIT_RESULT(r);
+
+    const int count = 20000;
+    Git::Signature sig(QStringLiteral("Frida Fridoline"), QStringLiteral("fridoline@call.me"));
+    Git::ObjectIdList ids;
+    Git::ObjectId parent = head.id();
+
+    for (int i = 0; i < count; ++i) {
+        Git::Commit c = Git::Commit::create(r, repo, tree, QString::number(i), sig, sig,
+                                            Git::ObjectIdList() << parent);
+        ASSERT_TRUE(r);
+        ids << c.id();
+        parent = c.id();
+    }
+
+    QElapsedTimer t;
+    qint64 check = 0;
+
+    t.start();
+    foreach (const Git::ObjectId& id, ids) {
+        Git::Commit c = repo.lookupCommit(r, id);
+        Git::Signature author = c.author();
+        check += author.name().size() + author.email().size() + author.time();
+    }
+    qint64 lookup = t.restart();
+
+    foreach (const Git::ObjectId& id, ids) {
+        check += repo.lookupCommit(r, id).author().when().date().day();
+    }
+    qint64 lookupWhen = t.restart();
+
+    Git::CommitInfoList infos = repo.commitInfos(r, ids);
+    for (int i = 0; i < infos.count(); ++i) {
+        check += infos.authorName(i).size() + infos.author(i).time();
+    }
+    qint64 bulk = t.restart();
+    CHECK_GIT_RESULT(r);
+
+    // The way it was before signatures were interned: decode everything for every signature
+    Git::GitWrap::Tuning saved = Git::GitWrap::tuning();
+    Git::GitWrap::Tuning eager = saved;
+    eager.internSignatures = false;
+    Git::GitWrap::setTuning(r, eager);
+    CHECK_GIT_RESULT(r);
+
+    t.restart();
+    foreach (const Git::ObjectId& id, ids) {
+        Git::Signature author = repo.lookupCommit(r, id).author();
+        check += author.name().size() + author.email().size() + author.when().date().day();
+    }
+    qint64 eagerLookup = t.restart();
+
+    Git::GitWrap::setTuning(r, saved);
+    CHECK_GIT_RESULT(r);
+
+    printf("%d commits: lookupCommit() + author() %lld ms, with when() %lld ms, "
+           "commitInfos() %lld ms, eager conversion %lld ms (%lld)\n",
+           count, lookup, lookupWhen, bulk, eagerLookup, check);
+}
+
+TEST_F(CommitFixture, DISABLED_BenchmarkRefLog)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId head = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+
+    Git::RefLog log = Git::RefLog::read(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+    const int count = 50000 + log.count();
+
+    for (int i = log.count(); i < count; ++i) {
+        Git::Signature sig(QStringLiteral("User %1").arg(i % 10),
+                           QStringLiteral("user%1@example.org").arg(i % 10), 1420070400 + i, 60);
+        log.append(r, head, sig, QStringLiteral("Entry %1").arg(i));
+    }
+    log.write(r);
+    CHECK_GIT_RESULT(r);
+
+    QElapsedTimer t;
+    qint64 check = 0;
+
+    t.start();
+    log = Git::RefLog::read(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(count, log.count());
+    qint64 read = t.restart();
+
+    for (int i = 0; i < count; ++i) {
+        Git::Signature sig = log.at(i).committer();
+        check += sig.name().size() + sig.email().size() + sig.time();
+    }
+    qint64 signatures = t.restart();
+
+    for (int i = 0; i < count; ++i) {
+        check += log.at(i).committer().when().date().day();
+    }
+    qint64 when = t.restart();
+
+    // The way it was before signatures were interned: decode everything for every signature
+    Git::GitWrap::Tuning saved = Git::GitWrap::tuning();
+    Git::GitWrap::Tuning eager = saved;
+    eager.internSignatures = false;
+    Git::GitWrap::setTuning(r, eager);
+    CHECK_GIT_RESULT(r);
+
+    t.restart();
+    for (int i = 0; i < count; ++i) {
+        Git::Signature sig = log.at(i).committer();
+        check += sig.name().size() + sig.email().size() + sig.when().date().day();
+    }
+    qint64 eagerSignatures = t.restart();
+
+    Git::GitWrap::setTuning(r, saved);
+    CHECK_GIT_RESULT(r);
+
+    printf("%d reflog entries: read() %lld ms, committer() %lld ms, with when() %lld ms, "
+           "eager conversion %lld ms (%lld)\n",
+           count, read, signatures, when, eagerSignatures, check);
+}
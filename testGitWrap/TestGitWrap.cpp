@@ -0,0 +1,76 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include "libGitWrap/GitWrap.hpp"
+#include "libGitWrap/Reference.hpp"
+#include "libGitWrap/Repository.hpp"
+#include "libGitWrap/Result.hpp"
+
+#include "Infra/Fixture.hpp"
+#include "Infra/TempRepo.hpp"
+
+typedef Fixture GitWrapFixture;
+
+TEST_F(GitWrapFixture, TuningCanBeChanged)
+{
+    Git::Result r;
+    Git::GitWrap::Tuning saved = Git::GitWrap::tuning();
+
+    Git::GitWrap::Tuning t = saved;
+    t.cacheMaxSize = Q_INT64_C(512) * 1024 * 1024;
+    t.treeCacheLimit = 64 * 1024;
+    Git::GitWrap::setTuning(r, t);
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_EQ(t.cacheMaxSize, Git::GitWrap::tuning().cacheMaxSize);
+    EXPECT_EQ(t.treeCacheLimit, Git::GitWrap::tuning().treeCacheLimit);
+    EXPECT_EQ(t.cacheMaxSize, Git::GitWrap::cacheStats().cacheMaxSize);
+
+    // Invalid settings are rejected and leave the current ones alone
+    Git::GitWrap::Tuning bad = t;
+    bad.mwindowSize = 0;
+    Git::GitWrap::setTuning(r, bad);
+    EXPECT_FALSE(r);
+    EXPECT_EQ(t.mwindowSize, Git::GitWrap::tuning().mwindowSize);
+
+    r = Git::Result();
+    Git::GitWrap::setTuning(r, saved);
+    CHECK_GIT_RESULT(r);
+}
+
+TEST_F(GitWrapFixture, CacheStatsCountRetainedObjects)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::GitWrap::CacheStats before = Git::GitWrap::cacheStats();
+
+    Git::ObjectId id = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+    Git::Commit commit = repo.lookupCommit(r, id);
+    CHECK_GIT_RESULT(r);
+
+    Git::GitWrap::CacheStats after = Git::GitWrap::cacheStats();
+    EXPECT_EQ(before.commits + 1, after.commits);
+    EXPECT_LT(before.retainedBytes, after.retainedBytes);
+
+    repo.clearObjectCache();
+    EXPECT_EQ(before.commits, Git::GitWrap::cacheStats().commits);
+}
@@ -0,0 +1,226 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include "gtest/gtest.h"
+
+#include "libGitWrap/ObjectId.hpp"
+
+#include "Infra/ObjectIds.hpp"
+
+// libgit2 is linked into GitWrap; except on MSVC, where its symbols are not exported.
+#ifndef _MSC_VER
+
+#include "git2/oid.h"
+
+namespace
+{
+
+    // ObjectId::fromString() as it was before it did the hex conversion itself
+    Git::ObjectId libgit2FromString(const QString& oid, int max = Git::ObjectId::SHA1_LengthHex,
+                                    bool* success = nullptr)
+    {
+        QByteArray ascii = oid.toUtf8();
+        git_oid gitoid;
+
+        if (git_oid_fromstrn(&gitoid, ascii.constData(),
+                             qMin(qMin(max, int(Git::ObjectId::SHA1_LengthHex)),
+                                  ascii.length())) < 0) {
+            if (success) {
+                *success = false;
+            }
+            return Git::ObjectId();
+        }
+
+        if (success) {
+            *success = true;
+        }
+
+        return Git::ObjectId::fromRaw(gitoid.id, Git::ObjectId::SHA1_Length);
+    }
+
+    // ObjectId::toString() as it was before it did the hex conversion itself
+    QString libgit2ToString(const Git::ObjectId& id, int max = Git::ObjectId::SHA1_LengthHex)
+    {
+        max = qMax(0, qMin<int>(Git::ObjectId::SHA1_LengthHex, max)) + 1;
+        QByteArray ascii(max, 0);
+        git_oid_tostr(ascii.data(), max, reinterpret_cast<const git_oid*>(id.raw()));
+        return QString::fromUtf8(ascii);
+    }
+
+}
+
+TEST(ObjectId, FormatMatchesLibgit2)
+{
+    Git::ObjectIdList ids = makeIds(1000, 17);
+
+    foreach (const Git::ObjectId& id, ids) {
+        QString expected = libgit2ToString(id);
+        QByteArray ascii = expected.toLatin1();
+
+        char actual[41];
+        id.toAscii(actual);
+        EXPECT_STREQ(ascii.constData(), actual);
+
+        EXPECT_STREQ(ascii.constData(), id.toAscii().constData());
+        EXPECT_EQ(expected, id.toString());
+        EXPECT_EQ(libgit2ToString(id, 7), id.toString(7));
+        EXPECT_EQ(libgit2ToString(id, 0), id.toString(0));
+        EXPECT_EQ(8, id.toAscii(7).size());
+    }
+}
+
+TEST(ObjectId, ParseMatchesLibgit2)
+{
+    Git::ObjectIdList ids = makeIds(1000, 23);
+
+    foreach (const Git::ObjectId& id, ids) {
+        QString hex = id.toString();
+
+        bool ok = false;
+        EXPECT_EQ(libgit2FromString(hex), Git::ObjectId::fromString(hex, 40, &ok));
+        EXPECT_TRUE(ok);
+
+        // Upper case is accepted, too
+        EXPECT_EQ(libgit2FromString(hex.toUpper()), Git::ObjectId::fromString(hex.toUpper()));
+
+        // Short ids are zero padded
+        EXPECT_EQ(libgit2FromString(hex, 7), Git::ObjectId::fromString(hex, 7));
+    }
+
+    const char* bad[] = {
+        "0123456789abcdef0123456789abcdef0123456g",
+        "0123456789abcdef0123456789abcdef012345 7",
+        "g"
+    };
+
+    for (const char* hex : bad) {
+        bool okOld = true, okNew = true;
+        EXPECT_EQ(libgit2FromString(QString::fromLatin1(hex), 40, &okOld),
+                  Git::ObjectId::fromString(QString::fromLatin1(hex), 40, &okNew));
+        EXPECT_EQ(okOld, okNew);
+    }
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST(ObjectId, DISABLED_BenchmarkHex)
+{
+    const int count = 1000000;
+    Git::ObjectIdList ids = makeIds(count, 99);
+    QStringList strings;
+    strings.reserve(count);
+    QByteArray text(count * 41, '\n');
+    Git::ObjectIdList parsed(count);
+    QElapsedTimer t;
+    int check = 0;
+
+    t.start();
+    for (int i = 0; i < count; ++i) {
+        check += libgit2ToString(ids.at(i)).at(0).unicode();
+    }
+    qint64 oldFormat = t.restart();
+
+    for (int i = 0; i < count; ++i) {
+        strings.append(ids.at(i).toString());
+    }
+    qint64 strFormat = t.restart();
+
+    char buf[41];
+    for (int i = 0; i < count; ++i) {
+        ids.at(i).toAscii(buf);
+        check += buf[0];
+    }
+    qint64 bufFormat = t.restart();
+
+    Git::ObjectId::formatMany(ids.constData(), count, text.data(), 41);
+    qint64 manyFormat = t.restart();
+
+    for (int i = 0; i < count; ++i) {
+        parsed[i] = libgit2FromString(strings.at(i));
+    }
+    qint64 oldParse = t.restart();
+
+    EXPECT_EQ(ids, parsed);
+
+    for (int i = 0; i < count; ++i) {
+        parsed[i] = Git::ObjectId::fromString(strings.at(i));
+    }
+    qint64 strParse = t.restart();
+
+    EXPECT_EQ(ids, parsed);
+
+    EXPECT_EQ(count, Git::ObjectId::parseMany(text.constData(), count, parsed.data(), 41));
+    qint64 manyParse = t.restart();
+
+    EXPECT_EQ(ids, parsed);
+
+    printf("%d ids, format: libgit2 %lld ms, toString() %lld ms, toAscii(char*) %lld ms, "
+           "formatMany %lld ms (%d)\n",
+           count, oldFormat, strFormat, bufFormat, manyFormat, check);
+    printf("%d ids, parse: libgit2 %lld ms, fromString() %lld ms, parseMany %lld ms\n",
+           count, oldParse, strParse, manyParse);
+}
+
+#endif
+
+TEST(ObjectId, ParseRejectsAndPads)
+{
+    Git::ObjectIdList ids = makeIds(100, 31);
+
+    foreach (const Git::ObjectId& id, ids) {
+        QByteArray hex = id.toAscii(40).left(40);
+
+        bool ok = false;
+        EXPECT_EQ(id, Git::ObjectId::fromAscii(hex, 40, &ok));
+        EXPECT_TRUE(ok);
+        EXPECT_EQ(id, Git::ObjectId::fromAscii(hex.toUpper(), 40, &ok));
+        EXPECT_TRUE(ok);
+    }
+
+    bool ok = true;
+    QByteArray bad("0123456789abcdef0123456789abcdef0123456g");
+    EXPECT_TRUE(Git::ObjectId::fromAscii(bad, 40, &ok).isNull());
+    EXPECT_FALSE(ok);
+
+    // Short ids are still zero padded
+    Git::ObjectId shortId = Git::ObjectId::fromString(QStringLiteral("abc"), 40, &ok);
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(QStringLiteral("abc0000000000000000000000000000000000000"), shortId.toString());
+}
+
+TEST(ObjectId, ParseAndFormatMany)
+{
+    Git::ObjectIdList ids = makeIds(100, 42);
+
+    // One id per line
+    QByteArray text(ids.count() * 41, '\n');
+    Git::ObjectId::formatMany(ids.constData(), ids.count(), text.data(), 41);
+
+    for (int i = 0; i < ids.count(); ++i) {
+        EXPECT_EQ(ids.at(i).toAscii(), text.mid(i * 41, 40) + '\0');
+        EXPECT_EQ('\n', text.at(i * 41 + 40));
+    }
+
+    Git::ObjectIdList parsed(ids.count());
+    EXPECT_EQ(ids.count(), Git::ObjectId::parseMany(text.constData(), ids.count(),
+                                                    parsed.data(), 41));
+    EXPECT_EQ(ids, parsed);
+
+    text[5 * 41 + 3] = 'x';
+    EXPECT_EQ(5, Git::ObjectId::parseMany(text.constData(), ids.count(), parsed.data(), 41));
+}
@@ -0,0 +1,223 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+
+#include "gtest/gtest.h"
+
+#include "libGitWrap/ObjectIdSet.hpp"
+
+#include "Infra/ObjectIds.hpp"
+
+namespace
+{
+
+    void benchmarkSet(int count)
+    {
+        Git::ObjectIdList ids = makeIds(count, 4711);
+        Git::ObjectIdList misses = makeIds(count, 815);
+        QElapsedTimer t;
+        int found;
+
+        t.start();
+        QSet<Git::ObjectId> qset;
+        qset.reserve(count);
+        foreach (const Git::ObjectId& id, ids) {
+            qset.insert(id);
+        }
+        qint64 qInsert = t.restart();
+
+        found = 0;
+        foreach (const Git::ObjectId& id, ids) {
+            found += qset.contains(id) ? 1 : 0;
+        }
+        foreach (const Git::ObjectId& id, misses) {
+            found += qset.contains(id) ? 1 : 0;
+        }
+        qint64 qLookup = t.restart();
+        EXPECT_EQ(count, found);
+
+        Git::ObjectIdSet set;
+        set.insert(ids);
+        qint64 gwInsert = t.restart();
+
+        found = 0;
+        foreach (const Git::ObjectId& id, ids) {
+            found += set.contains(id) ? 1 : 0;
+        }
+        foreach (const Git::ObjectId& id, misses) {
+            found += set.contains(id) ? 1 : 0;
+        }
+        qint64 gwLookup = t.restart();
+        EXPECT_EQ(count, found);
+
+        printf("%9d ids: QSet insert %6lld ms, lookup %6lld ms | "
+               "ObjectIdSet insert %6lld ms, lookup %6lld ms\n",
+               count, qInsert, qLookup, gwInsert, gwLookup);
+    }
+
+    void benchmarkMap(int count)
+    {
+        Git::ObjectIdList ids = makeIds(count, 4711);
+        QElapsedTimer t;
+        qint64 sum;
+
+        t.start();
+        QHash<Git::ObjectId, int> qhash;
+        qhash.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            qhash.insert(ids.at(i), i);
+        }
+        qint64 qInsert = t.restart();
+
+        sum = 0;
+        foreach (const Git::ObjectId& id, ids) {
+            sum += qhash.value(id);
+        }
+        qint64 qLookup = t.restart();
+        EXPECT_EQ(qint64(count) * (count - 1) / 2, sum);
+
+        Git::ObjectIdMap<int> map;
+        map.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            map.insert(ids.at(i), i);
+        }
+        qint64 gwInsert = t.restart();
+
+        sum = 0;
+        foreach (const Git::ObjectId& id, ids) {
+            sum += map.value(id);
+        }
+        qint64 gwLookup = t.restart();
+        EXPECT_EQ(qint64(count) * (count - 1) / 2, sum);
+
+        printf("%9d ids: QHash insert %6lld ms, lookup %6lld ms | "
+               "ObjectIdMap insert %6lld ms, lookup %6lld ms\n",
+               count, qInsert, qLookup, gwInsert, gwLookup);
+    }
+
+}
+
+TEST(ObjectIdSet, InsertContainsRemove)
+{
+    Git::ObjectIdList ids = makeIds(1000, 1);
+    Git::ObjectIdSet set;
+
+    EXPECT_TRUE(set.isEmpty());
+    EXPECT_FALSE(set.contains(ids.at(0)));
+    EXPECT_FALSE(set.remove(ids.at(0)));
+
+    for (int i = 0; i < ids.count(); ++i) {
+        EXPECT_TRUE(set.insert(ids.at(i)));
+    }
+    EXPECT_FALSE(set.insert(ids.at(42)));
+    EXPECT_EQ(ids.count(), set.count());
+
+    // Remove every other id; the remaining ones must still be found after the backward shifts
+    for (int i = 0; i < ids.count(); i += 2) {
+        EXPECT_TRUE(set.remove(ids.at(i)));
+    }
+    EXPECT_EQ(ids.count() / 2, set.count());
+
+    for (int i = 0; i < ids.count(); ++i) {
+        EXPECT_EQ(i % 2 == 1, set.contains(ids.at(i)));
+    }
+
+    int n = 0;
+    for (Git::ObjectIdSet::const_iterator it = set.begin(); it != set.end(); ++it) {
+        EXPECT_TRUE(ids.indexOf(*it) % 2 == 1);
+        n++;
+    }
+    EXPECT_EQ(set.count(), n);
+
+    set.clear();
+    EXPECT_TRUE(set.isEmpty());
+    EXPECT_FALSE(set.contains(ids.at(1)));
+}
+
+TEST(ObjectIdSet, BulkInsert)
+{
+    Git::ObjectIdList ids = makeIds(5000, 2);
+    Git::ObjectIdSet set;
+
+    set.reserve(ids.count());
+    int capacity = set.capacity();
+    EXPECT_GE(capacity, ids.count());
+
+    EXPECT_EQ(ids.count(), set.insert(ids));
+    EXPECT_EQ(capacity, set.capacity());
+    EXPECT_EQ(0, set.insert(ids));
+
+    Git::ObjectIdSet copy(set.toList());
+    EXPECT_EQ(set.count(), copy.count());
+
+    // A null id is an ordinary key
+    EXPECT_TRUE(set.insert(Git::ObjectId()));
+    EXPECT_TRUE(set.contains(Git::ObjectId()));
+}
+
+TEST(ObjectIdMap, InsertValueRemove)
+{
+    Git::ObjectIdList ids = makeIds(1000, 3);
+    Git::ObjectIdMap<int> map;
+
+    for (int i = 0; i < ids.count(); ++i) {
+        EXPECT_TRUE(map.insert(ids.at(i), i));
+    }
+    EXPECT_FALSE(map.insert(ids.at(7), -7));
+    EXPECT_EQ(-7, map.value(ids.at(7)));
+    EXPECT_EQ(ids.count(), map.count());
+
+    map[ids.at(8)] += 100;
+    EXPECT_EQ(108, map.value(ids.at(8)));
+
+    for (int i = 0; i < ids.count(); i += 3) {
+        EXPECT_TRUE(map.remove(ids.at(i)));
+    }
+
+    for (int i = 0; i < ids.count(); ++i) {
+        const int* v = map.find(ids.at(i));
+        if (i % 3 == 0) {
+            EXPECT_TRUE(v == nullptr);
+            EXPECT_EQ(-1, map.value(ids.at(i), -1));
+        }
+        else {
+            ASSERT_TRUE(v != nullptr);
+            EXPECT_EQ(i == 7 ? -7 : i == 8 ? 108 : i, *v);
+        }
+    }
+
+    for (Git::ObjectIdMap<int>::const_iterator it = map.begin(); it != map.end(); ++it) {
+        EXPECT_EQ(it.value(), map.value(it.key()));
+    }
+    EXPECT_EQ(map.count(), map.keys().count());
+    EXPECT_EQ(map.count(), map.values().count());
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST(ObjectIdSet, DISABLED_Benchmark)
+{
+    benchmarkSet(1000000);
+    benchmarkSet(10000000);
+}
+
+TEST(ObjectIdMap, DISABLED_Benchmark)
+{
+    benchmarkMap(1000000);
+    benchmarkMap(10000000);
+}
@@ -17,12 +17,18 @@
  *
  */
 
+#include <QDir>
+#include <QFile>
+
 #include "gtest/gtest.h"
 
 #include "libGitWrap/Result.hpp"
+#include "libGitWrap/Commit.hpp"
 #include "libGitWrap/ObjectId.hpp"
 #include "libGitWrap/Repository.hpp"
 #include "libGitWrap/Reference.hpp"
+#include "libGitWrap/RefSnapshot.hpp"
+#include "libGitWrap/Tag.hpp"
 
 #include "Infra/Fixture.hpp"
 #include "Infra/TempRepo.hpp"
@@ -103,3 +109,84 @@ TEST_F(ReferenceFixture, CanDestroyRef)
     CHECK_GIT_RESULT(r);
     ASSERT_EQ(0, sl.count());
 }
+
+TEST_F(ReferenceFixture, SnapshotPeelsAndRefreshes)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::RefSnapshot snap = Git::RefSnapshot::create(r, repo);
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(snap.isValid());
+
+    Git::ObjectId headId = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+
+    int master = snap.indexOf(QStringLiteral("refs/heads/master"));
+    ASSERT_NE(-1, master);
+    EXPECT_EQ(QStringLiteral("refs/heads/master"), snap.name(master));
+    EXPECT_FALSE(snap.isSymbolic(master));
+    EXPECT_FALSE(snap.isAnnotatedTag(master));
+    EXPECT_EQ(headId, snap.target(master));
+    EXPECT_EQ(headId, snap.peeledTarget(master));
+    EXPECT_EQ(-1, snap.indexOf(QStringLiteral("refs/heads/nothere")));
+
+    Git::ResolvedRefs resolved = repo.allResolvedRefs(r);
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(resolved, snap.toResolvedRefs());
+
+    Git::Commit head = repo.lookupCommit(r, headId);
+    CHECK_GIT_RESULT(r);
+
+    Git::Signature tagger(QStringLiteral("Test"), QStringLiteral("test@example.org"));
+    Git::ObjectId tagId = Git::Tag::create(r, QStringLiteral("annotated"), head, tagger,
+                                           QStringLiteral("An annotated tag"), false);
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_TRUE(snap.refresh(r));
+    CHECK_GIT_RESULT(r);
+
+    int tag = snap.indexOf(QStringLiteral("refs/tags/annotated"));
+    ASSERT_NE(-1, tag);
+    EXPECT_TRUE(snap.isAnnotatedTag(tag));
+    EXPECT_EQ(tagId, snap.target(tag));
+    EXPECT_EQ(headId, snap.peeledTarget(tag));
+
+    for (int i = 1; i < snap.count(); ++i) {
+        EXPECT_LT(snap.name(i - 1), snap.name(i));
+    }
+}
+
+TEST_F(ReferenceFixture, SnapshotKeepsUnresolvedRefs)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::RefSnapshot snap = Git::RefSnapshot::create(r, repo);
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(snap.isValid());
+
+    // A symbolic ref to a branch that has been deleted
+    QFile f(QDir(repo.path()).filePath(QStringLiteral("refs/heads/dangling")));
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+    f.write("ref: refs/heads/gone\n");
+    f.close();
+
+    EXPECT_TRUE(snap.refresh(r));
+    CHECK_GIT_RESULT(r);
+
+    int dangling = snap.indexOf(QStringLiteral("refs/heads/dangling"));
+    ASSERT_NE(-1, dangling);
+    EXPECT_TRUE(snap.isSymbolic(dangling));
+    EXPECT_EQ(QStringLiteral("refs/heads/gone"), snap.symbolicTarget(dangling));
+    EXPECT_TRUE(snap.target(dangling).isNull());
+    EXPECT_TRUE(snap.peeledTarget(dangling).isNull());
+    EXPECT_FALSE(snap.isAnnotatedTag(dangling));
+    EXPECT_FALSE(snap.toResolvedRefs().contains(QStringLiteral("refs/heads/dangling")));
+}
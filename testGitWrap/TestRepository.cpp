@@ -19,8 +19,22 @@
 
 #include "gtest/gtest.h"
 
+#include "libGitWrap/Commit.hpp"
+#include "libGitWrap/Index.hpp"
 #include "libGitWrap/Result.hpp"
+#include "libGitWrap/Reference.hpp"
 #include "libGitWrap/Repository.hpp"
+#include "libGitWrap/RevisionWalker.hpp"
+#include "libGitWrap/StatusConsumer.hpp"
+#include "libGitWrap/StatusOptions.hpp"
+#include "libGitWrap/Tree.hpp"
+#include "libGitWrap/TreeEntry.hpp"
+#include "libGitWrap/TreeEntryView.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
 
 #include "Infra/Fixture.hpp"
 #include "Infra/TempRepo.hpp"
@@ -75,3 +89,619 @@ TEST_F(RepositoryFixture, CanDetachHEAD)
 
     ASSERT_TRUE(repo.isHeadDetached());
 }
+
+TEST_F(RepositoryFixture, LookupSharesObjects)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId id = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+
+    Git::Commit c1 = repo.lookupCommit(r, id);
+    CHECK_GIT_RESULT(r);
+    Git::Commit c2 = repo.lookupCommit(r, id);
+    CHECK_GIT_RESULT(r);
+
+    // Both lookups must share the very same private object
+    ASSERT_EQ(c1, c2);
+
+    Git::ObjectCacheStats stats = repo.objectCacheStats();
+    EXPECT_EQ(1u, stats.misses);
+    EXPECT_EQ(1u, stats.hits);
+    EXPECT_EQ(1, stats.commits);
+
+    // Asking for the wrong type must fail, even if the object is cached
+    Git::Tree t = repo.lookupTree(r, id);
+    EXPECT_FALSE(r);
+    EXPECT_FALSE(t.isValid());
+}
+
+TEST_F(RepositoryFixture, ObjectCacheEvictsTheLeastRecentlyUsed)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "HistoryRepo", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    walker.setSorting(r, true, false);
+    walker.pushHead(r);
+    Git::ObjectIdList ids = walker.all(r);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(7, ids.count());
+
+    Git::ObjectCacheLimits limits;
+    limits.maxCommits = 2;
+    repo.setObjectCacheLimits(limits);
+    EXPECT_EQ(2, repo.objectCacheLimits().maxCommits);
+
+    // No wrapper outlives its lookup, so only the cache retains the commits
+    foreach (const Git::ObjectId& id, ids) {
+        EXPECT_TRUE(repo.lookupCommit(r, id).isValid());
+        CHECK_GIT_RESULT(r);
+    }
+
+    Git::ObjectCacheStats stats = repo.objectCacheStats();
+    EXPECT_EQ(7u, stats.misses);
+    EXPECT_EQ(0u, stats.hits);
+    EXPECT_EQ(5u, stats.evictions);
+    EXPECT_EQ(2, stats.commits);
+    EXPECT_EQ(0, stats.wrappers);
+
+    // The last two commits are still there, the first one was evicted
+    EXPECT_TRUE(repo.lookupCommit(r, ids[6]).isValid());
+    EXPECT_TRUE(repo.lookupCommit(r, ids[5]).isValid());
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(2u, stats.revived);
+    EXPECT_EQ(7u, stats.misses);
+
+    Git::Commit first = repo.lookupCommit(r, ids[0]);
+    CHECK_GIT_RESULT(r);
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(8u, stats.misses);
+    EXPECT_EQ(6u, stats.evictions);
+    EXPECT_EQ(2, stats.commits);
+
+    // While a wrapper is alive, a lookup shares it, even if its object was evicted meanwhile
+    EXPECT_TRUE(repo.lookupCommit(r, ids[1]).isValid());
+    EXPECT_TRUE(repo.lookupCommit(r, ids[2]).isValid());
+    EXPECT_EQ(first, repo.lookupCommit(r, ids[0]));
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(1u, stats.hits);
+    EXPECT_EQ(1, stats.wrappers);
+
+    // Shrinking the limits evicts right away
+    limits.maxCommits = 0;
+    repo.setObjectCacheLimits(limits);
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(0, stats.commits);
+    EXPECT_EQ(0u, stats.memoryUsed);
+
+    // The memory budget is enforced, too; no commit fits into a single byte
+    limits.maxCommits = 100;
+    limits.maxMemory = 1;
+    repo.setObjectCacheLimits(limits);
+    foreach (const Git::ObjectId& id, ids) {
+        EXPECT_TRUE(repo.lookupCommit(r, id).isValid());
+    }
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(0, stats.commits);
+    EXPECT_EQ(0u, stats.memoryUsed);
+    CHECK_GIT_RESULT(r);
+}
+
+TEST_F(RepositoryFixture, ObjectCacheIsClearedForRewrittenHistory)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId headId = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+    Git::Commit head = repo.lookupCommit(r, headId);
+    CHECK_GIT_RESULT(r);
+    Git::Tree tree = head.tree(r);
+    CHECK_GIT_RESULT(r);
+
+    // Amend the commit: It gets a new id, so the cache can't hand out the old one for it
+    Git::Signature sig(QStringLiteral("Frida Fridoline"), QStringLiteral("fridoline@call.me"));
+    Git::Commit amended = Git::Commit::create(r, repo, tree, QStringLiteral("Amended"), sig, sig,
+                                              Git::ObjectIdList());
+    CHECK_GIT_RESULT(r);
+    ASSERT_NE(headId, amended.id());
+
+    Git::Commit lookedUp = repo.lookupCommit(r, amended.id());
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringLiteral("Amended"), lookedUp.shortMessage());
+    EXPECT_EQ(QStringLiteral("First file"), repo.lookupCommit(r, headId).shortMessage());
+
+    Git::ObjectCacheStats stats = repo.objectCacheStats();
+    EXPECT_LT(0, stats.commits);
+    EXPECT_LT(0u, stats.memoryUsed);
+
+    // Clearing drops the retained objects, but not the wrappers that are still in use
+    repo.clearObjectCache();
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(0, stats.commits);
+    EXPECT_EQ(0, stats.trees);
+    EXPECT_EQ(0u, stats.memoryUsed);
+
+    const quint64 misses = stats.misses;
+    EXPECT_EQ(lookedUp, repo.lookupCommit(r, amended.id()));
+    EXPECT_EQ(misses, repo.objectCacheStats().misses);
+
+    // Once the wrappers are gone, the objects have to be read again
+    head = Git::Commit();
+    lookedUp = Git::Commit();
+    amended = Git::Commit();
+    tree = Git::Tree();
+    repo.clearObjectCache();
+
+    EXPECT_EQ(QStringLiteral("First file"), repo.lookupCommit(r, headId).shortMessage());
+    CHECK_GIT_RESULT(r);
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(misses + 1, stats.misses);
+    EXPECT_EQ(0, stats.wrappers);
+}
+
+TEST_F(RepositoryFixture, PrefetchWarmsTheCache)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "NestedTreeRepo", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId id = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+
+    // The commit, its tree and the tree "dir"; but not "dir/sub" and no blobs
+    repo.prefetch(Git::ObjectIdList() << id, 2);
+    repo.waitForPrefetch();
+
+    // The objects were read through other handles; nothing is parsed yet
+    Git::ObjectCacheStats stats = repo.objectCacheStats();
+    EXPECT_EQ(3u, stats.prefetched);
+    EXPECT_EQ(0u, stats.prefetchHits);
+    EXPECT_EQ(0, stats.commits);
+    EXPECT_EQ(0, stats.trees);
+
+    Git::Commit commit = repo.lookupCommit(r, id);
+    CHECK_GIT_RESULT(r);
+    Git::Tree tree = repo.lookupTree(r, commit.treeId(r));
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(tree.isValid());
+    Git::Tree dir = repo.lookupTree(r, tree.entry(QStringLiteral("dir")).sha1());
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(dir.isValid());
+
+    stats = repo.objectCacheStats();
+    EXPECT_EQ(3u, stats.misses);
+    EXPECT_EQ(3u, stats.prefetchHits);
+
+    // "dir/sub" was not read ahead
+    Git::Tree sub = repo.lookupTree(r, dir.entry(QStringLiteral("sub")).sha1());
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(sub.isValid());
+    EXPECT_EQ(3u, repo.objectCacheStats().prefetchHits);
+
+    // Nothing must be left running when the repository goes away
+    repo.clearObjectCache();
+    repo.prefetch(Git::ObjectIdList() << id, 8);
+    repo.cancelPrefetch();
+}
+
+TEST_F(RepositoryFixture, QueriesObjectsWithoutReadingThem)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId commitId = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    CHECK_GIT_RESULT(r);
+    Git::Commit commit = repo.lookupCommit(r, commitId);
+    CHECK_GIT_RESULT(r);
+    Git::Tree tree = commit.tree(r);
+    CHECK_GIT_RESULT(r);
+    Git::ObjectId blobId = tree.entries().find("File1").id();
+
+    Git::ObjectIdList ids;
+    ids << blobId
+        << Git::ObjectId::fromString(QStringLiteral("0123456789012345678901234567890123456789"))
+        << commitId
+        << tree.id();
+
+    QBitArray found = repo.exists(r, ids);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(ids.count(), found.count());
+    EXPECT_TRUE(found.testBit(0));
+    EXPECT_FALSE(found.testBit(1));
+    EXPECT_TRUE(found.testBit(2));
+    EXPECT_TRUE(found.testBit(3));
+
+    Git::ObjectHeaderList headers = repo.readHeaders(r, ids);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(ids.count(), headers.count());
+
+    EXPECT_TRUE(headers.at(0).found);
+    EXPECT_EQ(Git::otBlob, headers.at(0).type);
+    EXPECT_EQ(6, headers.at(0).size);           // "File1\n"
+    EXPECT_FALSE(headers.at(1).found);
+    EXPECT_EQ(Git::otCommit, headers.at(2).type);
+    EXPECT_EQ(Git::otTree, headers.at(3).type);
+
+    // Nothing was looked up through the object cache
+    EXPECT_EQ(1u, repo.objectCacheStats().misses);
+}
+
+TEST_F(RepositoryFixture, AbbreviatesAndResolvesIds)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+
+    Git::ObjectIdList ids;
+    ids << head.id() << head.treeId(r);
+    CHECK_GIT_RESULT(r);
+
+    QStringList abbrevs = repo.shortestUniqueAbbrev(r, ids, 7);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(2, abbrevs.count());
+
+    for (int i = 0; i < ids.count(); ++i) {
+        EXPECT_EQ(7, abbrevs.at(i).length());
+        EXPECT_TRUE(ids.at(i).toString().startsWith(abbrevs.at(i)));
+        EXPECT_EQ(ids.at(i), repo.resolvePrefix(r, abbrevs.at(i)));
+        CHECK_GIT_RESULT(r);
+    }
+
+    EXPECT_EQ(head.id(), repo.resolvePrefix(r, head.id().toString()));
+    CHECK_GIT_RESULT(r);
+
+    // Too short
+    Git::Result tooShort;
+    repo.resolvePrefix(tooShort, head.id().toString(3));
+    EXPECT_FALSE(tooShort);
+
+    // Too long; that's an invalid id, not an ambiguous one
+    Git::Result tooLong;
+    repo.resolvePrefix(tooLong, head.id().toString() + QStringLiteral("0"));
+    EXPECT_FALSE(tooLong);
+    EXPECT_NE(tooShort.errorCode(), tooLong.errorCode());
+
+    // Not hex
+    repo.resolvePrefix(r, QStringLiteral("xyz1234"));
+    EXPECT_FALSE(r);
+    r.clear();
+
+    // A new object must be found after an incremental refresh
+    Git::Signature sig(QStringLiteral("Test"), QStringLiteral("test@example.org"));
+    Git::Commit commit = Git::Commit::create(r, repo, head.tree(r), QStringLiteral("Second"),
+                                             sig, sig, Git::ObjectIdList() << head.id());
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_EQ(commit.id(), repo.resolvePrefix(r, commit.id().toString(8)));
+    CHECK_GIT_RESULT(r);
+
+    // Only the new object's range was rebuilt; everything else must still be there.
+    for (int i = 0; i < ids.count(); ++i) {
+        EXPECT_EQ(ids.at(i), repo.resolvePrefix(r, abbrevs.at(i)));
+        CHECK_GIT_RESULT(r);
+    }
+}
+
+namespace
+{
+
+    class FirstStatusConsumer : public Git::StatusConsumer
+    {
+    public:
+        FirstStatusConsumer() : mCalls(0) {}
+
+    public:
+        bool fileStatus(const QString& path, Git::StatusFlags status)
+        {
+            Q_UNUSED(path);
+            Q_UNUSED(status);
+
+            ++mCalls;
+            return false;
+        }
+
+        int mCalls;
+    };
+
+}
+
+static void writeFile(const QString& dir, const QString& name, const QByteArray& content)
+{
+    QString path = QDir(dir).filePath(name);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QFile f(path);
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly | QIODevice::Append));
+    f.write(content);
+}
+
+TEST_F(RepositoryFixture, StatusReportsOnlyWhatIsAsked)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    const QString wt = repo.workTreePath();
+    writeFile(wt, QStringLiteral("File1"), "Changed\n");
+    writeFile(wt, QStringLiteral("staged.txt"), "Staged\n");
+    writeFile(wt, QStringLiteral("untracked.txt"), "Untracked\n");
+    writeFile(wt, QStringLiteral("newdir/x"), "x\n");
+    writeFile(wt, QStringLiteral("newdir/y"), "y\n");
+    writeFile(wt, QStringLiteral("build.log"), "log\n");
+    writeFile(wt, QStringLiteral("ignored/z"), "z\n");
+    writeFile(repo.path(), QStringLiteral("info/exclude"), "*.log\nignored/\n");
+
+    Git::Index index = repo.index(r);
+    index.addFile(r, QStringLiteral("staged.txt"));
+    index.write(r);
+    CHECK_GIT_RESULT(r);
+
+    const Git::StatusFlags modified(Git::FileWorkingTreeModified);
+    const Git::StatusFlags staged(Git::FileIndexNew);
+    const Git::StatusFlags untracked(Git::FileWorkingTreeNew);
+    const Git::StatusFlags ignored(Git::FileIgnored);
+
+    Git::StatusHash expected;
+    expected.insert(QStringLiteral("File1"), modified);
+    expected.insert(QStringLiteral("staged.txt"), staged);
+    expected.insert(QStringLiteral("untracked.txt"), untracked);
+    expected.insert(QStringLiteral("newdir/"), untracked);
+
+    // The defaults: what is dirty, untracked directories as one entry
+    Git::StatusOptions opts;
+    EXPECT_EQ(expected, repo.status(r, opts));
+    CHECK_GIT_RESULT(r);
+
+    Git::StatusOptions indexOnly;
+    indexOnly.setShow(Git::StatusOptions::ShowIndexOnly);
+    Git::StatusHash stagedOnly;
+    stagedOnly.insert(QStringLiteral("staged.txt"), staged);
+    EXPECT_EQ(stagedOnly, repo.status(r, indexOnly));
+    CHECK_GIT_RESULT(r);
+
+    Git::StatusOptions workTreeOnly;
+    workTreeOnly.setShow(Git::StatusOptions::ShowWorkingTreeOnly);
+    Git::StatusHash workTree = expected;
+    workTree.remove(QStringLiteral("staged.txt"));
+    EXPECT_EQ(workTree, repo.status(r, workTreeOnly));
+    CHECK_GIT_RESULT(r);
+
+    Git::StatusOptions noUntracked;
+    noUntracked.setUntrackedMode(Git::StatusOptions::UntrackedNone);
+    Git::StatusHash tracked;
+    tracked.insert(QStringLiteral("File1"), modified);
+    tracked.insert(QStringLiteral("staged.txt"), staged);
+    EXPECT_EQ(tracked, repo.status(r, noUntracked));
+    CHECK_GIT_RESULT(r);
+
+    Git::StatusOptions allUntracked;
+    allUntracked.setUntrackedMode(Git::StatusOptions::UntrackedAll);
+    Git::StatusHash recursed = tracked;
+    recursed.insert(QStringLiteral("untracked.txt"), untracked);
+    recursed.insert(QStringLiteral("newdir/x"), untracked);
+    recursed.insert(QStringLiteral("newdir/y"), untracked);
+    EXPECT_EQ(recursed, repo.status(r, allUntracked));
+    CHECK_GIT_RESULT(r);
+
+    Git::StatusOptions withIgnored;
+    withIgnored.setIncludeIgnored(true);
+    Git::StatusHash ignoredDir = expected;
+    ignoredDir.insert(QStringLiteral("build.log"), ignored);
+    ignoredDir.insert(QStringLiteral("ignored/"), ignored);
+    EXPECT_EQ(ignoredDir, repo.status(r, withIgnored));
+    CHECK_GIT_RESULT(r);
+
+    withIgnored.setRecurseIgnoredDirs(true);
+    Git::StatusHash ignoredFiles = expected;
+    ignoredFiles.insert(QStringLiteral("build.log"), ignored);
+    ignoredFiles.insert(QStringLiteral("ignored/z"), ignored);
+    EXPECT_EQ(ignoredFiles, repo.status(r, withIgnored));
+    CHECK_GIT_RESULT(r);
+
+    // Every file; there is no unmodified one in this repository
+    Git::StatusHash everything = recursed;
+    everything.insert(QStringLiteral("build.log"), ignored);
+    everything.insert(QStringLiteral("ignored/"), ignored);
+    EXPECT_EQ(everything, repo.status(r, Git::StatusOptions::allFiles()));
+    CHECK_GIT_RESULT(r);
+
+    // Stopping early is not an error
+    FirstStatusConsumer first;
+    repo.status(r, Git::StatusOptions::allFiles(), &first);
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(1, first.mCalls);
+}
+
+TEST_F(RepositoryFixture, ComputesDivergenceForAllBranches)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+
+    Git::Signature sig(QStringLiteral("Test"), QStringLiteral("test@example.org"));
+    Git::Commit second = Git::Commit::create(r, repo, head.tree(r), QStringLiteral("Second"),
+                                             sig, sig, Git::ObjectIdList() << head.id());
+    CHECK_GIT_RESULT(r);
+    Git::Commit third = Git::Commit::create(r, repo, head.tree(r), QStringLiteral("Third"),
+                                            sig, sig, Git::ObjectIdList() << second.id());
+    CHECK_GIT_RESULT(r);
+
+    Git::BranchRef::create(r, QStringLiteral("feature"), third);
+    CHECK_GIT_RESULT(r);
+
+    Git::BranchDivergenceList list = repo.divergenceForBranches(r, second.id());
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(2, list.count());
+
+    foreach (const Git::BranchDivergence& bd, list) {
+        size_t ahead = 0, behind = 0;
+        repo.calculateDivergence(r, bd.local, bd.other, ahead, behind);
+        CHECK_GIT_RESULT(r);
+
+        EXPECT_EQ(ahead, bd.ahead);
+        EXPECT_EQ(behind, bd.behind);
+
+        if (bd.branch == QStringLiteral("refs/heads/feature")) {
+            EXPECT_EQ(1u, bd.ahead);
+            EXPECT_EQ(0u, bd.behind);
+        }
+        else {
+            EXPECT_EQ(0u, bd.ahead);
+            EXPECT_EQ(1u, bd.behind);
+        }
+    }
+
+    // Without upstreams, there is nothing to compare
+    list = repo.divergenceForBranches(r);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(2, list.count());
+    EXPECT_TRUE(list.at(0).upstream.isEmpty());
+    EXPECT_TRUE(list.at(1).upstream.isEmpty());
+}
+
+TEST_F(RepositoryFixture, ChecksAncestry)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Commit head = repo.lookupCommit(r, Git::Reference::nameToId(r, repo, QStringLiteral("HEAD")));
+    CHECK_GIT_RESULT(r);
+
+    Git::Signature sig(QStringLiteral("Test"), QStringLiteral("test@example.org"));
+    Git::Commit second = Git::Commit::create(r, repo, head.tree(r), QStringLiteral("Second"),
+                                             sig, sig, Git::ObjectIdList() << head.id());
+    CHECK_GIT_RESULT(r);
+    Git::Commit sibling = Git::Commit::create(r, repo, head.tree(r), QStringLiteral("Sibling"),
+                                              sig, sig, Git::ObjectIdList() << head.id());
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_TRUE(repo.isAncestor(r, head.id(), head.id()));
+    EXPECT_TRUE(repo.isAncestor(r, head.id(), second.id()));
+    EXPECT_FALSE(repo.isAncestor(r, second.id(), head.id()));
+    EXPECT_FALSE(repo.isAncestor(r, second.id(), sibling.id()));
+    CHECK_GIT_RESULT(r);
+}
+
+static Git::ObjectIdList allCommits(Git::Result& r, Git::Repository repo)
+{
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    foreach (const QString& name, repo.allReferenceNames(r)) {
+        walker.pushRef(r, name);
+    }
+    return walker.all(r);
+}
+
+static QMap<QString, QString> divergenceByBranch(const Git::BranchDivergenceList& list)
+{
+    QMap<QString, QString> map;
+    foreach (const Git::BranchDivergence& bd, list) {
+        map.insert(bd.branch, QStringLiteral("%1 %2..%3 +%4 -%5")
+                   .arg(bd.upstream, bd.local.toString(), bd.other.toString())
+                   .arg(bd.ahead).arg(bd.behind));
+    }
+    return map;
+}
+
+TEST_F(RepositoryFixture, CommitGraphDoesNotChangeAnswers)
+{
+    Git::Result r;
+    TempRepoOpener plainRepo(this, "GraphRepo", r);
+    CHECK_GIT_RESULT(r);
+    TempRepoOpener fullRepo(this, "GraphRepoFull", r);
+    CHECK_GIT_RESULT(r);
+    TempRepoOpener splitRepo(this, "GraphRepoSplit", r);
+    CHECK_GIT_RESULT(r);
+
+    Git::Repository plain(plainRepo);
+    QList<Git::Repository> graphed;
+    graphed << Git::Repository(fullRepo) << Git::Repository(splitRepo);
+
+    QString graphFile = QStringLiteral("objects/info/commit-graph");
+    QString chainFile = QStringLiteral("objects/info/commit-graphs/commit-graph-chain");
+    EXPECT_FALSE(QFileInfo(QDir(plain.path()).filePath(graphFile)).exists());
+    EXPECT_FALSE(QFileInfo(QDir(plain.path()).filePath(chainFile)).exists());
+    EXPECT_TRUE(QFileInfo(QDir(graphed[0].path()).filePath(graphFile)).exists());
+    EXPECT_TRUE(QFileInfo(QDir(graphed[1].path()).filePath(chainFile)).exists());
+
+    Git::ObjectIdList ids = allCommits(r, plain);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(11, ids.count());
+
+    Git::ObjectId master = Git::Reference::nameToId(r, plain, QStringLiteral("refs/heads/master"));
+    Git::ObjectId topic = Git::Reference::nameToId(r, plain, QStringLiteral("refs/heads/topic"));
+    Git::ObjectId extra = Git::Reference::nameToId(r, plain, QStringLiteral("refs/heads/extra"));
+    CHECK_GIT_RESULT(r);
+
+    // Some known answers, so the comparison below does not compare garbage
+    EXPECT_TRUE(plain.isAncestor(r, extra, master));
+    EXPECT_FALSE(plain.isAncestor(r, topic, master));
+    size_t ahead = 0, behind = 0;
+    plain.calculateDivergence(r, master, topic, ahead, behind);
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(6u, ahead);
+    EXPECT_EQ(1u, behind);
+
+    foreach (const Git::ObjectId& a, ids) {
+        foreach (const Git::ObjectId& b, ids) {
+            bool isAncestor = plain.isAncestor(r, a, b);
+            plain.calculateDivergence(r, a, b, ahead, behind);
+            CHECK_GIT_RESULT(r);
+
+            foreach (const Git::Repository& repo, graphed) {
+                size_t graphAhead = 0, graphBehind = 0;
+                EXPECT_EQ(isAncestor, repo.isAncestor(r, a, b))
+                        << qPrintable(repo.path() + a.toString() + b.toString());
+                repo.calculateDivergence(r, a, b, graphAhead, graphBehind);
+                CHECK_GIT_RESULT(r);
+                EXPECT_EQ(ahead, graphAhead);
+                EXPECT_EQ(behind, graphBehind);
+            }
+        }
+    }
+
+    QMap<QString, QString> upstreams = divergenceByBranch(plain.divergenceForBranches(r));
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(5, upstreams.count());
+    QMap<QString, QString> toMaster = divergenceByBranch(plain.divergenceForBranches(r, master));
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(5, toMaster.count());
+
+    foreach (const Git::Repository& repo, graphed) {
+        EXPECT_EQ(upstreams, divergenceByBranch(repo.divergenceForBranches(r)));
+        CHECK_GIT_RESULT(r);
+        EXPECT_EQ(toMaster, divergenceByBranch(repo.divergenceForBranches(r, master)));
+        CHECK_GIT_RESULT(r);
+    }
+}
@@ -0,0 +1,635 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QTimer>
+
+#include "gtest/gtest.h"
+
+#include "libGitWrap/BranchRef.hpp"
+#include "libGitWrap/Commit.hpp"
+#include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/Reference.hpp"
+#include "libGitWrap/Repository.hpp"
+#include "libGitWrap/Result.hpp"
+#include "libGitWrap/RevisionWalker.hpp"
+#include "libGitWrap/Tree.hpp"
+
+#include "libGitWrap/Operations/RevisionWalkOperation.hpp"
+
+#include "Infra/Fixture.hpp"
+#include "Infra/TempRepo.hpp"
+
+typedef Fixture RevisionWalkerFixture;
+
+// Add a chain of @a count commits on top of HEAD; returns the last one
+static Git::ObjectId addCommits(Git::Result& r, Git::Repository& repo, int count)
+{
+    Git::ObjectId headId = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+    Git::Commit head = repo.lookupCommit(r, headId);
+    Git::Tree tree = head.tree(r);
+    Git::Signature sig(QStringLiteral("Frida Fridoline"), QStringLiteral("fridoline@call.me"));
+    Git::ObjectId parent = head.id();
+
+    for (int i = 0; r && i < count; ++i) {
+        Git::Commit c = Git::Commit::create(r, repo, tree, QString::number(i), sig, sig,
+                                            Git::ObjectIdList() << parent);
+        parent = c.id();
+    }
+
+    return parent;
+}
+
+TEST_F(RevisionWalkerFixture, BatchesMatchSingleSteps)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "HistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    CHECK_GIT_RESULT(r);
+    walker.setSorting(r, true, true);
+    walker.pushHead(r);
+    CHECK_GIT_RESULT(r);
+
+    Git::ObjectIdList single;
+    Git::ObjectId id;
+    while (walker.next(r, id)) {
+        single.append(id);
+    }
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(7, single.count());
+
+    walker.reset(r);
+    walker.pushHead(r);
+    CHECK_GIT_RESULT(r);
+
+    Git::ObjectIdList batched;
+    Git::ObjectId batch[3];
+    int n;
+    while ((n = walker.nextBatch(r, batch, 3)) > 0) {
+        for (int i = 0; i < n; ++i) {
+            batched.append(batch[i]);
+        }
+    }
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(single, batched);
+
+    // A hint that is too small must not lose any commits
+    walker.reset(r);
+    walker.pushHead(r);
+    EXPECT_EQ(single, walker.all(r, 2));
+    CHECK_GIT_RESULT(r);
+
+    walker.reset(r);
+    walker.pushHead(r);
+    EXPECT_EQ(single, walker.all(r));
+    CHECK_GIT_RESULT(r);
+}
+
+TEST_F(RevisionWalkerFixture, AllGrowsBeyondItsInitialCapacity)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    // all() starts with room for 1024 ids, unless it is given a larger hint
+    const int count = 2500;
+    Git::ObjectId tip = addCommits(r, repo, count);
+    CHECK_GIT_RESULT(r);
+
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    CHECK_GIT_RESULT(r);
+    walker.push(r, tip);
+
+    Git::ObjectIdList single;
+    Git::ObjectId id;
+    while (walker.next(r, id)) {
+        single.append(id);
+    }
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(count + 1, single.count());
+    EXPECT_EQ(tip, single.first());
+
+    walker.reset(r);
+    walker.push(r, tip);
+    EXPECT_EQ(single, walker.all(r));
+    CHECK_GIT_RESULT(r);
+
+    walker.reset(r);
+    walker.push(r, tip);
+    EXPECT_EQ(single, walker.all(r, 1500));
+    CHECK_GIT_RESULT(r);
+
+    walker.reset(r);
+    walker.push(r, tip);
+    EXPECT_EQ(single, walker.all(r, count + 1));
+    CHECK_GIT_RESULT(r);
+}
+
+TEST_F(RevisionWalkerFixture, OperationStreamsBatches)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "HistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    walker.pushHead(r);
+    Git::ObjectIdList expected = walker.all(r);
+    CHECK_GIT_RESULT(r);
+
+    Git::RevisionWalkOperation op(repo);
+    op.pushHead();
+    op.setBatchSize(3);
+    op.setMaxQueuedBatches(1);
+    op.setBackgroundMode(true);
+    op.execute();
+
+    Git::ObjectIdList streamed;
+    while (!op.atEnd()) {
+        Git::ObjectIdList batch = op.takeBatch(-1);
+        EXPECT_LE(batch.count(), 3);
+        streamed += batch;
+    }
+
+    CHECK_GIT_RESULT(op.result());
+    EXPECT_EQ(expected, streamed);
+}
+
+TEST_F(RevisionWalkerFixture, OperationCanBeCancelled)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "HistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::RevisionWalkOperation op(repo);
+    op.pushHead();
+    op.setBatchSize(1);
+    op.setMaxQueuedBatches(1);
+    op.setBackgroundMode(true);
+    op.execute();
+
+    EXPECT_EQ(1, op.takeBatch(-1).count());
+    op.cancel();
+
+    EXPECT_TRUE(op.isCancelled());
+    EXPECT_TRUE(op.takeBatch(-1).isEmpty());
+    EXPECT_TRUE(op.atEnd());
+}
+
+// Take all batches of a background walk and wait until the operation has finished
+static Git::ObjectIdList takeAll(Git::RevisionWalkOperation& op)
+{
+    Git::ObjectIdList ids;
+    while (!op.atEnd()) {
+        ids += op.takeBatch(-1);
+    }
+
+    QEventLoop loop;
+    QTimer::singleShot(5000, &loop, SLOT(quit()));
+    QObject::connect(&op, SIGNAL(finished()), &loop, SLOT(quit()));
+    if (op.isRunning()) {
+        loop.exec();
+    }
+
+    EXPECT_FALSE(op.isRunning());
+    return ids;
+}
+
+TEST_F(RevisionWalkerFixture, OperationAppliesLimits)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "HistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    const QStringList paths = QStringList() << QStringLiteral("a") << QStringLiteral("b");
+    const QDateTime until(QDate(2015, 1, 6), QTime(23, 0), Qt::UTC);
+
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    walker.setSorting(r, true, true);
+    walker.setPathFilter(r, paths);
+    walker.setSkip(r, 1);
+    walker.setMaxCount(r, 3);
+    walker.setDateWindow(r, QDateTime(), until);
+    walker.pushHead(r);
+    Git::ObjectIdList expected = walker.all(r);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(3, expected.count());
+
+    Git::RevisionWalkOperation op(repo);
+    op.pushHead();
+    op.setSorting(true, true);
+    op.setPathFilter(paths);
+    EXPECT_EQ(paths, op.pathFilter());
+    op.setSkip(1);
+    op.setMaxCount(3);
+    op.setDateWindow(QDateTime(), until);
+    op.setBatchSize(2);
+    op.setBackgroundMode(true);
+
+    op.execute();
+    EXPECT_EQ(expected, takeAll(op));
+    CHECK_GIT_RESULT(op.result());
+
+    // A cancelled walk can be run again and starts over
+    op.setMaxQueuedBatches(1);
+    op.setBatchSize(1);
+    op.execute();
+    EXPECT_EQ(1, op.takeBatch(-1).count());
+    op.cancel();
+    takeAll(op);
+    EXPECT_TRUE(op.isCancelled());
+
+    op.execute();
+    EXPECT_EQ(expected, takeAll(op));
+    EXPECT_FALSE(op.isCancelled());
+    CHECK_GIT_RESULT(op.result());
+
+    // The same in the foreground
+    op.setBackgroundMode(false);
+    op.execute();
+    EXPECT_EQ(expected, takeAll(op));
+}
+
+static QStringList pathHistory(Git::Repository& repo, const QStringList& paths)
+{
+    Git::Result r;
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    walker.setSorting(r, true, true);
+    walker.setPathFilter(r, paths);
+    walker.pushHead(r);
+
+    QStringList messages;
+    Git::ObjectId id;
+    while (walker.next(r, id)) {
+        messages.append(repo.lookupCommit(r, id).shortMessage());
+    }
+
+    EXPECT_TRUE(r);
+    return messages;
+}
+
+TEST_F(RevisionWalkerFixture, PathFilterSimplifiesHistory)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "HistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    EXPECT_EQ(QStringList() << QStringLiteral("Change a again")
+                            << QStringLiteral("Change a")
+                            << QStringLiteral("Add a"),
+              pathHistory(repo, QStringList() << QStringLiteral("a")));
+
+    // The merge takes b from the side branch; only that branch is followed.
+    EXPECT_EQ(QStringList() << QStringLiteral("Change b on side")
+                            << QStringLiteral("Add b"),
+              pathHistory(repo, QStringList() << QStringLiteral("b")));
+
+    EXPECT_EQ(QStringList() << QStringLiteral("Merge side")
+                            << QStringLiteral("Change a again")
+                            << QStringLiteral("Change b on side")
+                            << QStringLiteral("Change a")
+                            << QStringLiteral("Add b")
+                            << QStringLiteral("Add a"),
+              pathHistory(repo, QStringList() << QStringLiteral("a") << QStringLiteral("b")));
+
+    EXPECT_EQ(QStringList() << QStringLiteral("Add dir/c"),
+              pathHistory(repo, QStringList() << QStringLiteral("dir/")));
+
+    EXPECT_EQ(QStringList() << QStringLiteral("Add dir/c"),
+              pathHistory(repo, QStringList() << QStringLiteral("dir/c")
+                                              << QStringLiteral("a/missing")));
+
+    // Without a filter, the whole history is walked.
+    EXPECT_EQ(7, pathHistory(repo, QStringList()).count());
+}
+
+// Make every filter in the changed path index claim that nothing changed at all
+static void clearChangedPathFilters(const QString& fileName)
+{
+    QFile file(fileName);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+
+    // 16 byte header; each record is a 20 byte id, a 4 byte big endian length and the filter
+    int pos = 16;
+    while (pos + 24 <= data.size()) {
+        const uchar* p = reinterpret_cast<const uchar*>(data.constData()) + pos + 20;
+        const int length = int((quint32(p[0]) << 24) | (quint32(p[1]) << 16) |
+                               (quint32(p[2]) << 8) | quint32(p[3]));
+        ASSERT_LE(pos + 24 + length, data.size());
+
+        data.replace(pos + 24, length, QByteArray(length, char(0)));
+        pos += 24 + length;
+    }
+
+    ASSERT_EQ(data.size(), pos);
+    ASSERT_TRUE(file.seek(0));
+    ASSERT_EQ(data.size(), file.write(data));
+}
+
+TEST_F(RevisionWalkerFixture, ChangedPathIndex)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "HistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    const QString indexFile = QDir(repo.path()).filePath(
+                QStringLiteral("objects/info/gitwrap-changed-paths"));
+
+    EXPECT_EQ(7, repo.updateChangedPathIndex(r));
+    CHECK_GIT_RESULT(r);
+    EXPECT_TRUE(QFile::exists(indexFile));
+    EXPECT_FALSE(QFile::exists(indexFile + QStringLiteral(".lock")));
+
+    // Only new commits are indexed
+    EXPECT_EQ(0, repo.updateChangedPathIndex(r));
+    CHECK_GIT_RESULT(r);
+
+    Git::ObjectId tip = addCommits(r, repo, 3);
+    Git::BranchRef::create(r, QStringLiteral("more"), repo.lookupCommit(r, tip));
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_EQ(3, repo.updateChangedPathIndex(r));
+    CHECK_GIT_RESULT(r);
+
+    // While the index is locked, nobody else may write it
+    QFile lock(indexFile + QStringLiteral(".lock"));
+    ASSERT_TRUE(lock.open(QIODevice::WriteOnly));
+    lock.close();
+
+    tip = addCommits(r, repo, 1);
+    Git::BranchRef::create(r, QStringLiteral("locked"), repo.lookupCommit(r, tip));
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_EQ(0, repo.updateChangedPathIndex(r));
+    EXPECT_FALSE(r);
+    r.clear();
+
+    ASSERT_TRUE(lock.remove());
+    EXPECT_EQ(1, repo.updateChangedPathIndex(r));
+    CHECK_GIT_RESULT(r);
+
+    // The index must not change what the walk returns
+    EXPECT_EQ(QStringList() << QStringLiteral("Change a again")
+                            << QStringLiteral("Change a")
+                            << QStringLiteral("Add a"),
+              pathHistory(repo, QStringList() << QStringLiteral("a")));
+
+    EXPECT_EQ(QStringList() << QStringLiteral("Change b on side")
+                            << QStringLiteral("Add b"),
+              pathHistory(repo, QStringList() << QStringLiteral("b")));
+
+    EXPECT_EQ(QStringList() << QStringLiteral("Add dir/c"),
+              pathHistory(repo, QStringList() << QStringLiteral("dir")));
+
+    // The walk must actually ask the index: If the filters say that nothing ever changed, no
+    // commit is left. Reopen, so the modified file is read from scratch.
+    clearChangedPathFilters(indexFile);
+
+    Git::Repository other = repo.reopen(r);
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_TRUE(pathHistory(other, QStringList() << QStringLiteral("a")).isEmpty());
+    EXPECT_TRUE(pathHistory(other, QStringList() << QStringLiteral("dir")).isEmpty());
+}
+
+static QStringList walkMessages(Git::Repository& repo, Git::RevisionWalker& walker)
+{
+    Git::Result r;
+    walker.pushHead(r);
+
+    QStringList messages;
+    Git::ObjectId id;
+    while (walker.next(r, id)) {
+        messages.append(repo.lookupCommit(r, id).shortMessage());
+    }
+
+    EXPECT_TRUE(r);
+    return messages;
+}
+
+TEST_F(RevisionWalkerFixture, WalkLimits)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "HistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    walker.setSorting(r, true, true);
+    walker.simplifyFirstParent(r);
+    CHECK_GIT_RESULT(r);
+
+    QStringList firstParent = walkMessages(repo, walker);
+    EXPECT_EQ(6, firstParent.count());
+    EXPECT_FALSE(firstParent.contains(QStringLiteral("Change b on side")));
+
+    // With the first parent only, the merge is compared to that parent.
+    walker = Git::RevisionWalker::create(r, repo);
+    walker.setSorting(r, true, true);
+    walker.simplifyFirstParent(r);
+    walker.setPathFilter(r, QStringList() << QStringLiteral("b"));
+    EXPECT_EQ(QStringList() << QStringLiteral("Merge side")
+                            << QStringLiteral("Add b"),
+              walkMessages(repo, walker));
+
+    QStringList middle = QStringList() << QStringLiteral("Change a again")
+                                       << QStringLiteral("Change b on side")
+                                       << QStringLiteral("Change a");
+
+    walker = Git::RevisionWalker::create(r, repo);
+    walker.setSorting(r, true, true);
+    walker.setSkip(r, 2);
+    walker.setMaxCount(r, 3);
+    EXPECT_EQ(middle, walkMessages(repo, walker));
+
+    // The limits start over with reset()
+    walker.reset(r);
+    EXPECT_EQ(middle, walkMessages(repo, walker));
+
+    walker = Git::RevisionWalker::create(r, repo);
+    walker.setSorting(r, true, true);
+    walker.setDateWindow(r, QDateTime(QDate(2015, 1, 3), QTime(0, 0), Qt::UTC),
+                         QDateTime(QDate(2015, 1, 5), QTime(23, 0), Qt::UTC));
+    EXPECT_EQ(middle, walkMessages(repo, walker));
+    CHECK_GIT_RESULT(r);
+}
+
+TEST_F(RevisionWalkerFixture, DateWindowEndsTheWalkEarly)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SkewRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    const QDateTime since(QDate(2015, 2, 1), QTime(0, 0), Qt::UTC);
+
+    // Without a start, every commit is looked at and the skewed ones are inside the window
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    walker.setDateWindow(r, QDateTime(), QDateTime(QDate(2015, 3, 1), QTime(0, 0), Qt::UTC));
+    EXPECT_EQ(15, walkMessages(repo, walker).count());
+
+    // 4 older commits in a row don't end the walk, 5 do. "Skewed early" is never reached.
+    walker = Git::RevisionWalker::create(r, repo);
+    walker.setDateWindow(r, since, QDateTime());
+    EXPECT_EQ(QStringList() << QStringLiteral("New 2")
+                            << QStringLiteral("New 1")
+                            << QStringLiteral("Skewed late"),
+              walkMessages(repo, walker));
+    CHECK_GIT_RESULT(r);
+}
+
+TEST_F(RevisionWalkerFixture, DateWindowWithPathFilter)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SkewRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    const QDateTime since(QDate(2015, 2, 1), QTime(0, 0), Qt::UTC);
+    const QStringList newer = QStringList() << QStringLiteral("New 2")
+                                            << QStringLiteral("New 1")
+                                            << QStringLiteral("Skewed late");
+
+    // Only the skewed and new commits change "f", all of them are newer than the window's start
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    walker.setPathFilter(r, QStringList() << QStringLiteral("f"));
+    EXPECT_EQ(QStringList(newer) << QStringLiteral("Skewed early"), walkMessages(repo, walker));
+
+    // The older commits that the path filter drops still end the walk before "Skewed early"
+    walker = Git::RevisionWalker::create(r, repo);
+    walker.setPathFilter(r, QStringList() << QStringLiteral("f"));
+    walker.setDateWindow(r, since, QDateTime());
+    EXPECT_EQ(newer, walkMessages(repo, walker));
+
+    // And a window that ends before the new commits keeps the filter's view of the history
+    walker = Git::RevisionWalker::create(r, repo);
+    walker.setPathFilter(r, QStringList() << QStringLiteral("f"));
+    walker.setDateWindow(r, since, QDateTime(QDate(2015, 2, 15), QTime(0, 0), Qt::UTC));
+    EXPECT_EQ(QStringList() << QStringLiteral("Skewed late"), walkMessages(repo, walker));
+    CHECK_GIT_RESULT(r);
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(RevisionWalkerFixture, DISABLED_BenchmarkWalk)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "SimpleRepo1", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    const int count = 50000;
+    Git::ObjectId tip = addCommits(r, repo, count);
+    CHECK_GIT_RESULT(r);
+
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    QElapsedTimer t;
+    int n = 0;
+
+    walker.push(r, tip);
+    t.start();
+    Git::ObjectId id;
+    while (walker.next(r, id)) {
+        ++n;
+    }
+    qint64 single = t.restart();
+    EXPECT_EQ(count + 1, n);
+
+    walker.reset(r);
+    walker.push(r, tip);
+    t.restart();
+    Git::ObjectId batch[256];
+    int got;
+    n = 0;
+    while ((got = walker.nextBatch(r, batch, 256)) > 0) {
+        n += got;
+    }
+    qint64 batched = t.restart();
+    EXPECT_EQ(count + 1, n);
+
+    walker.reset(r);
+    walker.push(r, tip);
+    t.restart();
+    EXPECT_EQ(count + 1, walker.all(r).count());
+    qint64 all = t.restart();
+
+    walker.reset(r);
+    walker.push(r, tip);
+    walker.setSorting(r, true, true);
+    t.restart();
+    EXPECT_EQ(count + 1, walker.all(r).count());
+    qint64 sorted = t.restart();
+    CHECK_GIT_RESULT(r);
+
+    printf("%d commits: next() %lld ms, nextBatch(256) %lld ms, all() %lld ms, "
+           "all() sorted %lld ms\n", count + 1, single, batched, all, sorted);
+}
+
+static int countPathHistory(Git::Result& r, Git::Repository& repo, const QStringList& paths)
+{
+    Git::RevisionWalker walker = Git::RevisionWalker::create(r, repo);
+    if (!paths.isEmpty()) {
+        walker.setPathFilter(r, paths);
+    }
+    walker.pushHead(r);
+    return walker.all(r).count();
+}
+
+TEST_F(RevisionWalkerFixture, DISABLED_BenchmarkPathFilter)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "PathHistoryRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    QStringList file(QStringLiteral("dir3/file3"));
+    QStringList dir(QStringLiteral("dir3"));
+    QElapsedTimer t;
+
+    t.start();
+    EXPECT_EQ(5000, countPathHistory(r, repo, QStringList()));
+    qint64 unfiltered = t.restart();
+    EXPECT_EQ(50, countPathHistory(r, repo, file));
+    qint64 fileFiltered = t.restart();
+    EXPECT_EQ(500, countPathHistory(r, repo, dir));
+    qint64 dirFiltered = t.restart();
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_EQ(5000, repo.updateChangedPathIndex(r));
+    qint64 indexing = t.restart();
+    EXPECT_EQ(50, countPathHistory(r, repo, file));
+    qint64 fileIndexed = t.restart();
+    EXPECT_EQ(500, countPathHistory(r, repo, dir));
+    qint64 dirIndexed = t.restart();
+    CHECK_GIT_RESULT(r);
+
+    printf("5000 commits: unfiltered %lld ms; file %lld ms, directory %lld ms; "
+           "building the index %lld ms; with index: file %lld ms, directory %lld ms\n",
+           unfiltered, fileFiltered, dirFiltered, indexing, fileIndexed, dirIndexed);
+}
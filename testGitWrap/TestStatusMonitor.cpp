@@ -0,0 +1,231 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QTimer>
+
+#include "libGitWrap/Index.hpp"
+#include "libGitWrap/ObjectId.hpp"
+#include "libGitWrap/Reference.hpp"
+#include "libGitWrap/Result.hpp"
+#include "libGitWrap/Repository.hpp"
+#include "libGitWrap/StatusMonitor.hpp"
+#include "libGitWrap/StatusOptions.hpp"
+
+#include "Infra/Fixture.hpp"
+#include "Infra/TempRepo.hpp"
+
+typedef Fixture StatusMonitorFixture;
+
+namespace
+{
+
+    void writeFile(const QString& path, const QByteArray& content)
+    {
+        QFile f(path);
+        ASSERT_TRUE(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        f.write(content);
+    }
+
+    bool waitFor(Git::StatusMonitor& monitor, const QString& path, Git::StatusFlags status)
+    {
+        if (monitor.status(path) == status) {
+            return true;
+        }
+
+        QEventLoop loop;
+        QTimer::singleShot(5000, &loop, SLOT(quit()));
+
+        QMetaObject::Connection c = QObject::connect(
+                    &monitor, &Git::StatusMonitor::fileStatusChanged,
+                    [&](const QString& p, Git::StatusFlags, Git::StatusFlags s) {
+            if (p == path && s == status) {
+                loop.quit();
+            }
+        });
+
+        loop.exec();
+        QObject::disconnect(c);
+
+        return monitor.status(path) == status;
+    }
+
+}
+
+TEST_F(StatusMonitorFixture, ReportsChangedFiles)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::StatusMonitor monitor(repo);
+    ASSERT_TRUE(monitor.start(r));
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(monitor.isRunning());
+
+    QString fileName = QStringLiteral("monitored.txt");
+    QFile f(QDir(repo.workTreePath()).filePath(fileName));
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+    f.write("Untracked\n");
+    f.close();
+
+    EXPECT_TRUE(waitFor(monitor, fileName, Git::FileWorkingTreeNew));
+
+    ASSERT_TRUE(f.remove());
+    EXPECT_TRUE(waitFor(monitor, fileName, Git::FileInvalidStatus));
+
+    monitor.stop();
+    EXPECT_FALSE(monitor.isRunning());
+}
+
+TEST_F(StatusMonitorFixture, FollowsHeadAndBranch)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::ObjectId tip = repo.HEAD(r).objectId();
+    CHECK_GIT_RESULT(r);
+
+    Git::StatusMonitor monitor(repo);
+    ASSERT_TRUE(monitor.start(r));
+    CHECK_GIT_RESULT(r);
+
+    QDir gitDir(repo.path());
+    QString file1 = QStringLiteral("File1");
+
+    // An unborn branch: everything in the index is new
+    writeFile(gitDir.filePath(QStringLiteral("HEAD")), "ref: refs/heads/unborn\n");
+    EXPECT_TRUE(waitFor(monitor, file1, Git::FileIndexNew));
+
+    // The branch is created at the old tip; HEAD is not touched
+    writeFile(gitDir.filePath(QStringLiteral("refs/heads/unborn")),
+              tip.toString().toLatin1() + "\n");
+    EXPECT_TRUE(waitFor(monitor, file1, Git::FileInvalidStatus));
+
+    monitor.stop();
+}
+
+TEST_F(StatusMonitorFixture, FollowsIgnoreRules)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    QDir workTree(repo.workTreePath());
+    ASSERT_TRUE(workTree.mkdir(QStringLiteral("out")));
+    writeFile(workTree.filePath(QStringLiteral("out/a")), "a\n");
+    writeFile(workTree.filePath(QStringLiteral("build.tmp")), "tmp\n");
+    writeFile(workTree.filePath(QStringLiteral(".gitignore")), "out/\n");
+
+    Git::StatusMonitor monitor(repo);
+    ASSERT_TRUE(monitor.start(r));
+    CHECK_GIT_RESULT(r);
+
+    QString outDir = QStringLiteral("out/");
+    QString tmpFile = QStringLiteral("build.tmp");
+    EXPECT_EQ(Git::FileInvalidStatus, monitor.status(outDir));
+    EXPECT_EQ(Git::FileWorkingTreeNew, monitor.status(tmpFile));
+
+    writeFile(workTree.filePath(QStringLiteral(".gitignore")), "*.tmp\n");
+    EXPECT_TRUE(waitFor(monitor, outDir, Git::FileWorkingTreeNew));
+    EXPECT_TRUE(waitFor(monitor, tmpFile, Git::FileInvalidStatus));
+
+    // Only seen if "out" got a watch when it stopped being ignored
+    ASSERT_TRUE(workTree.remove(QStringLiteral("out/a")));
+    EXPECT_TRUE(waitFor(monitor, outDir, Git::FileInvalidStatus));
+
+    writeFile(workTree.filePath(QStringLiteral("out/b")), "b\n");
+    EXPECT_TRUE(waitFor(monitor, outDir, Git::FileWorkingTreeNew));
+
+    QDir gitDir(repo.path());
+    ASSERT_TRUE(gitDir.mkpath(QStringLiteral("info")));
+    writeFile(gitDir.filePath(QStringLiteral("info/exclude")), "out/\n");
+    EXPECT_TRUE(waitFor(monitor, outDir, Git::FileInvalidStatus));
+
+    monitor.stop();
+}
+
+TEST_F(StatusMonitorFixture, FollowsRenames)
+{
+    Git::Result r;
+    TempRepoOpener tempRepo(this, "SimpleRepo1", r);
+    CHECK_GIT_RESULT(r);
+    Git::Repository repo(tempRepo);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::StatusOptions opts;
+    opts.setRenameDetection(Git::StatusOptions::RenamesBoth);
+
+    Git::StatusMonitor plain(repo);
+    Git::StatusMonitor renames(repo, opts);
+    ASSERT_TRUE(plain.start(r));
+    ASSERT_TRUE(renames.start(r));
+    CHECK_GIT_RESULT(r);
+
+    QDir workTree(repo.workTreePath());
+    QString file1 = QStringLiteral("File1");
+    QString moved = QStringLiteral("Moved1");
+
+    // Both sides of the rename change before the same poll
+    ASSERT_TRUE(workTree.rename(file1, moved));
+    EXPECT_TRUE(waitFor(plain, file1, Git::FileWorkingTreeDeleted));
+    EXPECT_TRUE(waitFor(plain, moved, Git::FileWorkingTreeNew));
+    EXPECT_TRUE(waitFor(renames, moved, Git::FileWorkingTreeRenamed));
+    EXPECT_EQ(Git::FileInvalidStatus, renames.status(file1));
+
+    ASSERT_TRUE(workTree.rename(moved, file1));
+    EXPECT_TRUE(waitFor(plain, file1, Git::FileInvalidStatus));
+    EXPECT_TRUE(waitFor(plain, moved, Git::FileInvalidStatus));
+    EXPECT_TRUE(waitFor(renames, moved, Git::FileInvalidStatus));
+    EXPECT_EQ(Git::FileInvalidStatus, renames.status(file1));
+
+    // The old side was seen by an earlier poll than the new one
+    ASSERT_TRUE(workTree.remove(file1));
+    EXPECT_TRUE(waitFor(plain, file1, Git::FileWorkingTreeDeleted));
+    EXPECT_TRUE(waitFor(renames, file1, Git::FileWorkingTreeDeleted));
+
+    writeFile(workTree.filePath(moved), "File1\n");
+    EXPECT_TRUE(waitFor(plain, moved, Git::FileWorkingTreeNew));
+    EXPECT_TRUE(waitFor(renames, moved, Git::FileWorkingTreeRenamed));
+    EXPECT_EQ(Git::FileInvalidStatus, renames.status(file1));
+    EXPECT_EQ(Git::FileWorkingTreeDeleted, plain.status(file1));
+
+    // The same rename in the index
+    Git::Index index = repo.index(r);
+    index.removeFile(r, file1);
+    index.addFile(r, moved);
+    index.write(r);
+    CHECK_GIT_RESULT(r);
+
+    EXPECT_TRUE(waitFor(plain, moved, Git::FileIndexNew));
+    EXPECT_TRUE(waitFor(plain, file1, Git::FileIndexDeleted));
+    EXPECT_TRUE(waitFor(renames, moved, Git::FileIndexRenamed));
+    EXPECT_EQ(Git::FileInvalidStatus, renames.status(file1));
+
+    plain.stop();
+    renames.stop();
+}
@@ -0,0 +1,437 @@
+/*
+ * MacGitver
+ * Copyright (C) 2015 The MacGitver-Developers <dev@macgitver.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License (Version 2) as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gtest/gtest.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+
+#include "libGitWrap/Commit.hpp"
+#include "libGitWrap/Reference.hpp"
+#include "libGitWrap/Repository.hpp"
+#include "libGitWrap/Result.hpp"
+#include "libGitWrap/Tree.hpp"
+#include "libGitWrap/TreeEntry.hpp"
+#include "libGitWrap/TreeEntryView.hpp"
+#include "libGitWrap/TreeVisitor.hpp"
+
+#include "Infra/Fixture.hpp"
+#include "Infra/TempRepo.hpp"
+
+typedef Fixture TreeFixture;
+
+namespace
+{
+
+    class CollectingVisitor : public Git::TreeVisitor
+    {
+    public:
+        Action visit(const Entry& entry)
+        {
+            paths << QString::number(entry.depth) + QLatin1Char(':') + entry.filePath();
+
+            if (entry.filePath() == skip) {
+                return SkipSubtree;
+            }
+
+            return entry.filePath() == stop ? Stop : Continue;
+        }
+
+    public:
+        QStringList paths;
+        QString     skip;
+        QString     stop;
+    };
+
+    class LockingVisitor : public CollectingVisitor
+    {
+    public:
+        Action visit(const Entry& entry)
+        {
+            QMutexLocker lock(&mutex);
+            return CollectingVisitor::visit(entry);
+        }
+
+    public:
+        QMutex      mutex;
+    };
+
+    class ThreadCheckingVisitor : public CollectingVisitor
+    {
+    public:
+        ThreadCheckingVisitor() : thread(QThread::currentThread()), otherThreads(0) {}
+
+        Action visit(const Entry& entry)
+        {
+            if (QThread::currentThread() != thread) {
+                otherThreads++;
+            }
+            return CollectingVisitor::visit(entry);
+        }
+
+    public:
+        QThread*    thread;
+        int         otherThreads;
+    };
+
+    class CountingVisitor : public Git::TreeVisitor
+    {
+    public:
+        CountingVisitor() : count(0) {}
+
+        Action visit(const Entry&)
+        {
+            count.ref();
+            return Continue;
+        }
+
+    public:
+        QAtomicInt  count;
+    };
+
+    int recurse(Git::Result& r, Git::Repository& repo, const Git::Tree& tree,
+                const QString& prefix)
+    {
+        int count = 0;
+
+        for (size_t i = 0; i < tree.entryCount(); ++i) {
+            Git::TreeEntry entry = tree.entryAt(i);
+            QString path = prefix + entry.name();
+            ++count;
+
+            if (entry.type() == Git::otTree) {
+                Git::Tree sub = repo.lookupTree(r, entry.sha1());
+                count += recurse(r, repo, sub, path + QLatin1Char('/'));
+            }
+        }
+
+        return count;
+    }
+
+    Git::Tree headTree(Git::Result& r, Git::Repository& repo)
+    {
+        Git::ObjectId head = Git::Reference::nameToId(r, repo, QStringLiteral("HEAD"));
+        return repo.lookupCommit(r, head).tree(r);
+    }
+
+}
+
+TEST_F(TreeFixture, WalksInPreAndPostOrder)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "NestedTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Tree tree = headTree(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    CollectingVisitor pre;
+    EXPECT_TRUE(tree.walk(r, &pre));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "0:c" << "0:dir" << "1:dir/a" << "1:dir/sub" << "2:dir/sub/b",
+              pre.paths);
+
+    CollectingVisitor post;
+    EXPECT_TRUE(tree.walk(r, &post, Git::TreeWalkPostOrder));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "0:c" << "1:dir/a" << "2:dir/sub/b" << "1:dir/sub" << "0:dir",
+              post.paths);
+
+    CollectingVisitor leaves;
+    EXPECT_TRUE(tree.walk(r, &leaves, Git::TreeWalkPreOrder, Git::TreeWalkSkipTrees));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "0:c" << "1:dir/a" << "2:dir/sub/b", leaves.paths);
+}
+
+TEST_F(TreeFixture, WalkCanBePrunedAndStopped)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "NestedTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Tree tree = headTree(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    CollectingVisitor prefixed;
+    EXPECT_TRUE(tree.walk(r, &prefixed, Git::TreeWalkPreOrder, Git::TreeWalkNone,
+                          QStringLiteral("dir/sub/")));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "1:dir/sub" << "2:dir/sub/b", prefixed.paths);
+
+    CollectingVisitor missing;
+    EXPECT_TRUE(tree.walk(r, &missing, Git::TreeWalkPreOrder, Git::TreeWalkNone,
+                          QStringLiteral("nothing/here")));
+    CHECK_GIT_RESULT(r);
+    EXPECT_TRUE(missing.paths.isEmpty());
+
+    CollectingVisitor skipping;
+    skipping.skip = QStringLiteral("dir");
+    EXPECT_TRUE(tree.walk(r, &skipping));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "0:c" << "0:dir", skipping.paths);
+
+    CollectingVisitor stopping;
+    stopping.stop = QStringLiteral("dir/a");
+    EXPECT_FALSE(tree.walk(r, &stopping));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "0:c" << "0:dir" << "1:dir/a", stopping.paths);
+}
+
+TEST_F(TreeFixture, ParallelWalkKeepsTheOrder)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "NestedTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Tree tree = headTree(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    for (int splitDepth = 1; splitDepth <= 3; ++splitDepth) {
+        CollectingVisitor serial, parallel;
+        EXPECT_TRUE(tree.walk(r, &serial));
+        EXPECT_TRUE(tree.parallelWalk(r, &parallel, Git::TreeWalkPreOrder, Git::TreeWalkNone,
+                                      splitDepth));
+        CHECK_GIT_RESULT(r);
+        EXPECT_EQ(serial.paths, parallel.paths);
+
+        CollectingVisitor serialPost, parallelPost;
+        EXPECT_TRUE(tree.walk(r, &serialPost, Git::TreeWalkPostOrder));
+        EXPECT_TRUE(tree.parallelWalk(r, &parallelPost, Git::TreeWalkPostOrder,
+                                      Git::TreeWalkNone, splitDepth));
+        CHECK_GIT_RESULT(r);
+        EXPECT_EQ(serialPost.paths, parallelPost.paths);
+    }
+
+    CollectingVisitor skipping;
+    skipping.skip = QStringLiteral("dir/sub");
+    EXPECT_TRUE(tree.parallelWalk(r, &skipping));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "0:c" << "0:dir" << "1:dir/a" << "1:dir/sub", skipping.paths);
+
+    CollectingVisitor stopping;
+    stopping.stop = QStringLiteral("dir/a");
+    EXPECT_FALSE(tree.parallelWalk(r, &stopping));
+    CHECK_GIT_RESULT(r);
+    EXPECT_EQ(QStringList() << "0:c" << "0:dir" << "1:dir/a", stopping.paths);
+}
+
+TEST_F(TreeFixture, ParallelWalkStreamsBigTrees)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "BigTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Tree tree = headTree(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    CollectingVisitor serial, serialPost;
+    EXPECT_TRUE(tree.walk(r, &serial));
+    EXPECT_TRUE(tree.walk(r, &serialPost, Git::TreeWalkPostOrder));
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(16 + 16 * 16 + 16 * 16 * 32, serial.paths.count());
+
+    // 16 or 256 subtrees, many more than there are threads
+    for (int splitDepth = 1; splitDepth <= 2; ++splitDepth) {
+        ThreadCheckingVisitor parallel;
+        EXPECT_TRUE(tree.parallelWalk(r, &parallel, Git::TreeWalkPreOrder, Git::TreeWalkNone,
+                                      splitDepth));
+        CHECK_GIT_RESULT(r);
+        EXPECT_EQ(serial.paths, parallel.paths) << splitDepth;
+        EXPECT_EQ(0, parallel.otherThreads);
+
+        ThreadCheckingVisitor parallelPost;
+        EXPECT_TRUE(tree.parallelWalk(r, &parallelPost, Git::TreeWalkPostOrder,
+                                      Git::TreeWalkNone, splitDepth));
+        CHECK_GIT_RESULT(r);
+        EXPECT_EQ(serialPost.paths, parallelPost.paths) << splitDepth;
+        EXPECT_EQ(0, parallelPost.otherThreads);
+
+        // Stop in the middle, while the subtrees behind are still being read
+        ThreadCheckingVisitor stopping;
+        stopping.stop = QStringLiteral("dir03/sub07/file12");
+        EXPECT_FALSE(tree.parallelWalk(r, &stopping, Git::TreeWalkPreOrder, Git::TreeWalkNone,
+                                       splitDepth));
+        CHECK_GIT_RESULT(r);
+        int last = serial.paths.indexOf(QStringLiteral("2:") + stopping.stop);
+        ASSERT_LT(0, last);
+        EXPECT_EQ(serial.paths.mid(0, last + 1), stopping.paths) << splitDepth;
+
+        ThreadCheckingVisitor stoppingPost;
+        stoppingPost.stop = QStringLiteral("dir03/sub07");
+        EXPECT_FALSE(tree.parallelWalk(r, &stoppingPost, Git::TreeWalkPostOrder,
+                                       Git::TreeWalkNone, splitDepth));
+        CHECK_GIT_RESULT(r);
+        last = serialPost.paths.indexOf(QStringLiteral("1:") + stoppingPost.stop);
+        ASSERT_LT(0, last);
+        EXPECT_EQ(serialPost.paths.mid(0, last + 1), stoppingPost.paths) << splitDepth;
+    }
+}
+
+TEST_F(TreeFixture, UnorderedParallelWalkReportsEverything)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "NestedTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Tree tree = headTree(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    CollectingVisitor serial;
+    EXPECT_TRUE(tree.walk(r, &serial));
+    serial.paths.sort();
+
+    LockingVisitor pre;
+    EXPECT_TRUE(tree.parallelWalk(r, &pre, Git::TreeWalkPreOrder,
+                                  Git::TreeWalkUnordered));
+    CHECK_GIT_RESULT(r);
+    pre.paths.sort();
+    EXPECT_EQ(serial.paths, pre.paths);
+
+    LockingVisitor post;
+    EXPECT_TRUE(tree.parallelWalk(r, &post, Git::TreeWalkPostOrder,
+                                  Git::TreeWalkUnordered));
+    CHECK_GIT_RESULT(r);
+    post.paths.sort();
+    EXPECT_EQ(serial.paths, post.paths);
+}
+
+TEST_F(TreeFixture, EntriesCanBeIteratedAsViews)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "NestedTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::TreeEntries entries = headTree(r, repo).entries();
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(2u, entries.count());
+
+    QStringList names;
+    for (Git::TreeEntryView entry : entries) {
+        EXPECT_TRUE(entry.isValid());
+        names << QString::fromUtf8(entry.rawName());
+    }
+    EXPECT_EQ(QStringList() << "c" << "dir", names);
+
+    Git::TreeEntryView dir = entries.find("dir");
+    ASSERT_TRUE(dir.isValid());
+    EXPECT_EQ(Git::otTree, dir.type());
+    EXPECT_EQ(Git::TreeAttr, dir.mode());
+    EXPECT_EQ(dir.id(), Git::ObjectId::fromRaw(dir.rawId()));
+
+    Git::TreeEntryView c = entries.at(0);
+    EXPECT_EQ(Git::otBlob, c.type());
+    EXPECT_EQ(Git::FileAttr, c.mode());
+
+    // The owning entry must stay usable after the tree and the range are gone.
+    Git::TreeEntry owned = c.toTreeEntry();
+    entries = Git::TreeEntries();
+    EXPECT_EQ(QStringLiteral("c"), owned.name());
+    EXPECT_EQ(Git::otBlob, owned.type());
+
+    EXPECT_FALSE(entries.find("c").isValid());
+    EXPECT_FALSE(entries.at(5).isValid());
+}
+
+TEST_F(TreeFixture, LooksUpManyPaths)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "NestedTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Tree tree = headTree(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    QStringList paths;
+    paths << "dir/sub/b" << "c" << "dir/missing" << "dir/a" << "c/nothing" << "dir/sub/"
+          << "" << "dir/sub/b";
+
+    Git::TreePathInfoList infos = tree.lookupPaths(r, paths);
+    CHECK_GIT_RESULT(r);
+    ASSERT_EQ(paths.count(), infos.count());
+
+    EXPECT_TRUE(infos[0].found);
+    EXPECT_EQ(Git::otBlob, infos[0].type);
+    EXPECT_EQ(Git::FileAttr, infos[0].mode);
+
+    EXPECT_TRUE(infos[1].found);
+    EXPECT_EQ(tree.entries().find("c").id(), infos[1].id);
+
+    EXPECT_FALSE(infos[2].found);
+
+    EXPECT_TRUE(infos[3].found);
+    EXPECT_NE(infos[0].id, infos[3].id);
+
+    EXPECT_FALSE(infos[4].found);
+
+    EXPECT_TRUE(infos[5].found);
+    EXPECT_EQ(Git::otTree, infos[5].type);
+
+    EXPECT_FALSE(infos[6].found);
+
+    EXPECT_TRUE(infos[7].found);
+    EXPECT_EQ(infos[0].id, infos[7].id);
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+TEST_F(TreeFixture, DISABLED_BenchmarkWalk)
+{
+    Git::Result r;
+    Git::Repository repo( TempRepoOpener(this, "BigTreeRepo", r) );
+    CHECK_GIT_RESULT(r);
+    ASSERT_TRUE(repo.isValid());
+
+    Git::Tree tree = headTree(r, repo);
+    CHECK_GIT_RESULT(r);
+
+    const int rounds = 20;
+    const int expected = 16 + 16 * 16 + 16 * 16 * 32;
+    QElapsedTimer t;
+
+    t.start();
+    for (int i = 0; i < rounds; ++i) {
+        EXPECT_EQ(expected, recurse(r, repo, tree, QString()));
+    }
+    qint64 recursion = t.restart();
+
+    for (int i = 0; i < rounds; ++i) {
+        CountingVisitor visitor;
+        EXPECT_TRUE(tree.walk(r, &visitor));
+        EXPECT_EQ(expected, int(visitor.count.load()));
+    }
+    qint64 walk = t.restart();
+
+    for (int i = 0; i < rounds; ++i) {
+        CountingVisitor visitor;
+        EXPECT_TRUE(tree.parallelWalk(r, &visitor, Git::TreeWalkPreOrder,
+                                      Git::TreeWalkUnordered));
+        EXPECT_EQ(expected, int(visitor.count.load()));
+    }
+    qint64 parallel = t.restart();
+    CHECK_GIT_RESULT(r);
+
+    printf("%d x %d entries: recursion %lld ms, walk() %lld ms, parallelWalk() %lld ms\n",
+           rounds, expected, recursion, walk, parallel);
+}